@@ -53,7 +53,8 @@ struct MediumProperties;
 // RayMajorantSegment Definition
 struct RayMajorantSegment {
     Float tMin, tMax;
-    SampledSpectrum sigma_maj;
+    // _sigma_min_ is a lower bound of $\sigmat$ along the segment
+    SampledSpectrum sigma_maj, sigma_min;
     std::string ToString() const;
 };
 
@@ -650,6 +650,97 @@ TEST(BSDFEnergyConservation,
 }
 #endif
 
+// LayeredBxDF Tests
+// Returns the relative errors of a tabulated layered BxDF's values and PDFs
+// with respect to stochastic estimates with many samples.  For each of a
+// number of random directions, _createBxDFs_ is called with an _RNG_ to
+// sample the BxDFs' parameters and returns a pair of tabulated and
+// stochastic BxDFs to compare.
+template <typename CreateBxDFs>
+static std::pair<Float, Float> TabulatedLayeredBxDFErrors(CreateBxDFs createBxDFs) {
+    RNG rng;
+    Float fErr = 0, fSum = 0, pdfErr = 0, pdfSum = 0;
+    for (int i = 0; i < 100; ++i) {
+        Vector3f wo =
+            SampleUniformHemisphere({rng.Uniform<Float>(), rng.Uniform<Float>()});
+        Vector3f wi =
+            SampleUniformHemisphere({rng.Uniform<Float>(), rng.Uniform<Float>()});
+        auto [tabulated, stochastic] = createBxDFs(rng);
+
+        SampledSpectrum ft = tabulated.f(wo, wi, TransportMode::Radiance);
+        SampledSpectrum fs = stochastic.f(wo, wi, TransportMode::Radiance);
+        for (int c = 0; c < NSpectrumSamples; ++c) {
+            fErr += std::abs(ft[c] - fs[c]);
+            fSum += fs[c];
+        }
+        Float pdft = tabulated.PDF(wo, wi, TransportMode::Radiance);
+        Float pdfs = stochastic.PDF(wo, wi, TransportMode::Radiance);
+        pdfErr += std::abs(pdft - pdfs);
+        pdfSum += pdfs;
+    }
+    return {fErr / fSum, pdfErr / pdfSum};
+}
+
+TEST(LayeredBxDF, Tabulated) {
+    for (Float alpha : {Float(0), Float(0.3)}) {
+        DielectricBxDF top(1.5f, TrowbridgeReitzDistribution(alpha, alpha));
+        LayeredBxDFTable *table = CoatedDiffuseBxDF::Tabulate(
+            top, [](const SampledSpectrum &r) { return DiffuseBxDF(r); }, 0.01f, 10, {});
+
+        auto [fErr, pdfErr] = TabulatedLayeredBxDFErrors([&](RNG &rng) {
+            SampledSpectrum r;
+            for (int c = 0; c < NSpectrumSamples; ++c)
+                r[c] = rng.Uniform<Float>();
+            return std::make_pair(
+                CoatedDiffuseBxDF(top, DiffuseBxDF(r), 0.01f, SampledSpectrum(0.f), 0, 10,
+                                  1, table, r),
+                CoatedDiffuseBxDF(top, DiffuseBxDF(r), 0.01f, SampledSpectrum(0.f), 0, 10,
+                                  1024));
+        });
+        EXPECT_LT(fErr, 0.05f) << alpha;
+        EXPECT_LT(pdfErr, 0.02f) << alpha;
+    }
+}
+
+TEST(LayeredBxDF, TabulatedConductor) {
+    TrowbridgeReitzDistribution conductorDistrib(0.3f, 0.3f);
+    for (Float alpha : {Float(0), Float(0.3)}) {
+        DielectricBxDF top(1.5f, TrowbridgeReitzDistribution(alpha, alpha));
+        LayeredBxDFTable *table = CoatedConductorBxDF::Tabulate(
+            top,
+            [&](const SampledSpectrum &r) {
+                SampledSpectrum rc = Clamp(r, 0, .9999);
+                return ConductorBxDF(conductorDistrib, SampledSpectrum(1.f),
+                                     2 * Sqrt(rc) / Sqrt(SampledSpectrum(1) - rc));
+            },
+            0.01f, 10, {});
+
+        // Compare tabulated values for metals under the coating, which are
+        // looked up by normal-incidence reflectance, to stochastic estimates
+        for (std::string metal : {"metal-Au", "metal-Cu"}) {
+            auto [fErr, pdfErr] = TabulatedLayeredBxDFErrors([&](RNG &rng) {
+                SampledWavelengths lambda =
+                    SampledWavelengths::SampleVisible(rng.Uniform<Float>());
+                SampledSpectrum eta =
+                    GetNamedSpectrum(metal + "-eta").Sample(lambda) / 1.5f;
+                SampledSpectrum k = GetNamedSpectrum(metal + "-k").Sample(lambda) / 1.5f;
+                SampledSpectrum one(1.f);
+                SampledSpectrum r0 =
+                    (Sqr(eta - one) + Sqr(k)) / (Sqr(eta + one) + Sqr(k));
+
+                ConductorBxDF bottom(conductorDistrib, eta, k);
+                return std::make_pair(
+                    CoatedConductorBxDF(top, bottom, 0.01f, SampledSpectrum(0.f), 0, 10,
+                                        1, table, r0),
+                    CoatedConductorBxDF(top, bottom, 0.01f, SampledSpectrum(0.f), 0, 10,
+                                        1024));
+            });
+            EXPECT_LT(fErr, 0.06f) << metal << ", alpha " << alpha;
+            EXPECT_LT(pdfErr, 0.03f) << metal << ", alpha " << alpha;
+        }
+    }
+}
+
 // Hair Tests
 #if 0
 TEST(Hair, Reciprocity) {
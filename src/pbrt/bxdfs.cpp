@@ -18,6 +18,7 @@
 #include <pbrt/util/log.h>
 #include <pbrt/util/math.h>
 #include <pbrt/util/memory.h>
+#include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/sampling.h>
 #include <pbrt/util/stats.h>
@@ -69,8 +70,66 @@ std::string DiffuseTransmissionBxDF::ToString() const {
 template <typename TopBxDF, typename BottomBxDF, bool twoSided>
 std::string LayeredBxDF<TopBxDF, BottomBxDF, twoSided>::ToString() const {
     return StringPrintf(
-        "[ LayeredBxDF top: %s bottom: %s thickness: %f albedo: %s g: %f ]", top, bottom,
-        thickness, albedo, g);
+        "[ LayeredBxDF top: %s bottom: %s thickness: %f albedo: %s g: %f "
+        "tabulated: %s ]",
+        top, bottom, thickness, albedo, g, table != nullptr);
+}
+
+// LayeredBxDFTable Method Definitions
+STAT_COUNTER("Scene/Layered BxDF tables", nLayeredBxDFTables);
+STAT_MEMORY_COUNTER("Memory/Layered BxDF tables", layeredBxDFTableBytes);
+
+std::string LayeredBxDFTable::ToString() const {
+    return StringPrintf("[ LayeredBxDFTable nCosTheta: %d nPhi: %d nReflectance: %d ]",
+                        nCosTheta, nPhi, nReflectance);
+}
+
+template <typename TopBxDF, typename BottomBxDF, bool twoSided>
+LayeredBxDFTable *LayeredBxDF<TopBxDF, BottomBxDF, twoSided>::Tabulate(
+    TopBxDF top, std::function<BottomBxDF(const SampledSpectrum &)> bottom,
+    Float thickness, int maxDepth, Allocator alloc) {
+    static_assert(twoSided, "Only two-sided layered BxDFs can be tabulated");
+    // Many random walks per table entry keep the tabulated values smooth
+    constexpr int nTabulationSamples = 256;
+    using Table = LayeredBxDFTable;
+    Table *table = alloc.new_object<Table>(alloc);
+
+    ParallelFor(0, Table::nCosTheta * Table::nCosTheta * Table::nPhi, [&](int64_t index) {
+        // Compute directions for table entry _index_
+        int o = index / (Table::nCosTheta * Table::nPhi);
+        int i = (index / Table::nPhi) % Table::nCosTheta, p = index % Table::nPhi;
+        Float cosTheta_o = Table::NodeCosTheta(o), cosTheta_i = Table::NodeCosTheta(i);
+        Vector3f wo = SphericalDirection(SafeSqrt(1 - Sqr(cosTheta_o)), cosTheta_o, 0);
+        Vector3f wi = SphericalDirection(SafeSqrt(1 - Sqr(cosTheta_i)), cosTheta_i,
+                                         Table::NodePhi(p));
+        TransportMode mode = TransportMode::Radiance;
+        SampledSpectrum fTop = top.f(wo, wi, mode);
+
+        // Estimate values for all reflectances, _NSpectrumSamples_ at a time
+        for (int r0 = 0; r0 < Table::nReflectance; r0 += NSpectrumSamples) {
+            SampledSpectrum r;
+            for (int c = 0; c < NSpectrumSamples; ++c)
+                r[c] = Table::NodeReflectance(std::min(r0 + c, Table::nReflectance - 1));
+            LayeredBxDF bxdf(top, bottom(r), thickness, SampledSpectrum(0.f), 0,
+                             maxDepth, nTabulationSamples);
+            SampledSpectrum f = bxdf.f(wo, wi, mode) - fTop;
+            for (int c = 0; c < NSpectrumSamples && r0 + c < Table::nReflectance; ++c)
+                table->fTable[index * Table::nReflectance + r0 + c] =
+                    std::max<Float>(0, f[c]);
+        }
+
+        // Estimate PDF, which does not depend on the bottom reflectance
+        LayeredBxDF bxdf(top, bottom(SampledSpectrum(0.5f)), thickness,
+                         SampledSpectrum(0.f), 0, maxDepth, nTabulationSamples);
+        Float pdfTop = top.PDF(wo, wi, mode, BxDFReflTransFlags::Reflection);
+        table->pdfTable[index] =
+            std::max<Float>(0, bxdf.PDF(wo, wi, mode) - 0.9f * pdfTop);
+    });
+
+    ++nLayeredBxDFTables;
+    layeredBxDFTableBytes +=
+        (table->fTable.size() + table->pdfTable.size()) * sizeof(Float);
+    return table;
 }
 
 // DielectricBxDF Method Definitions
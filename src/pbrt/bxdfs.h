@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <limits>
 #include <string>
 
@@ -427,6 +428,99 @@ class TopOrBottomBxDF {
     const BottomBxDF *bottom = nullptr;
 };
 
+// LayeredBxDFTable Definition
+// Stores the part of a two-sided, opaque _LayeredBxDF_'s value and PDF that
+// is otherwise estimated with random walks: everything but reflection at the
+// top interface.  Layers must be isotropic and have no scattering medium, so
+// that the BSDF only depends on $\cos\theta_\roman{o}$, $\cos\theta_\roman{i}$,
+// $\Delta\phi$, and a per-wavelength reflectance of the bottom interface.
+class LayeredBxDFTable {
+  public:
+    // LayeredBxDFTable Public Methods
+    LayeredBxDFTable(Allocator alloc)
+        : fTable(nCosTheta * nCosTheta * nPhi * nReflectance, alloc),
+          pdfTable(nCosTheta * nCosTheta * nPhi, alloc) {}
+
+    PBRT_CPU_GPU
+    SampledSpectrum f(Vector3f wo, Vector3f wi, const SampledSpectrum &r) const {
+        // Find reflectance knots and interpolation weights for each wavelength
+        int r0[NSpectrumSamples];
+        Float dr[NSpectrumSamples];
+        for (int c = 0; c < NSpectrumSamples; ++c) {
+            Float x = Clamp(r[c], 0, 1) * (nReflectance - 1);
+            r0[c] = std::min(int(x), nReflectance - 2);
+            dr[c] = x - r0[c];
+        }
+
+        // Trilinearly interpolate tabulated values over directions
+        SampledSpectrum f(0.f);
+        int index[8];
+        Float weight[8];
+        Corners(wo, wi, index, weight);
+        for (int j = 0; j < 8; ++j) {
+            if (weight[j] == 0)
+                continue;
+            const Float *v = &fTable[index[j] * nReflectance];
+            for (int c = 0; c < NSpectrumSamples; ++c)
+                f[c] += weight[j] * Lerp(dr[c], v[r0[c]], v[r0[c] + 1]);
+        }
+        return f;
+    }
+
+    PBRT_CPU_GPU
+    Float PDF(Vector3f wo, Vector3f wi) const {
+        Float pdf = 0;
+        int index[8];
+        Float weight[8];
+        Corners(wo, wi, index, weight);
+        for (int j = 0; j < 8; ++j)
+            pdf += weight[j] * pdfTable[index[j]];
+        return pdf;
+    }
+
+    std::string ToString() const;
+
+    // LayeredBxDFTable Public Members
+    static constexpr int nCosTheta = 16, nPhi = 16, nReflectance = 12;
+
+  private:
+    template <typename TopBxDF, typename BottomBxDF, bool twoSided>
+    friend class LayeredBxDF;
+
+    // LayeredBxDFTable Private Methods
+    PBRT_CPU_GPU
+    static Float NodeCosTheta(int i) { return (i + 0.5f) / nCosTheta; }
+    PBRT_CPU_GPU
+    static Float NodePhi(int i) { return Pi * (i + 0.5f) / nPhi; }
+    PBRT_CPU_GPU
+    static Float NodeReflectance(int i) { return Float(i) / (nReflectance - 1); }
+
+    PBRT_CPU_GPU
+    static void Corners(Vector3f wo, Vector3f wi, int index[8], Float weight[8]) {
+        // Compute table coordinates of _wo_ and _wi_ for node-centered lookup
+        Float x[3] = {AbsCosTheta(wo) * nCosTheta - 0.5f,
+                      AbsCosTheta(wi) * nCosTheta - 0.5f,
+                      SafeACos(CosDPhi(wo, wi)) * InvPi * nPhi - 0.5f};
+        int res[3] = {nCosTheta, nCosTheta, nPhi}, x0[3];
+        Float dx[3];
+        for (int d = 0; d < 3; ++d) {
+            x0[d] = Clamp(int(pstd::floor(x[d])), 0, res[d] - 2);
+            dx[d] = Clamp(x[d] - x0[d], 0, 1);
+        }
+
+        for (int j = 0; j < 8; ++j) {
+            int o = x0[0] + (j & 1), i = x0[1] + ((j >> 1) & 1), p = x0[2] + (j >> 2);
+            index[j] = (o * nCosTheta + i) * nPhi + p;
+            weight[j] = ((j & 1) ? dx[0] : 1 - dx[0]) *
+                        (((j >> 1) & 1) ? dx[1] : 1 - dx[1]) *
+                        ((j >> 2) ? dx[2] : 1 - dx[2]);
+        }
+    }
+
+    // LayeredBxDFTable Private Members
+    pstd::vector<Float> fTable, pdfTable;
+};
+
 // LayeredBxDF Definition
 template <typename TopBxDF, typename BottomBxDF, bool twoSided>
 class LayeredBxDF {
@@ -435,14 +529,22 @@ class LayeredBxDF {
     LayeredBxDF() = default;
     PBRT_CPU_GPU
     LayeredBxDF(TopBxDF top, BottomBxDF bottom, Float thickness,
-                const SampledSpectrum &albedo, Float g, int maxDepth, int nSamples)
+                const SampledSpectrum &albedo, Float g, int maxDepth, int nSamples,
+                const LayeredBxDFTable *table = nullptr,
+                const SampledSpectrum &tableReflectance = SampledSpectrum(0.f))
         : top(top),
           bottom(bottom),
           thickness(std::max(thickness, std::numeric_limits<Float>::min())),
           g(g),
           albedo(albedo),
           maxDepth(maxDepth),
-          nSamples(nSamples) {}
+          nSamples(nSamples),
+          table(table),
+          tableReflectance(tableReflectance) {}
+
+    static LayeredBxDFTable *Tabulate(
+        TopBxDF top, std::function<BottomBxDF(const SampledSpectrum &)> bottom,
+        Float thickness, int maxDepth, Allocator alloc);
 
     std::string ToString() const;
 
@@ -450,6 +552,8 @@ class LayeredBxDF {
     void Regularize() {
         top.Regularize();
         bottom.Regularize();
+        // The table was computed for the original interfaces
+        table = nullptr;
     }
 
     PBRT_CPU_GPU
@@ -483,6 +587,13 @@ class LayeredBxDF {
             wi = -wi;
         }
 
+        // Return tabulated _LayeredBxDF_ value if available
+        if (twoSided && table && mode == TransportMode::Radiance) {
+            if (!SameHemisphere(wo, wi))
+                return f;
+            return top.f(wo, wi, mode) + table->f(wo, wi, tableReflectance);
+        }
+
         // Determine entrance interface for layered BSDF
         TopOrBottomBxDF<TopBxDF, BottomBxDF> enterInterface;
         bool enteredTop = twoSided || wo.z > 0;
@@ -784,6 +895,14 @@ class LayeredBxDF {
             wi = -wi;
         }
 
+        // Return tabulated _LayeredBxDF_ PDF if available
+        if (twoSided && table && mode == TransportMode::Radiance) {
+            if (!SameHemisphere(wo, wi))
+                return Lerp(0.9f, 1 / (4 * Pi), 0);
+            return 0.9f * top.PDF(wo, wi, mode, BxDFReflTransFlags::Reflection) +
+                   table->PDF(wo, wi);
+        }
+
         // Declare _RNG_ for layered PDF evaluation
         RNG rng(Hash(GetOptions().seed, wi), Hash(wo));
         auto r = [&rng]() {
@@ -897,6 +1016,8 @@ class LayeredBxDF {
     Float thickness, g;
     SampledSpectrum albedo;
     int maxDepth, nSamples;
+    const LayeredBxDFTable *table = nullptr;
+    SampledSpectrum tableReflectance;
 };
 
 // CoatedDiffuseBxDF Definition
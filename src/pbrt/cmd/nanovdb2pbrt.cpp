@@ -52,6 +52,12 @@ static void usage(const std::string &msg = {}) {
 
 Options:
   --grid <name>        Name of grid to extract. Default: "density"
+  --outfile <name>     Write the grid and the temperature grid, if present, to an
+                       uncompressed and aligned NanoVDB file that the "nanovdb"
+                       medium can memory-map with "bool mmap" rather than
+                       printing the grid.
+  --temperaturegrid <name>
+                       Name of temperature grid for --outfile. Default: "temperature"
 )");
     exit(msg.empty() ? 0 : 1);
 }
@@ -66,6 +72,7 @@ int main(int argc, char *argv[]) {
 
     std::string filename;
     std::string grid = "density";
+    std::string outfile, temperatureGrid = "temperature";
     int downsample = 0;
     for (auto iter = args.begin(); iter != args.end(); ++iter) {
         if ((*iter)[0] != '-') {
@@ -76,7 +83,10 @@ int main(int argc, char *argv[]) {
                 exit(1);
             }
         } else if (ParseArg(&iter, args.end(), "downsample", &downsample, onError) ||
-                   ParseArg(&iter, args.end(), "grid", &grid, onError)) {
+                   ParseArg(&iter, args.end(), "grid", &grid, onError) ||
+                   ParseArg(&iter, args.end(), "outfile", &outfile, onError) ||
+                   ParseArg(&iter, args.end(), "temperaturegrid", &temperatureGrid,
+                            onError)) {
             // success
         } else {
             usage();
@@ -92,6 +102,18 @@ int main(int argc, char *argv[]) {
         readGrid<NanoVDBBuffer>(filename, grid, alloc);
     if (!nanoGrid)
         ErrorExit("%s: didn't find \"%s\" grid.", filename, grid);
+
+    if (!outfile.empty()) {
+        // Write the grids so that they can be memory-mapped
+        std::vector<nanovdb::GridHandle<NanoVDBBuffer>> handles;
+        handles.push_back(std::move(nanoGrid));
+        nanovdb::GridHandle<NanoVDBBuffer> tempGrid =
+            readGrid<NanoVDBBuffer>(filename, temperatureGrid, alloc);
+        if (tempGrid)
+            handles.push_back(std::move(tempGrid));
+        WriteMappableNanoVDBGrids(outfile, handles);
+        return 0;
+    }
     const nanovdb::FloatGrid *floatGrid = nanoGrid.grid<float>();
 
     nanovdb::BBox<nanovdb::Vec3R> bbox = floatGrid->worldBBox();
@@ -35,6 +35,11 @@ static void usage(const std::string &msg = {}) {
             R"(usage: pbrt [<options>] <filename.pbrt...>
 
 Rendering options:
+  --cache-dir <dir>             Directory in which to cache environment map
+                                sampling distributions between runs.
+  --compress-geometry           Store triangle meshes with octahedral normals,
+                                half-precision uvs, and 16-bit vertex indices to
+                                reduce memory use.
   --cropwindow <x0,x1,y0,y1>    Specify an image crop window w.r.t. [0,1]^2.
   --debugstart <values>         Inform the Integrator where to start rendering for
                                 faster debugging. (<values> are Integrator-specific
@@ -57,6 +62,8 @@ Rendering options:
             R"(
   --help                        Print this help text.
   --interactive                 Enable interactive rendering mode.
+  --lazy-geometry               Defer loading PLY meshes and building their BVHs
+                                until a ray first reaches their bounds.
   --mse-reference-image         Filename for reference image to use for MSE computation.
   --mse-reference-out           File to write MSE error vs spp results.
   --nthreads <num>              Use specified number of threads for rendering.
@@ -67,6 +74,9 @@ Rendering options:
                                 center of the pixel's extent.
   --pixelstats                  Record per-pixel statistics and write additional images
                                 with their values.
+  --quantize-positions          With --compress-geometry, also quantize triangle
+                                mesh positions relative to each mesh's bounds.
+                                Edges shared between meshes may then show cracks.
   --quick                       Automatically reduce a number of quality settings
                                 to render more quickly.
   --quiet                       Suppress all text output other than error messages.
@@ -92,6 +102,9 @@ Logging options:
 Reformatting options:
   --format                      Print a reformatted version of the input file(s) to
                                 standard output. Does not render an image.
+  --tobinary <filename>         Write the input file(s) to the given file in pbrt's
+                                binary scene format, which loads more quickly.
+                                Included files are inlined. Does not render an image.
   --toply                       Print a reformatted version of the input file(s) to
                                 standard output and convert all triangle meshes to
                                 PLY files. Does not render an image.
@@ -111,6 +124,7 @@ int main(int argc, char *argv[]) {
     std::vector<std::string> filenames;
     std::string logLevel = "error";
     std::string renderCoordSys = "cameraworld";
+    std::string binaryFilename;
     bool format = false, toPly = false;
 
     // Process command-line arguments
@@ -164,6 +178,12 @@ int main(int argc, char *argv[]) {
             ParseArg(&iter, args.end(), "debugstart", &options.debugStart, onError) ||
             ParseArg(&iter, args.end(), "disable-image-textures",
                      &options.disableImageTextures, onError) ||
+            ParseArg(&iter, args.end(), "cache-dir", &options.cacheDirectory,
+                     onError) ||
+            ParseArg(&iter, args.end(), "compress-geometry", &options.compressGeometry,
+                     onError) ||
+            ParseArg(&iter, args.end(), "quantize-positions",
+                     &options.quantizePositions, onError) ||
             ParseArg(&iter, args.end(), "disable-pixel-jitter",
                      &options.disablePixelJitter, onError) ||
             ParseArg(&iter, args.end(), "disable-texture-filtering",
@@ -182,6 +202,8 @@ int main(int argc, char *argv[]) {
                      onError) ||
             ParseArg(&iter, args.end(), "log-file", &options.logFile, onError) ||
             ParseArg(&iter, args.end(), "interactive", &options.interactive, onError) ||
+            ParseArg(&iter, args.end(), "lazy-geometry", &options.lazyGeometry,
+                     onError) ||
             ParseArg(&iter, args.end(), "fullscreen", &options.fullscreen, onError) ||
             ParseArg(&iter, args.end(), "mse-reference-image", &options.mseReferenceImage,
                      onError) ||
@@ -197,6 +219,7 @@ int main(int argc, char *argv[]) {
             ParseArg(&iter, args.end(), "seed", &options.seed, onError) ||
             ParseArg(&iter, args.end(), "spp", &options.pixelSamples, onError) ||
             ParseArg(&iter, args.end(), "stats", &options.printStatistics, onError) ||
+            ParseArg(&iter, args.end(), "tobinary", &binaryFilename, onError) ||
             ParseArg(&iter, args.end(), "toply", &toPly, onError) ||
             ParseArg(&iter, args.end(), "wavefront", &options.wavefront, onError) ||
             ParseArg(&iter, args.end(), "write-partial-images",
@@ -213,7 +236,8 @@ int main(int argc, char *argv[]) {
     }
 
     // Print welcome banner
-    if (!options.quiet && !format && !toPly && !options.upgrade) {
+    if (!options.quiet && !format && !toPly && !options.upgrade &&
+        binaryFilename.empty()) {
         printf("pbrt version 4 (built %s at %s)\n", __DATE__, __TIME__);
 #ifdef PBRT_DEBUG_BUILD
         LOG_VERBOSE("Running debug build");
@@ -275,6 +299,9 @@ int main(int argc, char *argv[]) {
     if (format || toPly || options.upgrade) {
         FormattingParserTarget formattingTarget(toPly, options.upgrade);
         ParseFiles(&formattingTarget, filenames);
+    } else if (!binaryFilename.empty()) {
+        BinarySceneWriter binaryWriter(binaryFilename);
+        ParseFiles(&binaryWriter, filenames);
     } else {
         // Parse provided scene description files
         BasicScene scene;
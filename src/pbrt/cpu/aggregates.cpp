@@ -25,6 +25,7 @@ STAT_RATIO("BVH/Primitives per leaf node", totalPrimitives, totalLeafNodes);
 STAT_COUNTER("BVH/Interior nodes", interiorNodes);
 STAT_COUNTER("BVH/Leaf nodes", leafNodes);
 STAT_PIXEL_COUNTER("BVH/Nodes visited", bvhNodesVisited);
+STAT_COUNTER("BVH/Shadow rays occluded by previous occluder", occluderHintHits);
 
 // MortonPrimitive Definition
 struct MortonPrimitive {
@@ -579,8 +580,19 @@ pstd::optional<ShapeIntersection> BVHAggregate::Intersect(const Ray &ray,
 }
 
 bool BVHAggregate::IntersectP(const Ray &ray, Float tMax) const {
+    int occluder = -1;
+    return IntersectP(ray, tMax, &occluder);
+}
+
+bool BVHAggregate::IntersectP(const Ray &ray, Float tMax, int *occluder) const {
     if (!nodes)
         return false;
+    // Test the previous occluder before traversing the BVH
+    if (*occluder >= 0 && primitives[*occluder].IntersectP(ray, tMax)) {
+        ++occluderHintHits;
+        return true;
+    }
+
     Vector3f invDir(1.f / ray.d.x, 1.f / ray.d.y, 1.f / ray.d.z);
     int dirIsNeg[3] = {static_cast<int>(invDir.x < 0), static_cast<int>(invDir.y < 0),
                        static_cast<int>(invDir.z < 0)};
@@ -597,6 +609,7 @@ bool BVHAggregate::IntersectP(const Ray &ray, Float tMax) const {
                 for (int i = 0; i < node->nPrimitives; ++i) {
                     if (primitives[node->primitivesOffset + i].IntersectP(ray, tMax)) {
                         bvhNodesVisited += nodesVisited;
+                        *occluder = node->primitivesOffset + i;
                         return true;
                     }
                 }
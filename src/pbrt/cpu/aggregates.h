@@ -40,6 +40,10 @@ class BVHAggregate {
     Bounds3f Bounds() const;
     pstd::optional<ShapeIntersection> Intersect(const Ray &ray, Float tMax) const;
     bool IntersectP(const Ray &ray, Float tMax) const;
+    // _*occluder_ gives the index of a primitive to test before traversing
+    // the BVH, or -1; if the ray is occluded, it is set to the index of
+    // the primitive that occluded it.
+    bool IntersectP(const Ray &ray, Float tMax, int *occluder) const;
 
   private:
     // BVHAggregate Private Methods
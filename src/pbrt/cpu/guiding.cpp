@@ -0,0 +1,288 @@
+// pbrt is Copyright(c) 1998-2020 Matt Pharr, Wenzel Jakob, and Greg Humphreys.
+// The pbrt source code is licensed under the Apache License, Version 2.0.
+// SPDX: Apache-2.0
+
+#include <pbrt/cpu/guiding.h>
+
+#include <pbrt/util/check.h>
+#include <pbrt/util/log.h>
+#include <pbrt/util/math.h>
+#include <pbrt/util/print.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace pbrt {
+
+// Path Guiding Constants
+// Spatial regions are split once they receive more than
+// _SpatialSplitSamples_ times the square root of the wave's sample count
+// path vertices; directional quadtree nodes are subdivided when they hold
+// more than _QuadtreeSubdivisionThreshold_ of their region's energy.
+static constexpr Float SpatialSplitSamples = 12000;
+static constexpr int MaxSpatialDepth = 24;
+static constexpr Float QuadtreeSubdivisionThreshold = 0.01f;
+static constexpr int MaxQuadtreeDepth = 20;
+
+// DirectionalQuadtree Method Definitions
+DirectionalQuadtree::DirectionalQuadtree()
+    : children(1, pstd::array<int, 4>{0, 0, 0, 0}),
+      sums(std::make_unique<AtomicFloat[]>(4)) {}
+
+DirectionalQuadtree::DirectionalQuadtree(const DirectionalQuadtree &t)
+    : children(t.children), sums(std::make_unique<AtomicFloat[]>(4 * t.NodeCount())) {
+    for (size_t i = 0; i < 4 * NodeCount(); ++i)
+        sums[i] = Float(t.sums[i]);
+}
+
+DirectionalQuadtree &DirectionalQuadtree::operator=(const DirectionalQuadtree &t) {
+    if (this != &t)
+        *this = DirectionalQuadtree(t);
+    return *this;
+}
+
+void DirectionalQuadtree::Add(Point2f p, Float value) {
+    int n = 0;
+    while (true) {
+        int x = p.x >= 0.5f, y = p.y >= 0.5f, q = x + 2 * y;
+        if (children[n][q] == 0) {
+            sums[4 * n + q].Add(value);
+            return;
+        }
+        p = Point2f(2 * p.x - x, 2 * p.y - y);
+        n = children[n][q];
+    }
+}
+
+void DirectionalQuadtree::Build() {
+    // Sum leaf values into interior quadrants; children follow their parents
+    for (int n = int(NodeCount()) - 1; n >= 0; --n)
+        for (int q = 0; q < 4; ++q)
+            if (int c = children[n][q]; c != 0)
+                sums[4 * n + q] = sums[4 * c] + sums[4 * c + 1] + sums[4 * c + 2] +
+                                  sums[4 * c + 3];
+}
+
+Point2f DirectionalQuadtree::Sample(Point2f u) const {
+    Point2f pMin(0, 0);
+    Float width = 1;
+    int n = 0;
+    while (true) {
+        // Choose the left or right half of the node, then one of its quadrants
+        Float s[4] = {sums[4 * n], sums[4 * n + 1], sums[4 * n + 2], sums[4 * n + 3]};
+        Float left = s[0] + s[2], right = s[1] + s[3];
+        int x = 0, y = 0;
+        if (right == 0 || u[0] * (left + right) < left)
+            u[0] = std::min(u[0] * (left + right) / left, OneMinusEpsilon);
+        else {
+            u[0] = std::min((u[0] * (left + right) - left) / right, OneMinusEpsilon);
+            x = 1;
+        }
+        Float lower = s[x], upper = s[x + 2];
+        if (upper == 0 || u[1] * (lower + upper) < lower)
+            u[1] = std::min(u[1] * (lower + upper) / lower, OneMinusEpsilon);
+        else {
+            u[1] = std::min((u[1] * (lower + upper) - lower) / upper, OneMinusEpsilon);
+            y = 1;
+        }
+
+        // Descend into the chosen quadrant or sample it uniformly at a leaf
+        width /= 2;
+        pMin = Point2f(pMin.x + x * width, pMin.y + y * width);
+        int q = x + 2 * y;
+        if (children[n][q] == 0)
+            return Point2f(pMin.x + width * u[0], pMin.y + width * u[1]);
+        n = children[n][q];
+    }
+}
+
+Float DirectionalQuadtree::PDF(Point2f p) const {
+    Float pdf = 1;
+    int n = 0;
+    while (true) {
+        Float total = sums[4 * n] + sums[4 * n + 1] + sums[4 * n + 2] + sums[4 * n + 3];
+        if (total == 0)
+            return 0;
+        int x = p.x >= 0.5f, y = p.y >= 0.5f, q = x + 2 * y;
+        pdf *= 4 * sums[4 * n + q] / total;
+        if (children[n][q] == 0)
+            return pdf;
+        p = Point2f(2 * p.x - x, 2 * p.y - y);
+        n = children[n][q];
+    }
+}
+
+DirectionalQuadtree DirectionalQuadtree::Refined(Float subdivisionThreshold,
+                                                 int maxDepth) const {
+    DirectionalQuadtree t;
+    Float total = Total();
+    if (total == 0)
+        return t;
+
+    // Subdivide quadrants holding more than _subdivisionThreshold_ of the
+    // energy; the energy of quadrants that are leaves here is assumed to be
+    // spread uniformly over their subquadrants.
+    struct Entry {
+        int node, refinedNode, depth;
+        Float fraction;
+    };
+    std::vector<Entry> stack{{0, 0, 1, Float(1)}};
+    while (!stack.empty()) {
+        Entry e = stack.back();
+        stack.pop_back();
+        for (int q = 0; q < 4; ++q) {
+            Float fraction = e.node >= 0 ? sums[4 * e.node + q] / total : e.fraction / 4;
+            if (fraction <= subdivisionThreshold || e.depth == maxDepth)
+                continue;
+            int child = int(t.children.size());
+            t.children.push_back({0, 0, 0, 0});
+            t.children[e.refinedNode][q] = child;
+            int node = (e.node >= 0 && children[e.node][q] != 0) ? children[e.node][q] : -1;
+            stack.push_back({node, child, e.depth + 1, fraction});
+        }
+    }
+    t.sums = std::make_unique<AtomicFloat[]>(4 * t.NodeCount());
+    return t;
+}
+
+std::string DirectionalQuadtree::ToString() const {
+    return StringPrintf("[ DirectionalQuadtree nodes: %d total: %f ]", NodeCount(),
+                        Total());
+}
+
+// PathGuide Method Definitions
+PathGuide::PathGuide(const Bounds3f &sceneBounds, Float bsdfSamplingFraction)
+    : bsdfSamplingFraction(bsdfSamplingFraction) {
+    // Subdivide a cube enclosing the scene so that splits alternate evenly
+    Point3f pCenter;
+    Float radius;
+    sceneBounds.BoundingSphere(&pCenter, &radius);
+    bounds = Bounds3f(pCenter - Vector3f(radius, radius, radius),
+                      pCenter + Vector3f(radius, radius, radius));
+
+    nodes.push_back(SpatialNode{0, 0, 0});
+    regions.push_back(std::make_unique<GuidingRegion>());
+}
+
+GuidingRegion *PathGuide::Lookup(Point3f p) const {
+    Bounds3f b = bounds;
+    int n = 0;
+    while (!nodes[n].IsLeaf()) {
+        int axis = nodes[n].depth % 3;
+        Float mid = (b.pMin[axis] + b.pMax[axis]) / 2;
+        if (p[axis] < mid) {
+            b.pMax[axis] = mid;
+            n = nodes[n].firstChild;
+        } else {
+            b.pMin[axis] = mid;
+            n = nodes[n].firstChild + 1;
+        }
+    }
+    return regions[nodes[n].region].get();
+}
+
+pstd::optional<BSDFSample> PathGuide::Sample_f(const BSDF &bsdf,
+                                               const GuidingRegion *region, Vector3f wo,
+                                               Float u, Point2f u2) const {
+    if (!Guided(bsdf, region))
+        return bsdf.Sample_f(wo, u, u2);
+
+    pstd::optional<BSDFSample> bs;
+    if (u < bsdfSamplingFraction) {
+        // Sample the BSDF, making sure that _f_ is not scaled to a proportional PDF
+        bs = bsdf.Sample_f(wo, std::min(u / bsdfSamplingFraction, OneMinusEpsilon), u2);
+        if (!bs)
+            return {};
+        if (bs->pdfIsProportional)
+            bs->f = bsdf.f(wo, bs->wi);
+
+    } else {
+        // Sample the guiding distribution and evaluate the BSDF for its direction
+        // Only reflective BSDFs are guided, so any direction with nonzero _f_
+        // is a reflection.
+        Vector3f wi = region->Sample(u2);
+        SampledSpectrum f = bsdf.f(wo, wi);
+        if (!f)
+            return {};
+        BxDFFlags flags = IsGlossy(bsdf.Flags()) ? BxDFFlags::GlossyReflection
+                                                 : BxDFFlags::DiffuseReflection;
+        bs = BSDFSample(f, wi, 0, flags);
+    }
+
+    // Return sample with the PDF of the BSDF and guiding distribution mixture
+    bs->pdf = PDF(bsdf, region, wo, bs->wi);
+    bs->pdfIsProportional = false;
+    if (bs->pdf == 0)
+        return {};
+    return bs;
+}
+
+Float PathGuide::PDF(const BSDF &bsdf, const GuidingRegion *region, Vector3f wo,
+                     Vector3f wi) const {
+    Float bsdfPDF = bsdf.PDF(wo, wi);
+    if (!Guided(bsdf, region))
+        return bsdfPDF;
+    return Lerp(bsdfSamplingFraction, region->PDF(wi), bsdfPDF);
+}
+
+void PathGuide::Record(pstd::span<const GuidingVertex> path,
+                       const SampledSpectrum &L) const {
+    for (const GuidingVertex &v : path) {
+        // Estimate incident radiance along _v.wi_ from radiance found after _v_
+        Float Li = std::max<Float>(0, SafeDiv(L - v.L, v.beta).Average());
+        if (IsInf(Li) || IsNaN(Li) || v.pdf == 0)
+            continue;
+        v.region->building.Add(EqualAreaSphereToSquare(v.wi), Li / v.pdf);
+        ++v.region->nSamples;
+    }
+}
+
+void PathGuide::Refine(int nWaveSamples) {
+    // Split spatial regions that received many path vertices during the wave
+    int64_t splitThreshold = SpatialSplitSamples * std::sqrt(Float(nWaveSamples));
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!nodes[i].IsLeaf() || nodes[i].depth == MaxSpatialDepth)
+            continue;
+        GuidingRegion *region = regions[nodes[i].region].get();
+        if (region->nSamples < splitThreshold)
+            continue;
+
+        // Give both children a copy of the region's quadtrees and half its samples
+        region->nSamples = region->nSamples / 2;
+        auto split = std::make_unique<GuidingRegion>();
+        split->sampling = region->sampling;
+        split->building = region->building;
+        split->nSamples = region->nSamples.load();
+
+        int depth = nodes[i].depth + 1;
+        int firstChild = int(nodes.size());
+        nodes.push_back(SpatialNode{0, nodes[i].region, depth});
+        nodes.push_back(SpatialNode{0, int(regions.size()), depth});
+        regions.push_back(std::move(split));
+        nodes[i].firstChild = firstChild;
+        nodes[i].region = -1;
+    }
+
+    // Sample from the distributions learned during the wave and refine them
+    ParallelFor(0, regions.size(), [&](int64_t i) {
+        GuidingRegion &region = *regions[i];
+        region.building.Build();
+        // Keep the previous distribution if no radiance was found in the region
+        if (region.building.Total() > 0)
+            region.sampling = std::move(region.building);
+        region.building =
+            region.sampling.Refined(QuadtreeSubdivisionThreshold, MaxQuadtreeDepth);
+        region.nSamples = 0;
+    });
+
+    LOG_VERBOSE("Path guiding refined for %d sample wave: %d spatial regions",
+                nWaveSamples, regions.size());
+}
+
+std::string PathGuide::ToString() const {
+    return StringPrintf("[ PathGuide bounds: %s bsdfSamplingFraction: %f "
+                        "spatialNodes: %d regions: %d ]",
+                        bounds, bsdfSamplingFraction, nodes.size(), regions.size());
+}
+
+}  // namespace pbrt
@@ -0,0 +1,125 @@
+// pbrt is Copyright(c) 1998-2020 Matt Pharr, Wenzel Jakob, and Greg Humphreys.
+// The pbrt source code is licensed under the Apache License, Version 2.0.
+// SPDX: Apache-2.0
+
+#ifndef PBRT_CPU_GUIDING_H
+#define PBRT_CPU_GUIDING_H
+
+#include <pbrt/pbrt.h>
+
+#include <pbrt/bsdf.h>
+#include <pbrt/util/containers.h>
+#include <pbrt/util/parallel.h>
+#include <pbrt/util/pstd.h>
+#include <pbrt/util/spectrum.h>
+#include <pbrt/util/vecmath.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pbrt {
+
+// DirectionalQuadtree Definition
+class DirectionalQuadtree {
+  public:
+    // DirectionalQuadtree Public Methods
+    DirectionalQuadtree();
+
+    DirectionalQuadtree(const DirectionalQuadtree &t);
+    DirectionalQuadtree &operator=(const DirectionalQuadtree &t);
+    DirectionalQuadtree(DirectionalQuadtree &&) = default;
+    DirectionalQuadtree &operator=(DirectionalQuadtree &&) = default;
+
+    Float Total() const { return sums[0] + sums[1] + sums[2] + sums[3]; }
+
+    void Add(Point2f p, Float value);
+    void Build();
+
+    Point2f Sample(Point2f u) const;
+    Float PDF(Point2f p) const;
+
+    DirectionalQuadtree Refined(Float subdivisionThreshold, int maxDepth) const;
+
+    size_t NodeCount() const { return children.size(); }
+
+    std::string ToString() const;
+
+  private:
+    // DirectionalQuadtree Private Members
+    // Quadrant _q_ of node _n_ covers the square's (q & 1, q >> 1) quarter;
+    // _children[n][q]_ is the index of its child node, or zero for a leaf.
+    std::vector<pstd::array<int, 4>> children;
+    std::unique_ptr<AtomicFloat[]> sums;
+};
+
+// GuidingRegion Definition
+struct GuidingRegion {
+    // GuidingRegion Public Methods
+    bool CanSample() const { return sampling.Total() > 0; }
+
+    Vector3f Sample(Point2f u) const {
+        return EqualAreaSquareToSphere(sampling.Sample(u));
+    }
+    Float PDF(Vector3f w) const {
+        return sampling.PDF(EqualAreaSphereToSquare(w)) * Inv4Pi;
+    }
+
+    // GuidingRegion Public Members
+    DirectionalQuadtree sampling, building;
+    std::atomic<int64_t> nSamples{0};
+};
+
+// GuidingVertex Definition
+struct GuidingVertex {
+    GuidingRegion *region;
+    Vector3f wi;
+    Float pdf;
+    // Radiance estimate when the vertex was scattered and path throughput
+    // after scattering, from which incident radiance along _wi_ is found
+    SampledSpectrum L, beta;
+};
+
+// PathGuide Definition
+class PathGuide {
+  public:
+    // PathGuide Public Methods
+    PathGuide(const Bounds3f &sceneBounds, Float bsdfSamplingFraction = 0.5f);
+
+    GuidingRegion *Lookup(Point3f p) const;
+
+    pstd::optional<BSDFSample> Sample_f(const BSDF &bsdf, const GuidingRegion *region,
+                                        Vector3f wo, Float u, Point2f u2) const;
+    Float PDF(const BSDF &bsdf, const GuidingRegion *region, Vector3f wo,
+              Vector3f wi) const;
+
+    void Record(pstd::span<const GuidingVertex> path, const SampledSpectrum &L) const;
+    void Refine(int nWaveSamples);
+
+    std::string ToString() const;
+
+  private:
+    // PathGuide Private Methods
+    bool Guided(const BSDF &bsdf, const GuidingRegion *region) const {
+        // BSDFs with transmission aren't guided, since a guided refracted
+        // direction's _BSDFSample_ would need the BSDF's relative IOR.
+        BxDFFlags flags = bsdf.Flags();
+        return region && !IsSpecular(flags) && !IsTransmissive(flags) &&
+               region->CanSample();
+    }
+
+    // PathGuide Private Members
+    struct SpatialNode {
+        bool IsLeaf() const { return firstChild == 0; }
+        int firstChild = 0, region = -1, depth = 0;
+    };
+    Bounds3f bounds;
+    Float bsdfSamplingFraction;
+    std::vector<SpatialNode> nodes;
+    std::vector<std::unique_ptr<GuidingRegion>> regions;
+};
+
+}  // namespace pbrt
+
+#endif  // PBRT_CPU_GUIDING_H
@@ -185,6 +185,8 @@ void ImageTileIntegrator::Render() {
                      tileBounds.pMin.y, tileBounds.pMax.x, tileBounds.pMax.y);
             progress.Update((waveEnd - waveStart) * tileBounds.Area());
         });
+        if (waveEnd < spp)
+            EndWave(waveEnd - waveStart);
 
         // Update start and end wave
         waveStart = waveEnd;
@@ -619,11 +621,20 @@ STAT_INT_DISTRIBUTION("Integrator/Path length", pathLength);
 // PathIntegrator Method Definitions
 PathIntegrator::PathIntegrator(int maxDepth, Camera camera, Sampler sampler,
                                Primitive aggregate, std::vector<Light> lights,
-                               const std::string &lightSampleStrategy, bool regularize)
+                               const std::string &lightSampleStrategy, bool regularize,
+                               int nLightCandidates, bool guiding,
+                               bool lightVisibility)
     : RayIntegrator(camera, sampler, aggregate, lights),
       maxDepth(maxDepth),
       lightSampler(LightSampler::Create(lightSampleStrategy, lights, Allocator())),
-      regularize(regularize) {}
+      regularize(regularize),
+      nLightCandidates(nLightCandidates) {
+    if (guiding && aggregate)
+        guide = std::make_unique<PathGuide>(aggregate.Bounds());
+    if (lightVisibility && aggregate && lightSampler.Is<BVHLightSampler>())
+        visibilityCache = std::make_unique<LightVisibilityCache>(
+            lightSampler.Cast<BVHLightSampler>(), aggregate.Bounds());
+}
 
 SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lambda,
                                    Sampler sampler, ScratchBuffer &scratchBuffer,
@@ -636,6 +647,11 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
     bool specularBounce = false, anyNonSpecularBounces = false;
     LightSampleContext prevIntrCtx;
 
+    // Allocate storage for path vertices used to train the path guide
+    GuidingVertex *guidingVertices =
+        guide ? scratchBuffer.Alloc<GuidingVertex[]>(maxDepth) : nullptr;
+    int nGuidingVertices = 0;
+
     // Sample path from camera and accumulate radiance estimate
     while (true) {
         // Trace ray and find closest path vertex and its BSDF
@@ -649,7 +665,7 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
                     L += beta * Le;
                 else {
                     // Compute MIS weight for infinite light
-                    Float p_l = lightSampler.PMF(prevIntrCtx, light) *
+                    Float p_l = LightPMF(prevIntrCtx, light) *
                                 light.PDF_Li(prevIntrCtx, ray.d, true);
                     Float w_b = PowerHeuristic(1, p_b, 1, p_l);
 
@@ -667,7 +683,7 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
             else {
                 // Compute MIS weight for area light
                 Light areaLight(si->intr.areaLight);
-                Float p_l = lightSampler.PMF(prevIntrCtx, areaLight) *
+                Float p_l = LightPMF(prevIntrCtx, areaLight) *
                             areaLight.PDF_Li(prevIntrCtx, ray.d, true);
                 Float w_l = PowerHeuristic(1, p_b, 1, p_l);
 
@@ -720,10 +736,13 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
         if (depth++ == maxDepth)
             break;
 
+        // Find the path guiding region for the surface vertex
+        GuidingRegion *region = guide ? guide->Lookup(isect.p()) : nullptr;
+
         // Sample direct illumination from the light sources
         if (IsNonSpecular(bsdf.Flags())) {
             ++totalPaths;
-            SampledSpectrum Ld = SampleLd(isect, &bsdf, lambda, sampler);
+            SampledSpectrum Ld = SampleLd(isect, &bsdf, region, lambda, sampler);
             if (!Ld)
                 ++zeroRadiancePaths;
             L += beta * Ld;
@@ -732,13 +751,18 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
         // Sample BSDF to get new path direction
         Vector3f wo = -ray.d;
         Float u = sampler.Get1D();
-        pstd::optional<BSDFSample> bs = bsdf.Sample_f(wo, u, sampler.Get2D());
+        pstd::optional<BSDFSample> bs =
+            guide ? guide->Sample_f(bsdf, region, wo, u, sampler.Get2D())
+                  : bsdf.Sample_f(wo, u, sampler.Get2D());
         if (!bs)
             break;
         // Update path state variables after surface scattering
         beta *= bs->f * AbsDot(bs->wi, isect.shading.n) / bs->pdf;
         p_b = bs->pdfIsProportional ? bsdf.PDF(wo, bs->wi) : bs->pdf;
         DCHECK(!IsInf(beta.y(lambda)));
+        if (region && !bs->IsSpecular())
+            guidingVertices[nGuidingVertices++] =
+                GuidingVertex{region, bs->wi, p_b, L, beta};
         specularBounce = bs->IsSpecular();
         anyNonSpecularBounces |= !bs->IsSpecular();
         if (bs->IsTransmission())
@@ -757,11 +781,17 @@ SampledSpectrum PathIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
             DCHECK(!IsInf(beta.y(lambda)));
         }
     }
+    // Train path guide with the incident radiance found at path vertices
+    if (nGuidingVertices > 0)
+        guide->Record(pstd::span<const GuidingVertex>(guidingVertices, nGuidingVertices),
+                      L);
+
     pathLength << depth;
     return L;
 }
 
 SampledSpectrum PathIntegrator::SampleLd(const SurfaceInteraction &intr, const BSDF *bsdf,
+                                         const GuidingRegion *region,
                                          SampledWavelengths &lambda,
                                          Sampler sampler) const {
     // Initialize _LightSampleContext_ for light sampling
@@ -773,9 +803,14 @@ SampledSpectrum PathIntegrator::SampleLd(const SurfaceInteraction &intr, const B
     else if (IsTransmissive(flags) && !IsReflective(flags))
         ctx.pi = intr.OffsetRayOrigin(-intr.wo);
 
-    // Choose a light source for the direct lighting calculation
+    if (nLightCandidates > 1)
+        return SampleLdResampled(intr, bsdf, region, ctx, lambda, sampler);
+
+    // Choose a light source for the direct lighting calculation; the
+    // visibility cache is keyed on the unoffset point, as it is for MIS
+    LightSampleContext regionCtx(intr);
     Float u = sampler.Get1D();
-    pstd::optional<SampledLight> sampledLight = lightSampler.Sample(ctx, u);
+    pstd::optional<SampledLight> sampledLight = SampleLight(ctx, regionCtx, u);
     Point2f uLight = sampler.Get2D();
     if (!sampledLight)
         return {};
@@ -790,7 +825,12 @@ SampledSpectrum PathIntegrator::SampleLd(const SurfaceInteraction &intr, const B
     // Evaluate BSDF for light sample and check light visibility
     Vector3f wo = intr.wo, wi = ls->wi;
     SampledSpectrum f = bsdf->f(wo, wi) * AbsDot(wi, intr.shading.n);
-    if (!f || !Unoccluded(intr, ls->pLight))
+    if (!f)
+        return {};
+    bool unoccluded = Unoccluded(intr, ls->pLight);
+    if (visibilityCache)
+        visibilityCache->Record(regionCtx, light, unoccluded);
+    if (!unoccluded)
         return {};
 
     // Return light's contribution to reflected radiance
@@ -798,15 +838,85 @@ SampledSpectrum PathIntegrator::SampleLd(const SurfaceInteraction &intr, const B
     if (IsDeltaLight(light.Type()))
         return ls->L * f / p_l;
     else {
-        Float p_b = bsdf->PDF(wo, wi);
+        Float p_b = guide ? guide->PDF(*bsdf, region, wo, wi) : bsdf->PDF(wo, wi);
         Float w_l = PowerHeuristic(1, p_l, 1, p_b);
         return w_l * ls->L * f / p_l;
     }
 }
 
+SampledSpectrum PathIntegrator::SampleLdResampled(const SurfaceInteraction &intr,
+                                                  const BSDF *bsdf,
+                                                  const GuidingRegion *region,
+                                                  const LightSampleContext &ctx,
+                                                  SampledWavelengths &lambda,
+                                                  Sampler sampler) const {
+    // Resampled importance sampling: generate _nLightCandidates_ light
+    // samples, choose one of them with probability proportional to its
+    // unshadowed contribution, and only trace a shadow ray for that one.
+    struct LightCandidate {
+        SampledSpectrum contrib;
+        Float targetPDF;
+        Light light;
+        Interaction pLight;
+    };
+    LightSampleContext regionCtx(intr);
+    Float u = sampler.Get1D();
+    Point2f uLight = sampler.Get2D();
+    WeightedReservoirSampler<LightCandidate> wrs(Hash(sampler.Get1D()));
+
+    Vector3f wo = intr.wo;
+    for (int i = 0; i < nLightCandidates; ++i) {
+        // Compute sample values for candidate _i_; light selection is
+        // stratified and the point on the light is sampled with a
+        // Cranley-Patterson rotation of _uLight_.
+        auto rotate = [](Float v, Float offset) {
+            v += offset;
+            return std::min<Float>(v - pstd::floor(v), OneMinusEpsilon);
+        };
+        Float ui = std::min<Float>((i + u) / nLightCandidates, OneMinusEpsilon);
+        Point2f uLi(rotate(uLight[0], i * 0.7548776662f),
+                    rotate(uLight[1], i * 0.5698402910f));
+
+        // Sample light candidate and compute its unshadowed contribution
+        pstd::optional<SampledLight> sampledLight = SampleLight(ctx, regionCtx, ui);
+        if (!sampledLight)
+            continue;
+        Light light = sampledLight->light;
+        pstd::optional<LightLiSample> ls = light.SampleLi(ctx, uLi, lambda, true);
+        if (!ls || !ls->L || ls->pdf == 0)
+            continue;
+        SampledSpectrum f = bsdf->f(wo, ls->wi) * AbsDot(ls->wi, intr.shading.n);
+        if (!f)
+            continue;
+
+        Float p_l = sampledLight->p * ls->pdf;
+        Float p_b = guide ? guide->PDF(*bsdf, region, wo, ls->wi) : bsdf->PDF(wo, ls->wi);
+        Float w_l = IsDeltaLight(light.Type()) ? 1 : PowerHeuristic(1, p_l, 1, p_b);
+        SampledSpectrum contrib = w_l * ls->L * f;
+        if (Float targetPDF = contrib.Average(); targetPDF > 0)
+            wrs.Add(LightCandidate{contrib, targetPDF, light, ls->pLight},
+                    targetPDF / p_l);
+    }
+
+    // Return the selected candidate's contribution if it is unoccluded
+    if (!wrs.HasSample())
+        return {};
+    const LightCandidate &c = wrs.GetSample();
+    bool unoccluded = Unoccluded(intr, c.pLight);
+    if (visibilityCache)
+        visibilityCache->Record(regionCtx, c.light, unoccluded);
+    if (!unoccluded)
+        return {};
+    return c.contrib * wrs.WeightSum() / (nLightCandidates * c.targetPDF);
+}
+
 std::string PathIntegrator::ToString() const {
-    return StringPrintf("[ PathIntegrator maxDepth: %d lightSampler: %s regularize: %s ]",
-                        maxDepth, lightSampler, regularize);
+    return StringPrintf("[ PathIntegrator maxDepth: %d lightSampler: %s regularize: %s "
+                        "nLightCandidates: %d guide: %s visibilityCache: %s ]",
+                        maxDepth, lightSampler, regularize, nLightCandidates,
+                        guide ? guide->ToString() : std::string("(nullptr)"),
+                        visibilityCache ? visibilityCache->ToString()
+                                        : std::string("(nullptr)"));
 }
 
 std::unique_ptr<PathIntegrator> PathIntegrator::Create(
@@ -815,8 +925,20 @@ std::unique_ptr<PathIntegrator> PathIntegrator::Create(
     int maxDepth = parameters.GetOneInt("maxdepth", 5);
     std::string lightStrategy = parameters.GetOneString("lightsampler", "bvh");
     bool regularize = parameters.GetOneBool("regularize", false);
+    int nLightCandidates = parameters.GetOneInt("lightcandidates", 1);
+    if (nLightCandidates < 1)
+        ErrorExit(loc, "%d: \"lightcandidates\" must be at least one.",
+                  nLightCandidates);
+    bool guiding = parameters.GetOneBool("guiding", false);
+    bool lightVisibility = parameters.GetOneBool("lightvisibility", false);
+    if (lightVisibility && lightStrategy != "bvh") {
+        Warning(loc, "\"lightvisibility\" is only supported with the \"bvh\" light "
+                     "sampler.");
+        lightVisibility = false;
+    }
     return std::make_unique<PathIntegrator>(maxDepth, camera, sampler, aggregate, lights,
-                                            lightStrategy, regularize);
+                                            lightStrategy, regularize, nLightCandidates,
+                                            guiding, lightVisibility);
 }
 
 // SimpleVolPathIntegrator Method Definitions
@@ -961,6 +1083,11 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
 
     LightSampleContext prevIntrContext;
 
+    // Allocate storage for path vertices used to train the path guide
+    GuidingVertex *guidingVertices =
+        guide ? scratchBuffer.Alloc<GuidingVertex[]>(maxDepth) : nullptr;
+    int nGuidingVertices = 0;
+
     while (true) {
         // Sample segment of volumetric scattering path
         PBRT_DBG("%s\n", StringPrintf("Path tracer depth %d, current L = %s, beta = %s\n",
@@ -976,10 +1103,11 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
             uint64_t hash1 = Hash(sampler.Get1D());
             RNG rng(hash0, hash1);
 
-            SampledSpectrum T_maj = SampleT_maj(
-                ray, tMax, sampler.Get1D(), rng, lambda,
+            SampledSpectrum T_r;
+            SampledSpectrum T_maj = SampleT_residual(
+                ray, tMax, sampler.Get1D(), rng, lambda, false, &T_r,
                 [&](Point3f p, MediumProperties mp, SampledSpectrum sigma_maj,
-                    SampledSpectrum T_maj) {
+                    SampledSpectrum T_maj, SampledSpectrum sigma_r, SampledSpectrum T_r) {
                     // Handle medium scattering event for ray
                     if (!beta) {
                         terminated = true;
@@ -1062,19 +1190,22 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
                         if (pdf == 0)
                             beta = SampledSpectrum(0.f);
                         r_u *= T_maj * sigma_n / pdf;
-                        r_l *= T_maj * sigma_maj / pdf;
+                        // Light sampling's PDF for the null vertex depends on how
+                        // shadow rays sample transmittance
+                        r_l *= (residualTracking ? T_r * sigma_r : T_maj * sigma_maj) /
+                               pdf;
                         return beta && r_u;
                     }
                 });
             // Handle terminated, scattered, and unscattered medium rays
             if (terminated || !beta || !r_u)
-                return L;
+                break;
             if (scattered)
                 continue;
 
             beta *= T_maj / T_maj[0];
             r_u *= T_maj / T_maj[0];
-            r_l *= T_maj / T_maj[0];
+            r_l *= (residualTracking ? T_r : T_maj) / T_maj[0];
         }
         // Handle surviving unscattered rays
         // Add emitted light at volume path vertex or from the environment
@@ -1144,7 +1275,7 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
 
         // Terminate path if maximum depth reached
         if (depth++ >= maxDepth)
-            return L;
+            break;
 
         ++surfaceInteractions;
         // Possibly regularize the BSDF
@@ -1153,9 +1284,12 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
             bsdf.Regularize();
         }
 
+        // Find the path guiding region for the surface vertex
+        GuidingRegion *region = guide ? guide->Lookup(isect.p()) : nullptr;
+
         // Sample illumination from lights to find attenuated path contribution
         if (IsNonSpecular(bsdf.Flags())) {
-            L += SampleLd(isect, &bsdf, lambda, sampler, beta, r_u);
+            L += SampleLd(isect, &bsdf, lambda, sampler, beta, r_u, region);
             DCHECK(IsInf(L.y(lambda)) == false);
         }
         prevIntrContext = LightSampleContext(isect);
@@ -1163,15 +1297,18 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
         // Sample BSDF to get new volumetric path direction
         Vector3f wo = isect.wo;
         Float u = sampler.Get1D();
-        pstd::optional<BSDFSample> bs = bsdf.Sample_f(wo, u, sampler.Get2D());
+        pstd::optional<BSDFSample> bs =
+            guide ? guide->Sample_f(bsdf, region, wo, u, sampler.Get2D())
+                  : bsdf.Sample_f(wo, u, sampler.Get2D());
         if (!bs)
             break;
         // Update _beta_ and rescaled path probabilities for BSDF scattering
         beta *= bs->f * AbsDot(bs->wi, isect.shading.n) / bs->pdf;
-        if (bs->pdfIsProportional)
-            r_l = r_u / bsdf.PDF(wo, bs->wi);
-        else
-            r_l = r_u / bs->pdf;
+        Float bsdfPDF = bs->pdfIsProportional ? bsdf.PDF(wo, bs->wi) : bs->pdf;
+        r_l = r_u / bsdfPDF;
+        if (region && !bs->IsSpecular())
+            guidingVertices[nGuidingVertices++] =
+                GuidingVertex{region, bs->wi, bsdfPDF, L, beta / r_u.Average()};
 
         PBRT_DBG("%s\n", StringPrintf("Sampled BSDF, f = %s, pdf = %f -> beta = %s",
                                       bs->f, bs->pdf, beta)
@@ -1267,13 +1404,18 @@ SampledSpectrum VolPathIntegrator::Li(RayDifferential ray, SampledWavelengths &l
             beta /= 1 - q;
         }
     }
+    // Train path guide with the incident radiance found at path vertices
+    if (nGuidingVertices > 0)
+        guide->Record(pstd::span<const GuidingVertex>(guidingVertices, nGuidingVertices),
+                      L);
+
     return L;
 }
 
 SampledSpectrum VolPathIntegrator::SampleLd(const Interaction &intr, const BSDF *bsdf,
                                             SampledWavelengths &lambda, Sampler sampler,
-                                            SampledSpectrum beta,
-                                            SampledSpectrum r_p) const {
+                                            SampledSpectrum beta, SampledSpectrum r_p,
+                                            const GuidingRegion *region) const {
     // Estimate light-sampled direct illumination at _intr_
     // Initialize _LightSampleContext_ for volumetric light sampling
     LightSampleContext ctx;
@@ -1311,7 +1453,7 @@ SampledSpectrum VolPathIntegrator::SampleLd(const Interaction &intr, const BSDF
     if (bsdf) {
         // Update _f_hat_ and _scatterPDF_ accounting for the BSDF
         f_hat = bsdf->f(wo, wi) * AbsDot(wi, intr.AsSurface().shading.n);
-        scatterPDF = bsdf->PDF(wo, wi);
+        scatterPDF = guide ? guide->PDF(*bsdf, region, wo, wi) : bsdf->PDF(wo, wi);
 
     } else {
         // Update _f_hat_ and _scatterPDF_ accounting for the phase function
@@ -1339,38 +1481,43 @@ SampledSpectrum VolPathIntegrator::SampleLd(const Interaction &intr, const BSDF
         if (lightRay.medium) {
             Float tMax = si ? si->tHit : (1 - ShadowEpsilon);
             Float u = rng.Uniform<Float>();
-            SampledSpectrum T_maj =
-                SampleT_maj(lightRay, tMax, u, rng, lambda,
-                            [&](Point3f p, MediumProperties mp, SampledSpectrum sigma_maj,
-                                SampledSpectrum T_maj) {
-                                // Update ray transmittance estimate at sampled point
-                                // Update _T_ray_ and PDFs using ratio-tracking estimator
-                                SampledSpectrum sigma_n =
-                                    ClampZero(sigma_maj - mp.sigma_a - mp.sigma_s);
-                                Float pdf = T_maj[0] * sigma_maj[0];
-                                T_ray *= T_maj * sigma_n / pdf;
-                                r_l *= T_maj * sigma_maj / pdf;
-                                r_u *= T_maj * sigma_n / pdf;
-
-                                // Possibly terminate transmittance computation using
-                                // Russian roulette
-                                SampledSpectrum Tr = T_ray / (r_l + r_u).Average();
-                                if (Tr.MaxComponentValue() < 0.05f) {
-                                    Float q = 0.75f;
-                                    if (rng.Uniform<Float>() < q)
-                                        T_ray = SampledSpectrum(0.);
-                                    else
-                                        T_ray /= 1 - q;
-                                }
+            // With residual ratio tracking, points are sampled according to the
+            // difference between the majorant and a lower bound of $\sigmat$
+            SampledSpectrum T_r;
+            SampledSpectrum T_maj = SampleT_residual(
+                lightRay, tMax, u, rng, lambda, residualTracking, &T_r,
+                [&](Point3f p, MediumProperties mp, SampledSpectrum sigma_maj,
+                    SampledSpectrum T_maj, SampledSpectrum sigma_r, SampledSpectrum T_r) {
+                    // Update ray transmittance estimate at sampled point
+                    // Update _T_ray_ and PDFs using ratio-tracking estimator
+                    SampledSpectrum sigma_n =
+                        ClampZero(sigma_maj - mp.sigma_a - mp.sigma_s);
+                    SampledSpectrum sigma_p = residualTracking ? sigma_r : sigma_maj;
+                    SampledSpectrum T_p = residualTracking ? T_r : T_maj;
+                    Float pdf = T_p[0] * sigma_p[0];
+                    T_ray *= T_maj * sigma_n / pdf;
+                    r_l *= T_p * sigma_p / pdf;
+                    r_u *= T_maj * sigma_n / pdf;
+
+                    // Possibly terminate transmittance computation using Russian roulette
+                    SampledSpectrum Tr = T_ray / (r_l + r_u).Average();
+                    if (Tr.MaxComponentValue() < 0.05f) {
+                        Float q = 0.75f;
+                        if (rng.Uniform<Float>() < q)
+                            T_ray = SampledSpectrum(0.);
+                        else
+                            T_ray /= 1 - q;
+                    }
 
-                                if (!T_ray)
-                                    return false;
-                                return true;
-                            });
+                    if (!T_ray)
+                        return false;
+                    return true;
+                });
             // Update transmittance estimate for final segment
-            T_ray *= T_maj / T_maj[0];
-            r_l *= T_maj / T_maj[0];
-            r_u *= T_maj / T_maj[0];
+            SampledSpectrum T_p = residualTracking ? T_r : T_maj;
+            T_ray *= T_maj / T_p[0];
+            r_l *= T_p / T_p[0];
+            r_u *= T_maj / T_p[0];
         }
 
         // Generate next ray segment or return final transmittance
@@ -1391,8 +1538,10 @@ SampledSpectrum VolPathIntegrator::SampleLd(const Interaction &intr, const BSDF
 
 std::string VolPathIntegrator::ToString() const {
     return StringPrintf(
-        "[ VolPathIntegrator maxDepth: %d lightSampler: %s regularize: %s ]", maxDepth,
-        lightSampler, regularize);
+        "[ VolPathIntegrator maxDepth: %d lightSampler: %s regularize: %s guide: %s "
+        "residualTracking: %s ]",
+        maxDepth, lightSampler, regularize,
+        guide ? guide->ToString() : std::string("(nullptr)"), residualTracking);
 }
 
 std::unique_ptr<VolPathIntegrator> VolPathIntegrator::Create(
@@ -1401,8 +1550,11 @@ std::unique_ptr<VolPathIntegrator> VolPathIntegrator::Create(
     int maxDepth = parameters.GetOneInt("maxdepth", 5);
     std::string lightStrategy = parameters.GetOneString("lightsampler", "bvh");
     bool regularize = parameters.GetOneBool("regularize", false);
+    bool guiding = parameters.GetOneBool("guiding", false);
+    bool residualTracking = parameters.GetOneBool("residualtracking", false);
     return std::make_unique<VolPathIntegrator>(maxDepth, camera, sampler, aggregate,
-                                               lights, lightStrategy, regularize);
+                                               lights, lightStrategy, regularize, guiding,
+                                               residualTracking);
 }
 
 // AOIntegrator Method Definitions
@@ -1476,7 +1628,33 @@ std::unique_ptr<AOIntegrator> AOIntegrator::Create(const ParameterDictionary &pa
                                           lights, illuminant);
 }
 
-// BDPT Utility Function Declarations
+// BDPT Utility Declarations
+// BDPTMISSums Definition
+// Partial sums of pdf ratios for the hypothetical strategies that connect at
+// subpath vertices, as stored after subpath generation; they let the MIS
+// weight of a connection be found with work independent of path length.
+struct BDPTMISSums {
+    const Float *camera = nullptr, *light = nullptr;
+    Float splatScale = 1;
+    // Merge radius area times the number of light subpaths merged with; when
+    // nonzero, vertex merging strategies are included in the weights as well
+    Float mergeScale = 0;
+};
+
+// BDPTShadowRay Definition
+struct BDPTShadowRay {
+    Interaction p0, p1;
+};
+
+// BDPTDeferredConnection Definition
+struct BDPTDeferredConnection {
+    BDPTShadowRay shadowRay;
+    // Contribution of the connection, including its MIS weight, if unoccluded
+    SampledSpectrum L;
+    pstd::optional<Point2f> pRaster;
+    bool splat;
+};
+
 int RandomWalk(const Integrator &integrator, SampledWavelengths &lambda,
                RayDifferential ray, Sampler sampler, Camera camera,
                ScratchBuffer &scratchBuffer, SampledSpectrum beta, Float pdf,
@@ -1486,7 +1664,9 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
                             Vertex *lightVertices, Vertex *cameraVertices, int s, int t,
                             LightSampler lightSampler, Camera camera, Sampler sampler,
                             pstd::optional<Point2f> *pRaster,
-                            Float *misWeightPtr = nullptr);
+                            Float *misWeightPtr = nullptr,
+                            const BDPTMISSums *misSums = nullptr,
+                            pstd::optional<BDPTShadowRay> *shadowRay = nullptr);
 
 Float InfiniteLightDensity(const std::vector<Light> &infiniteLights,
                            LightSampler lightSampler, Vector3f w);
@@ -1656,6 +1836,10 @@ struct Vertex {
         LOG_FATAL("Unhandled vertex type in IsConnectible()");
     }
 
+    bool IsMergeable() const {
+        return type == VertexType::Surface && IsNonSpecular(bsdf.Flags());
+    }
+
     bool IsLight() const {
         return type == VertexType::Light || (type == VertexType::Surface && si.areaLight);
     }
@@ -1814,7 +1998,7 @@ struct Vertex {
     }
 
     Float PDFLightOrigin(const std::vector<Light> &infiniteLights, const Vertex &v,
-                         LightSampler lightSampler) {
+                         LightSampler lightSampler) const {
         Vector3f w = v.p() - p();
         if (LengthSquared(w) == 0)
             return 0.;
@@ -2114,8 +2298,7 @@ int RandomWalk(const Integrator &integrator, SampledWavelengths &lambda,
     return bounces;
 }
 
-SampledSpectrum G(const Integrator &integrator, Sampler sampler, const Vertex &v0,
-                  const Vertex &v1, const SampledWavelengths &lambda) {
+Float GeometricTerm(const Vertex &v0, const Vertex &v1) {
     Vector3f d = v0.p() - v1.p();
     Float g = 1 / LengthSquared(d);
     d *= std::sqrt(g);
@@ -2123,7 +2306,13 @@ SampledSpectrum G(const Integrator &integrator, Sampler sampler, const Vertex &v
         g *= AbsDot(v0.ns(), d);
     if (v1.IsOnSurface())
         g *= AbsDot(v1.ns(), d);
-    return g * integrator.Tr(v0.GetInteraction(), v1.GetInteraction(), lambda);
+    return g;
+}
+
+SampledSpectrum G(const Integrator &integrator, Sampler sampler, const Vertex &v0,
+                  const Vertex &v1, const SampledWavelengths &lambda) {
+    return GeometricTerm(v0, v1) *
+           integrator.Tr(v0.GetInteraction(), v1.GetInteraction(), lambda);
 }
 
 Float MISWeight(const Integrator &integrator, Camera camera, Vertex *lightVertices,
@@ -2206,6 +2395,136 @@ Float MISWeight(const Integrator &integrator, Camera camera, Vertex *lightVertic
     return 1 / (1 + sumRi);
 }
 
+static Float Remap0(Float f) {
+    return f != 0 ? f : 1;
+}
+
+BDPTMISSums ComputeMISSums(const Vertex *cameraVertices, int nCamera,
+                           const Vertex *lightVertices, int nLight, Camera camera,
+                           ScratchBuffer &scratchBuffer, Float mergeScale = 0) {
+    BDPTMISSums sums;
+    Film film = camera.GetFilm();
+    sums.splatScale = Float(film.FullResolution().x) * Float(film.FullResolution().y) /
+                      Float(film.PixelBounds().Area());
+    sums.mergeScale = mergeScale;
+    // Define _mergeRatio_ helper for merging strategies at interior vertices
+    auto mergeRatio = [&](const Vertex &v) -> Float {
+        return (mergeScale > 0 && !v.delta && v.IsMergeable())
+                   ? Remap0(v.pdfRev) * mergeScale
+                   : 0;
+    };
+
+    // Accumulate ratios of strategies connecting at camera vertices $1 \ldots k$
+    Float *cameraSums = scratchBuffer.Alloc<Float[]>(std::max(nCamera, 1));
+    cameraSums[0] = 0;
+    for (int k = 1; k < nCamera; ++k) {
+        const Vertex &v = cameraVertices[k];
+        Float r = Remap0(v.pdfRev) / Remap0(v.pdfFwd);
+        // See https://github.com/mmp/pbrt-v4/issues/347
+        if (k == 1)
+            r /= sums.splatScale;
+        Float mask = (!v.delta && !cameraVertices[k - 1].delta) ? 1 : 0;
+        cameraSums[k] = r * (mask + cameraSums[k - 1]) + mergeRatio(v);
+    }
+
+    // Accumulate ratios of strategies connecting at light vertices $0 \ldots k$
+    Float *lightSums = scratchBuffer.Alloc<Float[]>(std::max(nLight, 1));
+    for (int k = 0; k < nLight; ++k) {
+        const Vertex &v = lightVertices[k];
+        Float r = Remap0(v.pdfRev) / Remap0(v.pdfFwd);
+        bool deltaLightVertex =
+            k > 0 ? lightVertices[k - 1].delta : lightVertices[0].IsDeltaLight();
+        Float mask = (!v.delta && !deltaLightVertex) ? 1 : 0;
+        lightSums[k] = r * (mask + (k > 0 ? lightSums[k - 1] : 0)) + mergeRatio(v);
+    }
+
+    sums.camera = cameraSums;
+    sums.light = lightSums;
+    return sums;
+}
+
+// Returns the sum of the ratios of the other strategies' densities to that of the
+// $(s, t)$ connection, before the $t=1$ splat scaling. If _ptDelta_ is set, the
+// scattering at $\pt{}_{t-1}$ is a Dirac delta, as can happen when the
+// connection stands in for a merge at the following camera vertex.
+static Float IncrementalMISRatios(const Integrator &integrator,
+                                  const Vertex *lightVertices,
+                                  const Vertex *cameraVertices, const Vertex &sampled,
+                                  int s, int t, LightSampler lightSampler,
+                                  const BDPTMISSums &sums, bool ptDelta = false,
+                                  Float *qsPdfRevPtr = nullptr) {
+    // Look up connection vertices and their predecessors
+    const Vertex *qs = s > 0 ? (s == 1 ? &sampled : &lightVertices[s - 1]) : nullptr,
+                 *pt = t > 0 ? (t == 1 ? &sampled : &cameraVertices[t - 1]) : nullptr,
+                 *qsMinus = s > 1 ? &lightVertices[s - 2] : nullptr,
+                 *ptMinus = t > 1 ? &cameraVertices[t - 2] : nullptr;
+    // Define _mergeRatio_ helper for merging strategies at the updated vertices
+    auto mergeRatio = [&](const Vertex &v, Float pdfRev, bool delta) -> Float {
+        return (sums.mergeScale > 0 && !delta && v.IsMergeable())
+                   ? Remap0(pdfRev) * sums.mergeScale
+                   : 0;
+    };
+
+    // Add ratios of hypothetical strategies along the camera subpath
+    // Only the reverse densities of $\pt{}_{t-1}$ and $\pt{}_{t-2}$ differ from
+    // those used for the partial sums; the connection vertex is non-degenerate.
+    Float sumRi = 0;
+    if (t > 1) {
+        Float ptPdfRev = s > 0 ? qs->PDF(integrator, qsMinus, *pt)
+                               : pt->PDFLightOrigin(integrator.infiniteLights, *ptMinus,
+                                                    lightSampler);
+        Float r = Remap0(ptPdfRev) / Remap0(pt->pdfFwd);
+        if (t - 1 == 1)
+            r /= sums.splatScale;
+        Float inner = (!ptDelta && !ptMinus->delta) ? 1 : 0;
+        if (t > 2) {
+            Float ptMinusPdfRev = s > 0 ? pt->PDF(integrator, qs, *ptMinus)
+                                        : pt->PDFLight(integrator, *ptMinus);
+            Float rMinus = Remap0(ptMinusPdfRev) / Remap0(ptMinus->pdfFwd);
+            if (t - 2 == 1)
+                rMinus /= sums.splatScale;
+            Float mask = (!ptMinus->delta && !cameraVertices[t - 3].delta) ? 1 : 0;
+            inner += rMinus * (mask + sums.camera[t - 3]) +
+                     mergeRatio(*ptMinus, ptMinusPdfRev, ptMinus->delta);
+        }
+        sumRi += r * inner + mergeRatio(*pt, ptPdfRev, ptDelta);
+    }
+
+    // Add ratios of hypothetical strategies along the light subpath
+    if (s > 0) {
+        Float qsPdfRev = pt->PDF(integrator, ptMinus, *qs);
+        if (qsPdfRevPtr)
+            *qsPdfRevPtr = qsPdfRev;
+        Float r = Remap0(qsPdfRev) / Remap0(qs->pdfFwd);
+        bool deltaLightVertex = s > 1 ? qsMinus->delta : qs->IsDeltaLight();
+        Float inner = deltaLightVertex ? 0 : 1;
+        if (s > 1) {
+            Float qsMinusPdfRev = qs->PDF(integrator, pt, *qsMinus);
+            Float rMinus = Remap0(qsMinusPdfRev) / Remap0(qsMinus->pdfFwd);
+            bool deltaLightVertexMinus =
+                s > 2 ? lightVertices[s - 3].delta : lightVertices[0].IsDeltaLight();
+            Float mask = (!qsMinus->delta && !deltaLightVertexMinus) ? 1 : 0;
+            inner += rMinus * (mask + (s > 2 ? sums.light[s - 3] : 0)) +
+                     mergeRatio(*qsMinus, qsMinusPdfRev, qsMinus->delta);
+        }
+        sumRi += r * inner + mergeRatio(*qs, qsPdfRev, false);
+    }
+    return sumRi;
+}
+
+Float IncrementalMISWeight(const Integrator &integrator, const Vertex *lightVertices,
+                           const Vertex *cameraVertices, const Vertex &sampled, int s,
+                           int t, LightSampler lightSampler, const BDPTMISSums &sums) {
+    if (s + t == 2)
+        return 1;
+    Float sumRi = IncrementalMISRatios(integrator, lightVertices, cameraVertices,
+                                       sampled, s, t, lightSampler, sums);
+    // See https://github.com/mmp/pbrt-v4/issues/347
+    if (t == 1)
+        sumRi /= sums.splatScale;
+    return 1 / (1 + sumRi);
+}
+
 Float InfiniteLightDensity(const std::vector<Light> &infiniteLights,
                            LightSampler lightSampler, Vector3f w) {
     Float pdf = 0;
@@ -2266,6 +2585,16 @@ SampledSpectrum BDPTIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
                                       maxDepth + 1, cameraVertices[0].time(),
                                       lightSampler, lightVertices, regularize);
 
+    // Prepare incremental MIS weights and deferred connection visibility
+    BDPTMISSums misSums;
+    BDPTDeferredConnection *deferred = nullptr;
+    int nDeferred = 0;
+    if (incrementalMIS) {
+        misSums = ComputeMISSums(cameraVertices, nCamera, lightVertices, nLight, camera,
+                                 scratchBuffer);
+        deferred = scratchBuffer.Alloc<BDPTDeferredConnection[]>(nCamera * (nLight + 1));
+    }
+
     SampledSpectrum L(0.f);
     // Execute all BDPT connection strategies
     for (int t = 1; t <= nCamera; ++t) {
@@ -2276,9 +2605,17 @@ SampledSpectrum BDPTIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
             // Execute the $(s, t)$ connection strategy and update _L_
             pstd::optional<Point2f> pFilmNew;
             Float misWeight = 0.f;
-            SampledSpectrum Lpath =
-                ConnectBDPT(*this, lambda, lightVertices, cameraVertices, s, t,
-                            lightSampler, camera, sampler, &pFilmNew, &misWeight);
+            pstd::optional<BDPTShadowRay> shadowRay;
+            SampledSpectrum Lpath = ConnectBDPT(
+                *this, lambda, lightVertices, cameraVertices, s, t, lightSampler, camera,
+                sampler, &pFilmNew, &misWeight, incrementalMIS ? &misSums : nullptr,
+                incrementalMIS ? &shadowRay : nullptr);
+            if (Lpath && shadowRay) {
+                // Record connection to trace its shadow ray with the others
+                deferred[nDeferred++] =
+                    BDPTDeferredConnection{*shadowRay, Lpath, pFilmNew, t == 1};
+                continue;
+            }
             PBRT_DBG("%s\n",
                      StringPrintf("Connect bdpt s: %d, t: %d, Lpath: %s, misWeight: %f\n",
                                   s, t, Lpath, misWeight)
@@ -2318,13 +2655,73 @@ SampledSpectrum BDPTIntegrator::Li(RayDifferential ray, SampledWavelengths &lamb
         }
     }
 
+    // Trace shadow rays of deferred connections and add their contributions
+    for (int i = 0; i < nDeferred; ++i) {
+        const BDPTDeferredConnection &c = deferred[i];
+        SampledSpectrum Lpath = c.L * Tr(c.shadowRay.p0, c.shadowRay.p1, lambda);
+        if (!c.splat)
+            L += Lpath;
+        else if (Lpath) {
+            CHECK(c.pRaster.has_value());
+            camera.GetFilm().AddSplat(*c.pRaster, Lpath, lambda);
+        }
+    }
+
     return L;
 }
 
+Float BDPTIntegrator::IncrementalMISWeightError(RayDifferential ray,
+                                                SampledWavelengths &lambda,
+                                                Sampler sampler,
+                                                ScratchBuffer &scratchBuffer) const {
+    // Trace the camera and light subpaths and compute their MIS sums
+    Vertex *cameraVertices = scratchBuffer.Alloc<Vertex[]>(maxDepth + 2);
+    int nCamera = GenerateCameraSubpath(*this, ray, lambda, sampler, scratchBuffer,
+                                        maxDepth + 2, camera, cameraVertices, regularize);
+    Vertex *lightVertices = scratchBuffer.Alloc<Vertex[]>(maxDepth + 1);
+    int nLight = GenerateLightSubpath(*this, lambda, sampler, camera, scratchBuffer,
+                                      maxDepth + 1, cameraVertices[0].time(),
+                                      lightSampler, lightVertices, regularize);
+    BDPTMISSums misSums = ComputeMISSums(cameraVertices, nCamera, lightVertices, nLight,
+                                         camera, scratchBuffer);
+
+    Float maxError = 0;
+    pstd::pmr::monotonic_buffer_resource resource;
+    for (int t = 1; t <= nCamera; ++t)
+        for (int s = 0; s <= nLight; ++s) {
+            int depth = t + s - 2;
+            if ((s == 1 && t == 1) || depth < 0 || depth > maxDepth)
+                continue;
+            // Compute both MIS weights using the same samples for the connection;
+            // visibility is deferred so that occluded connections are included
+            Sampler connectSampler = sampler.Clone(Allocator(&resource));
+            pstd::optional<Point2f> pRaster;
+            pstd::optional<BDPTShadowRay> shadowRay;
+            Float weight = 0, incrementalWeight = 0;
+            ConnectBDPT(*this, lambda, lightVertices, cameraVertices, s, t, lightSampler,
+                        camera, connectSampler, &pRaster, &weight, nullptr, &shadowRay);
+            ConnectBDPT(*this, lambda, lightVertices, cameraVertices, s, t, lightSampler,
+                        camera, sampler, &pRaster, &incrementalWeight, &misSums,
+                        &shadowRay);
+            maxError = std::max(maxError, std::abs(weight - incrementalWeight));
+        }
+    return maxError;
+}
+
 SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &lambda,
                             Vertex *lightVertices, Vertex *cameraVertices, int s, int t,
                             LightSampler lightSampler, Camera camera, Sampler sampler,
-                            pstd::optional<Point2f> *pRaster, Float *misWeightPtr) {
+                            pstd::optional<Point2f> *pRaster, Float *misWeightPtr,
+                            const BDPTMISSums *misSums,
+                            pstd::optional<BDPTShadowRay> *shadowRay) {
+    // Define _Tr_ helper that defers visibility to the caller if requested
+    auto Tr = [&](const Interaction &p0, const Interaction &p1) {
+        if (!shadowRay)
+            return integrator.Tr(p0, p1, lambda);
+        *shadowRay = BDPTShadowRay{p0, p1};
+        return SampledSpectrum(1.f);
+    };
+
     SampledSpectrum L(0.f);
     // Ignore invalid connections related to infinite area lights
     if (t > 1 && s != 0 && cameraVertices[t - 1].type == VertexType::Light)
@@ -2354,7 +2751,7 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
                     L *= AbsDot(cs->wi, qs.ns());
                 DCHECK(!L.HasNaNs());
                 if (L) {
-                    L *= integrator.Tr(cs->pRef, cs->pLens, lambda);
+                    L *= Tr(cs->pRef, cs->pLens);
 
                     // See https://github.com/mmp/pbrt-v4/issues/347
                     Film film = camera.GetFilm();
@@ -2401,8 +2798,7 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
                         L *= AbsDot(lightWeight->wi, pt.ns());
                     // Only check visibility if the path would carry radiance.
                     if (L)
-                        L *= integrator.Tr(pt.GetInteraction(), lightWeight->pLight,
-                                           lambda);
+                        L *= Tr(pt.GetInteraction(), lightWeight->pLight);
                 }
             }
         }
@@ -2423,7 +2819,7 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
                          DistanceSquared(qs.p(), pt.p()))
                          .c_str());
             if (L)
-                L *= G(integrator, sampler, qs, pt, lambda);
+                L *= GeometricTerm(qs, pt) * Tr(qs.GetInteraction(), pt.GetInteraction());
         }
     }
 
@@ -2432,9 +2828,13 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
         ++zeroRadiancePaths;
     pathLength << s + t - 2;
     // Compute MIS weight for connection strategy
-    Float misWeight = L ? MISWeight(integrator, camera, lightVertices, cameraVertices, sampled, s,
-                                    t, lightSampler)
-                        : 0.f;
+    Float misWeight = 0.f;
+    if (L && misSums)
+        misWeight = IncrementalMISWeight(integrator, lightVertices, cameraVertices,
+                                         sampled, s, t, lightSampler, *misSums);
+    else if (L)
+        misWeight = MISWeight(integrator, camera, lightVertices, cameraVertices, sampled,
+                              s, t, lightSampler);
     PBRT_DBG("MIS weight for (s,t) = (%d, %d) connection: %f\n", s, t, misWeight);
     DCHECK(!IsNaN(misWeight));
     L *= misWeight;
@@ -2446,9 +2846,10 @@ SampledSpectrum ConnectBDPT(const Integrator &integrator, SampledWavelengths &la
 
 std::string BDPTIntegrator::ToString() const {
     return StringPrintf("[ BDPTIntegrator maxDepth: %d visualizeStrategies: %s "
-                        "visualizeWeights: %s regularize: %s lightSampler: %s ]",
+                        "visualizeWeights: %s regularize: %s incrementalMIS: %s "
+                        "lightSampler: %s ]",
                         maxDepth, visualizeStrategies, visualizeWeights, regularize,
-                        lightSampler);
+                        incrementalMIS, lightSampler);
 }
 
 std::unique_ptr<BDPTIntegrator> BDPTIntegrator::Create(
@@ -2468,12 +2869,56 @@ std::unique_ptr<BDPTIntegrator> BDPTIntegrator::Create(
     }
 
     bool regularize = parameters.GetOneBool("regularize", false);
+    bool incrementalMIS = parameters.GetOneBool("incrementalmis", false);
+    if (incrementalMIS && (visualizeStrategies || visualizeWeights)) {
+        Warning(loc, "\"incrementalmis\" is not supported with visualizestrategies/"
+                     "visualizeweights; disabling it.");
+        incrementalMIS = false;
+    }
     return std::make_unique<BDPTIntegrator>(camera, sampler, aggregate, lights, maxDepth,
                                             visualizeStrategies, visualizeWeights,
-                                            regularize);
+                                            regularize, incrementalMIS);
 }
 
 STAT_PERCENT("Integrator/Acceptance rate", acceptedMutations, totalMutations);
+STAT_RATIO("Integrator/MLT splats per mutation", mltSplats, mltSplatMutations);
+
+// MLTSplat Definition
+struct MLTSplat {
+    Point2f pRaster;
+    SampledSpectrum L;
+    SampledWavelengths lambda;
+};
+
+// MLTChain Definition
+struct MLTChain {
+    // MLTChain Public Methods
+    MLTChain(const MLTSampler &sampler, RNG rng, int depth, int64_t nMutations)
+        : sampler(sampler), rng(rng), depth(depth), nMutations(nMutations) {}
+
+    // MLTChain Public Members
+    MLTSampler sampler;
+    RNG rng;
+    int depth;
+    int64_t nMutations;
+    Point2f pCurrent;
+    SampledWavelengths lambdaCurrent;
+    SampledSpectrum LCurrent;
+    // Sum of the current state's splat weights that haven't been splatted yet
+    Float currentWeight = 0;
+};
+
+// MLT Utility Functions
+static void FlushSplats(Film film, std::vector<MLTSplat> &splats) {
+    // Sort splats in scanline order so that nearby pixels are updated together
+    std::sort(splats.begin(), splats.end(), [](const MLTSplat &a, const MLTSplat &b) {
+        Point2i pa(a.pRaster), pb(b.pRaster);
+        return pa.y < pb.y || (pa.y == pb.y && pa.x < pb.x);
+    });
+    for (const MLTSplat &splat : splats)
+        film.AddSplat(splat.pRaster, splat.L, splat.lambda);
+    splats.clear();
+}
 
 // MLTIntegrator Method Definitions
 SampledSpectrum MLTIntegrator::L(ScratchBuffer &scratchBuffer, MLTSampler &sampler,
@@ -2616,7 +3061,7 @@ void MLTIntegrator::Render() {
               std::accumulate(bootstrapWeights.begin(), bootstrapWeights.end(), 0.);
 
     // Set up connection to display server, if enabled
-    std::atomic<int> finishedChains(0);
+    std::atomic<int> finishedRounds(0);
     if (!Options->displayServer.empty()) {
         DisplayDynamic(
             camera.GetFilm().GetFilename(),
@@ -2627,8 +3072,7 @@ void MLTIntegrator::Render() {
                 int index = 0;
                 for (Point2i p : bounds) {
                     Float finishedPixelMutations =
-                        Float(finishedChains.load(std::memory_order_relaxed)) /
-                        Float(nChains) * mutationsPerPixel;
+                        finishedRounds.load(std::memory_order_relaxed);
                     Float scale = b / std::max<Float>(1, finishedPixelMutations);
                     RGB rgb = film.GetPixelRGB(pixelBounds.pMin + p, scale);
                     for (int c = 0; c < 3; ++c)
@@ -2638,15 +3082,14 @@ void MLTIntegrator::Render() {
             });
     }
 
-    // Follow _nChains_ Markov chains to render image
+    // Initialize _nChains_ Markov chains from the bootstrap samples
     Film film = camera.GetFilm();
     int64_t nTotalMutations =
         (int64_t)film.SampleBounds().Area() * (int64_t)mutationsPerPixel;
-    ProgressReporter progressRender(nChains, "Rendering", Options->quiet);
-    // Run _nChains_ Markov chains in parallel
-    ParallelFor(0, nChains, [&](int i) {
-        ScratchBuffer &scratchBuffer = threadScratchBuffers.Get();
-        // Compute number of mutations to apply in current Markov chain
+    std::vector<MLTChain> chains;
+    chains.reserve(nChains);
+    for (int i = 0; i < nChains; ++i) {
+        // Compute number of mutations to apply in _i_th Markov chain
         int64_t nChainMutations =
             std::min((i + 1) * nTotalMutations / nChains, nTotalMutations) -
             i * nTotalMutations / nChains;
@@ -2654,58 +3097,117 @@ void MLTIntegrator::Render() {
         // Select initial state from the set of bootstrap samples
         RNG rng(i);
         int bootstrapIndex = bootstrapTable.Sample(rng.Uniform<Float>());
-        int depth = bootstrapIndex % (maxDepth + 1);
-        threadDepth = depth;
-
-        // Initialize local variables for selected state
         MLTSampler sampler(mutationsPerPixel, bootstrapIndex, sigma, largeStepProbability,
                            nSampleStreams);
-        threadSampler = &sampler;
-        Point2f pCurrent;
-        SampledWavelengths lambdaCurrent;
-        SampledSpectrum LCurrent =
-            L(scratchBuffer, sampler, depth, &pCurrent, &lambdaCurrent);
-
-        // Run the Markov chain for _nChainMutations_ steps
-        for (int64_t j = 0; j < nChainMutations; ++j) {
-            StatsReportPixelStart(Point2i(pCurrent));
-            sampler.StartIteration();
-            // Generate proposed sample and compute its radiance
-            Point2f pProposed;
-            SampledWavelengths lambdaProposed;
-            SampledSpectrum LProposed =
-                L(scratchBuffer, sampler, depth, &pProposed, &lambdaProposed);
-
-            // Compute acceptance probability for proposed sample
-            Float cProposed = c(LProposed, lambdaProposed);
-            Float cCurrent = c(LCurrent, lambdaCurrent);
-            Float accept = std::min<Float>(1, cProposed / cCurrent);
-
-            // Splat both current and proposed samples to _film_
-            if (accept > 0)
-                film.AddSplat(pProposed, LProposed * accept / cProposed, lambdaProposed);
-            film.AddSplat(pCurrent, LCurrent * (1 - accept) / cCurrent, lambdaCurrent);
-
-            // Accept or reject the proposal
-            if (rng.Uniform<Float>() < accept) {
-                StatsReportPixelEnd(Point2i(pCurrent));
-                StatsReportPixelStart(Point2i(pProposed));
-                pCurrent = pProposed;
-                LCurrent = LProposed;
-                lambdaCurrent = lambdaProposed;
-                sampler.Accept();
-                ++acceptedMutations;
-            } else
-                sampler.Reject();
+        chains.push_back(
+            MLTChain(sampler, rng, bootstrapIndex % (maxDepth + 1), nChainMutations));
+    }
+    // Regenerate the chains' initial states
+    // A bootstrap sample's state is determined by its _MLTSampler_'s seed, so
+    // rerunning the sampler reproduces the bootstrap path exactly. Keeping the
+    // states of all bootstrap samples instead, since which ones seed chains
+    // isn't known until all weights are in, would take far more memory than
+    // the _nChains_ path evaluations this costs.
+    ParallelFor(0, nChains, [&](int i) {
+        // Compute radiance of _i_th Markov chain's initial state
+        ScratchBuffer &scratchBuffer = threadScratchBuffers.Get();
+        MLTChain &chain = chains[i];
+        threadSampler = &chain.sampler;
+        threadDepth = chain.depth;
+        chain.LCurrent = L(scratchBuffer, chain.sampler, chain.depth, &chain.pCurrent,
+                           &chain.lambdaCurrent);
+        scratchBuffer.Reset();
+    });
 
-            ++totalMutations;
-            scratchBuffer.Reset();
-            StatsReportPixelEnd(Point2i(pCurrent));
-        }
+    // Run Markov chains in rounds of one mutation per pixel on average
+    // Splats are buffered per thread and merged into the film when a buffer
+    // fills up and at the end of each round.
+    constexpr size_t maxBufferedSplats = 16384;
+    ThreadLocal<std::vector<MLTSplat>> threadSplats;
+    ProgressReporter progressRender(mutationsPerPixel, "Rendering", Options->quiet);
+    for (int round = 0; round < mutationsPerPixel; ++round) {
+        ParallelFor(0, nChains, [&](int i) {
+            ScratchBuffer &scratchBuffer = threadScratchBuffers.Get();
+            std::vector<MLTSplat> &splats = threadSplats.Get();
+            MLTChain &chain = chains[i];
+            MLTSampler &sampler = chain.sampler;
+            threadSampler = &sampler;
+            threadDepth = chain.depth;
+
+            // Splat the current state's accumulated weight and reset it
+            auto SplatCurrent = [&]() {
+                if (chain.currentWeight > 0) {
+                    Float cCurrent = c(chain.LCurrent, chain.lambdaCurrent);
+                    splats.push_back(MLTSplat{chain.pCurrent,
+                                              chain.LCurrent * chain.currentWeight /
+                                                  cCurrent,
+                                              chain.lambdaCurrent});
+                    ++mltSplats;
+                }
+                chain.currentWeight = 0;
+            };
+
+            // Run the Markov chain for this round's mutations
+            int64_t roundStart = round * chain.nMutations / mutationsPerPixel;
+            int64_t roundEnd = (round + 1) * chain.nMutations / mutationsPerPixel;
+            for (int64_t j = roundStart; j < roundEnd; ++j) {
+                StatsReportPixelStart(Point2i(chain.pCurrent));
+                sampler.StartIteration();
+                // Generate proposed sample and compute its radiance
+                Point2f pProposed;
+                SampledWavelengths lambdaProposed;
+                SampledSpectrum LProposed =
+                    L(scratchBuffer, sampler, chain.depth, &pProposed, &lambdaProposed);
+
+                // Compute acceptance probability for proposed sample
+                Float cProposed = c(LProposed, lambdaProposed);
+                Float cCurrent = c(chain.LCurrent, chain.lambdaCurrent);
+                Float accept = std::min<Float>(1, cProposed / cCurrent);
+
+                // Splat proposed sample and accumulate current sample's weight
+                // The current sample is only splatted when the chain leaves it,
+                // which saves many splats when proposals are often rejected.
+                if (accept > 0) {
+                    splats.push_back(MLTSplat{pProposed, LProposed * accept / cProposed,
+                                              lambdaProposed});
+                    ++mltSplats;
+                }
+                chain.currentWeight += 1 - accept;
+
+                // Accept or reject the proposal
+                if (chain.rng.Uniform<Float>() < accept) {
+                    StatsReportPixelEnd(Point2i(chain.pCurrent));
+                    StatsReportPixelStart(Point2i(pProposed));
+                    SplatCurrent();
+                    chain.pCurrent = pProposed;
+                    chain.LCurrent = LProposed;
+                    chain.lambdaCurrent = lambdaProposed;
+                    sampler.Accept();
+                    ++acceptedMutations;
+                } else
+                    sampler.Reject();
+
+                ++totalMutations;
+                ++mltSplatMutations;
+                scratchBuffer.Reset();
+                StatsReportPixelEnd(Point2i(chain.pCurrent));
+            }
+            SplatCurrent();
 
-        ++finishedChains;
+            if (splats.size() >= maxBufferedSplats)
+                FlushSplats(film, splats);
+        });
+
+        // Merge all threads' remaining splats into the film
+        std::vector<std::vector<MLTSplat> *> splatBuffers;
+        threadSplats.ForAll(
+            [&](std::vector<MLTSplat> &splats) { splatBuffers.push_back(&splats); });
+        ParallelFor(0, splatBuffers.size(),
+                    [&](int64_t i) { FlushSplats(film, *splatBuffers[i]); });
+
+        ++finishedRounds;
         progressRender.Update(1);
-    });
+    }
 
     progressRender.Done();
 
@@ -2756,7 +3258,10 @@ STAT_COUNTER("Stochastic Progressive Photon Mapping/Photon paths followed", phot
 STAT_INT_DISTRIBUTION(
     "Stochastic Progressive Photon Mapping/Grid cells per visible point",
     gridCellsPerVisiblePoint);
+STAT_RATIO("Stochastic Progressive Photon Mapping/Photons checked per visible point",
+           photonsChecked, visiblePointsGathered);
 STAT_MEMORY_COUNTER("Memory/SPPM Pixels", pixelMemoryBytes);
+STAT_MEMORY_COUNTER("Memory/SPPM Photon Map", photonMapBytes);
 STAT_MEMORY_COUNTER("Memory/SPPM BSDF and Grid Memory", sppmMemoryArenaBytes);
 
 // SPPMPixel Definition
@@ -2789,10 +3294,144 @@ struct SPPMPixel {
     Float n = 0;
 };
 
-// SPPMPixelListNode Definition
-struct SPPMPixelListNode {
+// SPPMGridEntry Definition
+struct SPPMGridEntry {
+    // Copies of the visible point's position and squared radius, so that
+    // photons can be tested against it without touching its _SPPMPixel_
+    Point3f p;
+    Float radius2;
     SPPMPixel *pixel;
-    SPPMPixelListNode *next;
+};
+
+// HashedPointGrid Definition
+// Stores points of type _T_, which must have _p_ and _cell_ members, sorted by
+// the hash bucket of the grid cell that each one lies in.
+template <typename T>
+class HashedPointGrid {
+  public:
+    // HashedPointGrid Public Methods
+    HashedPointGrid(ThreadLocal<std::vector<T>> &threadPoints, Float cellSize)
+        : cellSize(cellSize) {
+        // Find the points recorded by all threads
+        std::vector<std::vector<T> *> pointLists;
+        size_t nPoints = 0;
+        threadPoints.ForAll([&](std::vector<T> &v) {
+            pointLists.push_back(&v);
+            nPoints += v.size();
+        });
+
+        // Count points in each hashed cell and compute cells' ranges in _points_
+        hashSize = NextPrime(int(Clamp(nPoints, 1, 1 << 30)));
+        std::vector<std::atomic<int64_t>> cellCounts(hashSize);
+        for (std::vector<T> *list : pointLists)
+            ParallelFor(0, list->size(), [&](int64_t i) {
+                T &pt = (*list)[i];
+                pt.cell = Bucket(Cell(pt.p));
+                cellCounts[pt.cell].fetch_add(1, std::memory_order_relaxed);
+            });
+        cellStart.resize(hashSize + 1);
+        cellStart[0] = 0;
+        for (int h = 0; h < hashSize; ++h) {
+            cellStart[h + 1] = cellStart[h] + cellCounts[h];
+            cellCounts[h].store(cellStart[h], std::memory_order_relaxed);
+        }
+
+        // Scatter points from the per-thread lists into their cells' ranges
+        points.resize(nPoints);
+        for (std::vector<T> *list : pointLists)
+            ParallelFor(0, list->size(), [&](int64_t i) {
+                const T &pt = (*list)[i];
+                points[cellCounts[pt.cell].fetch_add(1, std::memory_order_relaxed)] =
+                    pt;
+            });
+    }
+
+    // Calls _func_ for each point in the cells that a sphere of _radius_
+    // around _p_ may overlap; _radius_ must be at most half the cell size.
+    template <typename F>
+    void ForEachCandidate(Point3f p, Float radius, F func) const {
+        DCHECK_LE(radius, cellSize / 2);
+        // Find the distinct buckets of _p_'s cell and its neighbors toward _p_
+        // Along each axis, the sphere can only reach the neighboring cell on
+        // _p_'s side of its cell's center. Choosing cells this way rather than
+        // from the cells of $p \pm r$ keeps rounding error from adding a third
+        // cell along an axis when _radius_ is exactly half the cell size.
+        Point3i c = Cell(p), n;
+        for (int i = 0; i < 3; ++i)
+            n[i] = (p[i] / cellSize - c[i] < 0.5f) ? c[i] - 1 : c[i] + 1;
+        int buckets[8], nBuckets = 0;
+        for (int j = 0; j < 8; ++j) {
+            int h = Bucket(Point3i((j & 1) ? n.x : c.x, (j & 2) ? n.y : c.y,
+                                   (j & 4) ? n.z : c.z));
+            if (std::find(buckets, buckets + nBuckets, h) == buckets + nBuckets)
+                buckets[nBuckets++] = h;
+        }
+
+        for (int b = 0; b < nBuckets; ++b)
+            for (int64_t i = cellStart[buckets[b]]; i < cellStart[buckets[b] + 1]; ++i)
+                func(points[i]);
+    }
+
+    int64_t BytesUsed() const {
+        return points.size() * sizeof(T) + cellStart.size() * sizeof(int64_t);
+    }
+
+  private:
+    // HashedPointGrid Private Methods
+    Point3i Cell(Point3f p) const {
+        // Clamp cell coordinates so that distant points don't overflow
+        Point3i c;
+        for (int i = 0; i < 3; ++i)
+            c[i] = int(Clamp(std::floor(p[i] / cellSize), -(1 << 30), 1 << 30));
+        return c;
+    }
+    int Bucket(Point3i c) const { return Hash(c) % hashSize; }
+
+    // HashedPointGrid Private Members
+    Float cellSize;
+    int hashSize;
+    std::vector<int64_t> cellStart;
+    std::vector<T> points;
+};
+
+// SPPMPhoton Definition
+struct SPPMPhoton {
+    Point3f p;
+    Vector3f wi;
+    SampledSpectrum beta;
+    int cell;
+    bool secondaryLambdaTerminated;
+};
+
+// SPPMPhotonMap Definition
+class SPPMPhotonMap {
+  public:
+    // SPPMPhotonMap Public Methods
+    SPPMPhotonMap(ThreadLocal<std::vector<SPPMPhoton>> &threadPhotons, Float cellSize,
+                  const SampledWavelengths &lambda, int64_t nPaths)
+        : grid(threadPhotons, cellSize), lambda(lambda), nPaths(nPaths) {
+        photonMapBytes = std::max<int64_t>(photonMapBytes, grid.BytesUsed());
+    }
+
+    // Calls _func_ for each photon within _radius_ of _p_; _radius_ must be
+    // at most half of the map's cell size.
+    template <typename F>
+    void ForEachPhoton(Point3f p, Float radius, F func) const {
+        grid.ForEachCandidate(p, radius, [&](const SPPMPhoton &photon) {
+            ++photonsChecked;
+            if (DistanceSquared(photon.p, p) <= Sqr(radius))
+                func(photon);
+        });
+    }
+
+    const SampledWavelengths &Lambda() const { return lambda; }
+    int64_t PathCount() const { return nPaths; }
+
+  private:
+    // SPPMPhotonMap Private Members
+    HashedPointGrid<SPPMPhoton> grid;
+    SampledWavelengths lambda;
+    int64_t nPaths;
 };
 
 // SPPM Utility Functions
@@ -2842,6 +3481,11 @@ void SPPMIntegrator::Render() {
     pstd::vector<DigitPermutation> *digitPermutations(
         ComputeRadicalInversePermutations(digitPermutationsSeed));
 
+    // Declare variables for photon shooting and the photon gathering mode
+    int64_t nPhotons = photonsPerIteration;
+    uint64_t nPhotonsTraced = 0, nPhotonPaths = 0;
+    std::unique_ptr<SPPMPhotonMap> photonMap;
+
     for (int iter = 0; iter < nIterations; ++iter) {
         // Connect to display server for SPPM if requested
         if (iter == 0 && !Options->displayServer.empty()) {
@@ -2849,7 +3493,7 @@ void SPPMIntegrator::Render() {
                 film.GetFilename(), Point2i(pixelBounds.Diagonal()), {"R", "G", "B"},
                 [&](Bounds2i b, pstd::span<pstd::span<float>> displayValue) {
                     int index = 0;
-                    uint64_t np = (uint64_t)(iter + 1) * (uint64_t)photonsPerIteration;
+                    uint64_t np = nPhotonPaths;
                     for (Point2i pPixel : b) {
                         const SPPMPixel &pixel = pixels[pPixel];
                         RGB rgb = pixel.Ld / (iter + 1) +
@@ -2863,8 +3507,11 @@ void SPPMIntegrator::Render() {
 
         // Generate SPPM visible points
         // Sample wavelengths for SPPM pass
-        Float uLambda =
-            Options->disableWavelengthJitter ? Float(0.5) : RadicalInverse(1, iter);
+        // Passes that reuse a photon map must use the wavelengths it was traced with
+        bool tracePhotons = !photonGather || iter % photonReuse == 0;
+        int lambdaIndex = photonGather ? iter / photonReuse : iter;
+        Float uLambda = Options->disableWavelengthJitter ? Float(0.5)
+                                                         : RadicalInverse(1, lambdaIndex);
         const SampledWavelengths passLambda = film.SampleWavelengths(uLambda);
 
         Float timeSample = RadicalInverse(2, iter);
@@ -2995,10 +3642,6 @@ void SPPMIntegrator::Render() {
         });
         progress.Update();
         // Create grid of all SPPM visible points
-        // Allocate grid for SPPM visible points
-        int hashSize = NextPrime(nPixels);
-        std::vector<std::atomic<SPPMPixelListNode *>> grid(hashSize);
-
         // Compute grid bounds for SPPM visible points
         Bounds3f gridBounds;
         Float maxRadius = 0;
@@ -3018,56 +3661,85 @@ void SPPMIntegrator::Render() {
         for (int i = 0; i < 3; ++i)
             gridRes[i] = std::max<int>(baseGridRes * diag[i] / maxDiag, 1);
 
-        // Add visible points to SPPM grid
-        ParallelFor2D(pixelBounds, [&](Bounds2i tileBounds) {
-            ScratchBuffer &scratchBuffer = threadScratchBuffers.Get();
-            for (Point2i pPixel : tileBounds) {
-                SPPMPixel &pixel = pixels[pPixel];
-                if (pixel.vp.beta) {
-                    // Add pixel's visible point to applicable grid cells
-                    // Find grid cell bounds for pixel's visible point, _pMin_ and _pMax_
-                    Float r = pixel.radius;
-                    Point3i pMin, pMax;
-                    ToGrid(pixel.vp.p - Vector3f(r, r, r), gridBounds, gridRes, &pMin);
-                    ToGrid(pixel.vp.p + Vector3f(r, r, r), gridBounds, gridRes, &pMax);
-
-                    for (int z = pMin.z; z <= pMax.z; ++z)
-                        for (int y = pMin.y; y <= pMax.y; ++y)
-                            for (int x = pMin.x; x <= pMax.x; ++x) {
-                                // Add visible point to grid cell $(x, y, z)$
-                                int h = Hash(Point3i(x, y, z)) % hashSize;
-                                CHECK_GE(h, 0);
-                                SPPMPixelListNode *node =
-                                    scratchBuffer.Alloc<SPPMPixelListNode>();
-                                node->pixel = &pixel;
-
-                                // Atomically add _node_ to the start of _grid[h]_'s
-                                // linked list
-                                node->next = grid[h];
-                                while (!grid[h].compare_exchange_weak(node->next, node))
-                                    ;
-                            }
-                    gridCellsPerVisiblePoint << (1 + pMax.x - pMin.x) *
-                                                    (1 + pMax.y - pMin.y) *
-                                                    (1 + pMax.z - pMin.z);
-                }
+        // Find grid cell bounds for pixel's visible point, _pMin_ and _pMax_
+        int hashSize = NextPrime(nPixels);
+        auto visiblePointCells = [&](const SPPMPixel &pixel, Point3i *pMin,
+                                     Point3i *pMax) {
+            Float r = pixel.radius;
+            ToGrid(pixel.vp.p - Vector3f(r, r, r), gridBounds, gridRes, pMin);
+            ToGrid(pixel.vp.p + Vector3f(r, r, r), gridBounds, gridRes, pMax);
+        };
+
+        std::vector<int> cellStart;
+        std::vector<SPPMGridEntry> gridEntries;
+        if (!photonGather) {
+            // Count visible points overlapping each hashed SPPM grid cell
+            std::vector<std::atomic<int>> cellCounts(hashSize);
+            ParallelFor2D(pixelBounds, [&](Point2i pPixel) {
+                const SPPMPixel &pixel = pixels[pPixel];
+                if (!pixel.vp.beta)
+                    return;
+                Point3i pMin, pMax;
+                visiblePointCells(pixel, &pMin, &pMax);
+                for (int z = pMin.z; z <= pMax.z; ++z)
+                    for (int y = pMin.y; y <= pMax.y; ++y)
+                        for (int x = pMin.x; x <= pMax.x; ++x) {
+                            int h = Hash(Point3i(x, y, z)) % hashSize;
+                            CHECK_GE(h, 0);
+                            cellCounts[h].fetch_add(1, std::memory_order_relaxed);
+                        }
+                gridCellsPerVisiblePoint << (1 + pMax.x - pMin.x) *
+                                                (1 + pMax.y - pMin.y) *
+                                                (1 + pMax.z - pMin.z);
+            });
+
+            // Compute offsets of cells' ranges in _gridEntries_ with a prefix sum
+            cellStart.resize(hashSize + 1);
+            cellStart[0] = 0;
+            for (int h = 0; h < hashSize; ++h) {
+                cellStart[h + 1] = cellStart[h] + cellCounts[h];
+                cellCounts[h].store(cellStart[h], std::memory_order_relaxed);
             }
-        });
+
+            // Scatter visible points into their cells' ranges of _gridEntries_
+            gridEntries.resize(cellStart[hashSize]);
+            ParallelFor2D(pixelBounds, [&](Point2i pPixel) {
+                SPPMPixel &pixel = pixels[pPixel];
+                if (!pixel.vp.beta)
+                    return;
+                Point3i pMin, pMax;
+                visiblePointCells(pixel, &pMin, &pMax);
+                for (int z = pMin.z; z <= pMax.z; ++z)
+                    for (int y = pMin.y; y <= pMax.y; ++y)
+                        for (int x = pMin.x; x <= pMax.x; ++x) {
+                            int h = Hash(Point3i(x, y, z)) % hashSize;
+                            int index =
+                                cellCounts[h].fetch_add(1, std::memory_order_relaxed);
+                            gridEntries[index] =
+                                SPPMGridEntry{pixel.vp.p, Sqr(pixel.radius), &pixel};
+                        }
+            });
+        }
 
         // Trace photons and accumulate contributions
         // Create per-thread scratch buffers for photon shooting
         ThreadLocal<ScratchBuffer> photonShootScratchBuffers(
             []() { return ScratchBuffer(); });
+        ThreadLocal<std::vector<SPPMPhoton>> threadPhotons;
 
-        ParallelFor(0, photonsPerIteration, [&](int64_t start, int64_t end) {
+        // Passes that reuse the current photon map shoot no new photons
+        int64_t nPhotonsShot = tracePhotons ? nPhotons : 0;
+        ParallelFor(0, nPhotonsShot, [&](int64_t start, int64_t end) {
             // Follow photon paths for photon index range _start_ - _end_
             ScratchBuffer &scratchBuffer = photonShootScratchBuffers.Get();
             Sampler sampler = threadSamplers.Get();
+            std::vector<SPPMPhoton> &photons = threadPhotons.Get();
+            if (!photonGather)
+                photons.clear();
             for (int64_t photonIndex = start; photonIndex < end; ++photonIndex) {
                 // Follow photon path for _photonIndex_
                 // Define sampling lambda functions for photon shooting
-                uint64_t haltonIndex =
-                    (uint64_t)iter * (uint64_t)photonsPerIteration + photonIndex;
+                uint64_t haltonIndex = nPhotonsTraced + photonIndex;
                 int haltonDim = 0;
                 auto Sample1D = [&]() {
                     Float u = ScrambledRadicalInverse(haltonDim, haltonIndex,
@@ -3122,35 +3794,19 @@ void SPPMIntegrator::Render() {
 
                     ++totalPhotonSurfaceInteractions;
                     if (depth > 0) {
-                        // Add photon contribution to nearby visible points
+                        // Record photon for the photon map or, if its grid cell holds
+                        // any visible points, for splatting
+                        SPPMPhoton photon{isect.p(), -photonRay.d, beta, -1,
+                                          lambda.SecondaryTerminated()};
                         Point3i photonGridIndex;
-                        if (ToGrid(isect.p(), gridBounds, gridRes, &photonGridIndex)) {
-                            int h = Hash(photonGridIndex) % hashSize;
-                            CHECK_GE(h, 0);
-                            // Add photon contribution to visible points in _grid[h]_
-                            for (SPPMPixelListNode *node =
-                                     grid[h].load(std::memory_order_relaxed);
-                                 node; node = node->next) {
-                                ++visiblePointsChecked;
-                                SPPMPixel &pixel = *node->pixel;
-                                if (DistanceSquared(pixel.vp.p, isect.p()) >
-                                    Sqr(pixel.radius))
-                                    continue;
-                                // Update _pixel_ $\Phi$ and $m$ for nearby photon
-                                Vector3f wi = -photonRay.d;
-                                SampledSpectrum Phi =
-                                    beta * pixel.vp.bsdf.f(pixel.vp.wo, wi);
-                                // Update _Phi_i_ for photon contribution
-                                SampledWavelengths photonLambda = lambda;
-                                if (pixel.vp.secondaryLambdaTerminated)
-                                    photonLambda.TerminateSecondary();
-                                RGB Phi_i =
-                                    film.ToOutputRGB(pixel.vp.beta * Phi, photonLambda);
-                                for (int i = 0; i < 3; ++i)
-                                    pixel.Phi_i[i].Add(Phi_i[i]);
-
-                                ++pixel.m;
-                            }
+                        if (photonGather)
+                            photons.push_back(photon);
+                        else if (ToGrid(isect.p(), gridBounds, gridRes,
+                                        &photonGridIndex)) {
+                            photon.cell = Hash(photonGridIndex) % hashSize;
+                            CHECK_GE(photon.cell, 0);
+                            if (cellStart[photon.cell] < cellStart[photon.cell + 1])
+                                photons.push_back(photon);
                         }
                     }
                     // Sample new photon ray direction
@@ -3184,21 +3840,104 @@ void SPPMIntegrator::Render() {
 
                 scratchBuffer.Reset();
             }
+            if (photonGather)
+                return;
+
+            // Add contributions of recorded photons to nearby visible points
+            // Sort photons by grid cell so that each cell's visible points are
+            // fetched once for all of the photons that land in it
+            std::sort(photons.begin(), photons.end(),
+                      [](const SPPMPhoton &a, const SPPMPhoton &b) {
+                          return a.cell < b.cell;
+                      });
+            for (const SPPMPhoton &photon : photons) {
+                for (int i = cellStart[photon.cell]; i < cellStart[photon.cell + 1];
+                     ++i) {
+                    ++visiblePointsChecked;
+                    const SPPMGridEntry &entry = gridEntries[i];
+                    if (DistanceSquared(entry.p, photon.p) > entry.radius2)
+                        continue;
+                    // Update _pixel_ $\Phi$ and $m$ for nearby photon
+                    SPPMPixel &pixel = *entry.pixel;
+                    SampledSpectrum Phi =
+                        photon.beta * pixel.vp.bsdf.f(pixel.vp.wo, photon.wi);
+                    // Update _Phi_i_ for photon contribution
+                    SampledWavelengths photonLambda = passLambda;
+                    if (photon.secondaryLambdaTerminated ||
+                        pixel.vp.secondaryLambdaTerminated)
+                        photonLambda.TerminateSecondary();
+                    RGB Phi_i = film.ToOutputRGB(pixel.vp.beta * Phi, photonLambda);
+                    for (int c = 0; c < 3; ++c)
+                        pixel.Phi_i[c].Add(Phi_i[c]);
+
+                    ++pixel.m;
+                }
+            }
         });
+        if (photonGather) {
+            // Build photon map, if needed, and gather photons at visible points
+            if (tracePhotons) {
+                // Size cells for the largest radius of any pixel, since pixels
+                // without a visible point now may have one in a reusing pass
+                Float maxPixelRadius = 0;
+                for (const SPPMPixel &pixel : pixels)
+                    maxPixelRadius = std::max(maxPixelRadius, pixel.radius);
+                photonMap = std::make_unique<SPPMPhotonMap>(
+                    threadPhotons, 2 * maxPixelRadius, passLambda, nPhotons);
+            }
+            ParallelFor2D(pixelBounds, [&](Point2i pPixel) {
+                SPPMPixel &pixel = pixels[pPixel];
+                if (!pixel.vp.beta)
+                    return;
+                ++visiblePointsGathered;
+                RGB Phi_i(0, 0, 0);
+                int m = 0;
+                photonMap->ForEachPhoton(
+                    pixel.vp.p, pixel.radius, [&](const SPPMPhoton &photon) {
+                        SampledSpectrum Phi =
+                            photon.beta * pixel.vp.bsdf.f(pixel.vp.wo, photon.wi);
+                        SampledWavelengths photonLambda = passLambda;
+                        if (photon.secondaryLambdaTerminated ||
+                            pixel.vp.secondaryLambdaTerminated)
+                            photonLambda.TerminateSecondary();
+                        Phi_i += film.ToOutputRGB(pixel.vp.beta * Phi, photonLambda);
+                        ++m;
+                    });
+                for (int c = 0; c < 3; ++c)
+                    pixel.Phi_i[c] = Phi_i[c];
+                pixel.m = m;
+            });
+        }
+
         // Reset _threadScratchBuffers_ after tracing photons
         threadScratchBuffers.ForAll([](ScratchBuffer &buffer) { buffer.Reset(); });
 
         progress.Update();
-        photonPaths += photonsPerIteration;
+        if (tracePhotons) {
+            photonPaths += nPhotons;
+            nPhotonsTraced += nPhotons;
+        }
+        // Passes that reuse a photon map count its paths again, since each
+        // pass's photon contributions are normalized on their own
+        int64_t nPassPaths = photonGather ? photonMap->PathCount() : nPhotons;
+        nPhotonPaths += nPassPaths;
 
         // Update pixel values from this pass's photons
+        AtomicDouble radiusRatioSum(0);
+        std::atomic<int64_t> nVisiblePoints{0};
         ParallelFor2D(pixelBounds, [&](Point2i pPixel) {
             SPPMPixel &p = pixels[pPixel];
+            if (p.vp.beta) {
+                ++nVisiblePoints;
+                if (p.m.load(std::memory_order_relaxed) == 0)
+                    radiusRatioSum.Add(1);
+            }
             if (int m = p.m.load(std::memory_order_relaxed); m > 0) {
                 // Compute new photon count and search radius given photons
                 Float gamma = (Float)2 / (Float)3;
                 Float nNew = p.n + gamma * m;
                 Float rNew = p.radius * std::sqrt(nNew / (p.n + m));
+                radiusRatioSum.Add(rNew / p.radius);
 
                 // Update $\tau$ for pixel
                 RGB Phi_i(p.Phi_i[0], p.Phi_i[1], p.Phi_i[2]);
@@ -3216,10 +3955,24 @@ void SPPMIntegrator::Render() {
             p.vp.bsdf = BSDF();
         });
 
+        if (targetShrinkage > 0 && tracePhotons && nVisiblePoints > 0) {
+            // Adapt photon count to the radius shrinkage observed in this pass
+            // Shoot more photons when radii shrink too slowly to make progress
+            // and fewer when they shrink fast enough for quicker passes.
+            Float shrinkage = 1 - Float(radiusRatioSum) / nVisiblePoints;
+            if (shrinkage < targetShrinkage)
+                nPhotons = std::min<int64_t>(nPhotons * 3 / 2, 16 * photonsPerIteration);
+            else if (shrinkage > 2 * targetShrinkage)
+                nPhotons =
+                    std::max<int64_t>(nPhotons * 2 / 3, (photonsPerIteration + 15) / 16);
+            LOG_VERBOSE("SPPM pass %d: mean radius shrinkage %f, next pass shoots %d "
+                        "photons", iter, shrinkage, nPhotons);
+        }
+
         // Periodically write SPPM image to disk
         if (iter + 1 == nIterations || (iter + 1 <= 64 && IsPowerOf2(iter + 1)) ||
             ((iter + 1) % 64 == 0)) {
-            uint64_t np = (uint64_t)(iter + 1) * (uint64_t)photonsPerIteration;
+            uint64_t np = nPhotonPaths;
             Image rgbImage(PixelFormat::Float, Point2i(pixelBounds.Diagonal()),
                            {"R", "G", "B"});
 
@@ -3323,9 +4076,10 @@ SampledSpectrum SPPMIntegrator::SampleLd(const SurfaceInteraction &intr, const B
 std::string SPPMIntegrator::ToString() const {
     return StringPrintf("[ SPPMIntegrator camera: %s initialSearchRadius: %f "
                         "maxDepth: %d photonsPerIteration: %d "
-                        "colorSpace: %s digitPermutations: (elided) ]",
+                        "colorSpace: %s digitPermutations: (elided) photonGather: %s "
+                        "photonReuse: %d targetShrinkage: %f ]",
                         camera, initialSearchRadius, maxDepth, photonsPerIteration,
-                        *colorSpace);
+                        *colorSpace, photonGather, photonReuse, targetShrinkage);
 }
 
 std::unique_ptr<SPPMIntegrator> SPPMIntegrator::Create(
@@ -3335,9 +4089,335 @@ std::unique_ptr<SPPMIntegrator> SPPMIntegrator::Create(
     int photonsPerIter = parameters.GetOneInt("photonsperiteration", -1);
     Float radius = parameters.GetOneFloat("radius", 1.f);
     int seed = parameters.GetOneInt("seed", Options->seed);
+    bool photonGather = parameters.GetOneBool("photongather", false);
+    int photonReuse = parameters.GetOneInt("photonreuse", 1);
+    if (photonReuse < 1)
+        ErrorExit(loc, "\"photonreuse\" must be at least one.");
+    if (photonReuse > 1 && !photonGather) {
+        Warning(loc, "\"photonreuse\" is only supported with \"photongather\".");
+        photonReuse = 1;
+    }
+    Float targetShrinkage = parameters.GetOneFloat("targetshrinkage", 0.f);
     return std::make_unique<SPPMIntegrator>(camera, sampler, aggregate, lights,
                                             photonsPerIter, maxDepth, radius, seed,
-                                            colorSpace);
+                                            colorSpace, photonGather, photonReuse,
+                                            targetShrinkage);
+}
+
+STAT_RATIO("Vertex Connection and Merging/Light vertices merged per camera vertex",
+           vcmMergedVertices, vcmMergeQueries);
+STAT_COUNTER("Vertex Connection and Merging/Light vertices stored", vcmStoredVertices);
+STAT_MEMORY_COUNTER("Memory/VCM Light Vertex Grid", vcmGridBytes);
+
+// VCMLightPath Definition
+struct VCMLightPath {
+    Vertex *vertices = nullptr;
+    // Partial sums of the light subpath's MIS pdf ratios; see _ComputeMISSums()_
+    const Float *misSums = nullptr;
+    int nVertices = 0;
+    bool secondaryLambdaTerminated = false;
+};
+
+// VCMGridVertex Definition
+struct VCMGridVertex {
+    Point3f p;
+    int path, index, cell;
+};
+
+// VCMLightVertexGrid Definition
+class VCMLightVertexGrid {
+  public:
+    // VCMLightVertexGrid Public Methods
+    VCMLightVertexGrid(ThreadLocal<std::vector<VCMGridVertex>> &threadVertices,
+                       Float radius)
+        : radius(radius), grid(threadVertices, 2 * radius) {
+        vcmGridBytes = std::max<int64_t>(vcmGridBytes, grid.BytesUsed());
+    }
+
+    // Calls _func_ for each light vertex within the merge radius of _p_
+    template <typename F>
+    void ForEachVertex(Point3f p, F func) const {
+        grid.ForEachCandidate(p, radius, [&](const VCMGridVertex &v) {
+            if (DistanceSquared(v.p, p) <= Sqr(radius))
+                func(v);
+        });
+    }
+
+    Float Radius() const { return radius; }
+
+  private:
+    // VCMLightVertexGrid Private Members
+    Float radius;
+    HashedPointGrid<VCMGridVertex> grid;
+};
+
+// VCM Utility Functions
+static SampledSpectrum MatchWavelengths(SampledSpectrum L, bool lightLambdaTerminated,
+                                        const SampledWavelengths &lambda) {
+    // Express a contribution that only holds for the primary wavelength of its
+    // light subpath with respect to the camera subpath's wavelengths
+    if (lightLambdaTerminated && !lambda.SecondaryTerminated()) {
+        for (int i = 1; i < NSpectrumSamples; ++i)
+            L[i] = 0;
+        L[0] *= NSpectrumSamples;
+    }
+    return L;
+}
+
+// VCM Method Definitions
+void VCMIntegrator::Render() {
+    // Initialize local variables for _VCMIntegrator::Render()_
+    int nIterations = samplerPrototype.SamplesPerPixel();
+    ProgressReporter progress(nIterations, "Rendering", Options->quiet);
+    const Float invSqrtSPP = 1.f / std::sqrt(nIterations);
+    Film film = camera.GetFilm();
+    Bounds2i pixelBounds = film.PixelBounds();
+    CHECK(!pixelBounds.IsEmpty());
+    int nPixels = pixelBounds.Area(), xResolution = pixelBounds.Diagonal().x;
+
+    // Allocate per-thread state for VCM rendering
+    // Light subpaths, including their BSDFs, must persist until they have been
+    // merged with the camera subpaths of their pass.
+    ThreadLocal<ScratchBuffer> lightScratchBuffers(
+        []() { return ScratchBuffer(1024 * 1024); });
+    ThreadLocal<ScratchBuffer> cameraScratchBuffers;
+    ThreadLocal<Sampler> threadSamplers(
+        [this]() { return samplerPrototype.Clone(Allocator()); });
+    // Light subpaths use their own sampler so that they are independent of
+    // the camera subpaths of the same pixel samples
+    ThreadLocal<IndependentSampler> threadLightPathSamplers(
+        [&]() { return IndependentSampler(nIterations, int(MixBits(seed))); });
+    ThreadLocal<std::vector<VCMGridVertex>> threadGridVertices;
+    std::vector<VCMLightPath> lightPaths(nPixels);
+
+    for (int iter = 0; iter < nIterations; ++iter) {
+        // Connect to display server for VCM if requested
+        if (iter == 0 && !Options->displayServer.empty()) {
+            DisplayDynamic(
+                film.GetFilename(), Point2i(pixelBounds.Diagonal()), {"R", "G", "B"},
+                [&](Bounds2i b, pstd::span<pstd::span<float>> displayValue) {
+                    int index = 0;
+                    for (Point2i p : b) {
+                        RGB rgb = film.GetPixelRGB(pixelBounds.pMin + p,
+                                                   1.f / std::max(iter, 1));
+                        for (int c = 0; c < 3; ++c)
+                            displayValue[c][index] = rgb[c];
+                        ++index;
+                    }
+                });
+        }
+
+        // Compute merge radius, wavelengths, and time for VCM pass
+        // All subpaths of a pass share wavelengths so that they can be merged.
+        Float radius = initialRadius * std::pow(Float(iter + 1), (radiusAlpha - 1) / 2);
+        Float mergeScale = Pi * Sqr(radius) * nPixels;
+        Float uLambda = Options->disableWavelengthJitter ? Float(0.5)
+                                                         : RadicalInverse(1, iter);
+        const SampledWavelengths passLambda = film.SampleWavelengths(uLambda);
+        Float uTime = RadicalInverse(2, iter);
+
+        // Trace light subpaths and connect them to the camera
+        lightScratchBuffers.ForAll([](ScratchBuffer &buf) { buf.Reset(); });
+        threadGridVertices.ForAll([](std::vector<VCMGridVertex> &v) { v.clear(); });
+        ParallelFor(0, nPixels, [&](int64_t start, int64_t end) {
+            ScratchBuffer &scratchBuffer = lightScratchBuffers.Get();
+            ScratchBuffer &pathScratchBuffer = cameraScratchBuffers.Get();
+            Sampler sampler = &threadLightPathSamplers.Get();
+            std::vector<VCMGridVertex> &gridVertices = threadGridVertices.Get();
+            for (int64_t i = start; i < end; ++i) {
+                Point2i pPixel = pixelBounds.pMin +
+                                 Vector2i(i % xResolution, i / xResolution);
+                sampler.StartPixelSample(pPixel, iter);
+                // Generate light subpath and copy its vertices to persistent memory
+                SampledWavelengths lambda = passLambda;
+                Vertex *path = pathScratchBuffer.Alloc<Vertex[]>(maxDepth + 1);
+                int nVertices = GenerateLightSubpath(
+                    *this, lambda, sampler, camera, scratchBuffer, maxDepth + 1,
+                    camera.SampleTime(uTime), lightSampler, path, regularize);
+                VCMLightPath &lightPath = lightPaths[i];
+                lightPath.vertices =
+                    nVertices > 0 ? scratchBuffer.Alloc<Vertex[]>(nVertices) : nullptr;
+                std::copy(path, path + nVertices, lightPath.vertices);
+                lightPath.nVertices = nVertices;
+                lightPath.secondaryLambdaTerminated = lambda.SecondaryTerminated();
+                pathScratchBuffer.Reset();
+
+                // Compute light subpath's MIS sums and record its mergeable vertices
+                BDPTMISSums misSums = ComputeMISSums(nullptr, 0, lightPath.vertices,
+                                                     nVertices, camera, scratchBuffer,
+                                                     mergeScale);
+                lightPath.misSums = misSums.light;
+                for (int k = 1; k < nVertices; ++k)
+                    if (lightPath.vertices[k].IsMergeable()) {
+                        gridVertices.push_back(
+                            VCMGridVertex{lightPath.vertices[k].p(), int(i), k, 0});
+                        ++vcmStoredVertices;
+                    }
+
+                // Connect light subpath vertices to the camera
+                Vertex cameraVertex;
+                for (int s = 2; s <= nVertices; ++s) {
+                    pstd::optional<Point2f> pRaster;
+                    SampledSpectrum L = ConnectBDPT(
+                        *this, lambda, lightPath.vertices, &cameraVertex, s, 1,
+                        lightSampler, camera, sampler, &pRaster, nullptr, &misSums);
+                    if (L)
+                        film.AddSplat(*pRaster, L, lambda);
+                }
+            }
+        });
+
+        // Build grid of light vertices for merging
+        VCMLightVertexGrid grid(threadGridVertices, radius);
+
+        // Trace camera subpaths and connect and merge them with light subpaths
+        ParallelFor2D(pixelBounds, [&](Bounds2i tileBounds) {
+            ScratchBuffer &scratchBuffer = cameraScratchBuffers.Get();
+            Sampler &sampler = threadSamplers.Get();
+            for (Point2i pPixel : tileBounds) {
+                sampler.StartPixelSample(pPixel, iter);
+                // Generate camera ray for pixel for VCM
+                SampledWavelengths lambda = passLambda;
+                CameraSample cs = GetCameraSample(sampler, pPixel, film.GetFilter());
+                cs.time = uTime;
+                pstd::optional<CameraRayDifferential> crd =
+                    camera.GenerateRayDifferential(cs, lambda);
+
+                // Compute radiance along camera ray and add it to the film
+                SampledSpectrum L(0.f);
+                if (crd && crd->weight) {
+                    if (!Options->disablePixelJitter)
+                        crd->ray.ScaleDifferentials(invSqrtSPP);
+                    Vector2i offset = pPixel - pixelBounds.pMin;
+                    const VCMLightPath &lightPath =
+                        lightPaths[offset.x + offset.y * xResolution];
+                    L = crd->weight * Li(crd->ray, lambda, sampler, scratchBuffer,
+                                         lightPath, lightPaths, grid);
+                    if (L.HasNaNs() || IsInf(L.y(lambda))) {
+                        LOG_ERROR("Invalid radiance value returned for pixel (%d, %d), "
+                                  "pass %d. Setting to black.",
+                                  pPixel.x, pPixel.y, iter);
+                        L = SampledSpectrum(0.f);
+                    }
+                }
+                film.AddSample(pPixel, L, lambda, nullptr, cs.filterWeight);
+                scratchBuffer.Reset();
+            }
+        });
+        progress.Update();
+
+        // Optionally write current image to disk
+        if (iter + 1 == nIterations || Options->writePartialImages) {
+            ImageMetadata metadata;
+            metadata.renderTimeSeconds = progress.ElapsedSeconds();
+            metadata.samplesPerPixel = iter + 1;
+            camera.InitMetadata(&metadata);
+            film.WriteImage(metadata, 1.0f / (iter + 1));
+        }
+    }
+    progress.Done();
+    DisconnectFromDisplayServer();
+}
+
+SampledSpectrum VCMIntegrator::Li(RayDifferential ray, SampledWavelengths &lambda,
+                                  Sampler sampler, ScratchBuffer &scratchBuffer,
+                                  const VCMLightPath &lightPath,
+                                  pstd::span<const VCMLightPath> lightPaths,
+                                  const VCMLightVertexGrid &grid) const {
+    // Trace the camera subpath and compute its MIS sums
+    Vertex *cameraVertices = scratchBuffer.Alloc<Vertex[]>(maxDepth + 2);
+    int nCamera = GenerateCameraSubpath(*this, ray, lambda, sampler, scratchBuffer,
+                                        maxDepth + 2, camera, cameraVertices, regularize);
+    Float mergeScale = Pi * Sqr(grid.Radius()) * lightPaths.size();
+    BDPTMISSums misSums = ComputeMISSums(cameraVertices, nCamera, nullptr, 0, camera,
+                                         scratchBuffer, mergeScale);
+
+    // Execute connection strategies with the pixel sample's light subpath
+    SampledSpectrum L(0.f);
+    misSums.light = lightPath.misSums;
+    for (int t = 2; t <= nCamera; ++t)
+        for (int s = 0; s <= lightPath.nVertices && s + t - 2 <= maxDepth; ++s) {
+            pstd::optional<Point2f> pRaster;
+            SampledSpectrum Lpath =
+                ConnectBDPT(*this, lambda, lightPath.vertices, cameraVertices, s, t,
+                            lightSampler, camera, sampler, &pRaster, nullptr, &misSums);
+            L += s > 1 ? MatchWavelengths(Lpath, lightPath.secondaryLambdaTerminated,
+                                          lambda)
+                       : Lpath;
+        }
+
+    // Execute merging strategies at camera subpath vertices
+    for (int t = 2; t <= nCamera; ++t) {
+        const Vertex &pt = cameraVertices[t - 1];
+        if (!pt.IsMergeable())
+            continue;
+        ++vcmMergeQueries;
+        grid.ForEachVertex(pt.p(), [&](const VCMGridVertex &v) {
+            // Skip light vertex if the merged path would be too long
+            const VCMLightPath &path = lightPaths[v.path];
+            int s = v.index + 1;
+            if (s + t - 3 > maxDepth)
+                return;
+
+            // Compute unweighted contribution of merging light vertex _qs_ at _pt_
+            const Vertex &qs = path.vertices[v.index];
+            SampledSpectrum Lmerge =
+                pt.beta * pt.bsdf.f(pt.si.wo, qs.si.wo) * qs.beta / mergeScale;
+            if (!Lmerge)
+                return;
+            ++vcmMergedVertices;
+
+            // Compute MIS weight for merge relative to the $(s, t-1)$ connection
+            // The connection's own density only counts if it is a valid strategy
+            // for the path, which it is not if $\pt{}_{t-2}$ scatters specularly.
+            BDPTMISSums mergeSums = misSums;
+            mergeSums.light = path.misSums;
+            bool deltaPredecessor = cameraVertices[t - 2].delta;
+            Float qsPdfRev = 0;
+            Float sumRi = IncrementalMISRatios(*this, path.vertices, cameraVertices,
+                                               cameraVertices[0], s, t - 1, lightSampler,
+                                               mergeSums, deltaPredecessor, &qsPdfRev);
+            Float connectionCount =
+                deltaPredecessor ? 0 : (t - 1 == 1 ? misSums.splatScale : 1);
+            Float misWeight = Remap0(qsPdfRev) * mergeScale / (connectionCount + sumRi);
+
+            L += MatchWavelengths(misWeight * Lmerge, path.secondaryLambdaTerminated,
+                                  lambda);
+        });
+    }
+
+    return L;
+}
+
+std::string VCMIntegrator::ToString() const {
+    return StringPrintf("[ VCMIntegrator camera: %s maxDepth: %d initialRadius: %f "
+                        "radiusAlpha: %f seed: %d regularize: %s lightSampler: %s ]",
+                        camera, maxDepth, initialRadius, radiusAlpha, seed, regularize,
+                        lightSampler);
+}
+
+std::unique_ptr<VCMIntegrator> VCMIntegrator::Create(
+    const ParameterDictionary &parameters, Camera camera, Sampler sampler,
+    Primitive aggregate, std::vector<Light> lights, const FileLoc *loc) {
+    if (!camera.Is<PerspectiveCamera>())
+        ErrorExit("Only the \"perspective\" camera is currently supported with the "
+                  "\"vcm\" integrator.");
+    int maxDepth = parameters.GetOneInt("maxdepth", 5);
+    // Default to a merge radius proportional to the scene's size
+    Float radius = parameters.GetOneFloat("radius", 0.f);
+    if (radius <= 0) {
+        Point3f pCenter;
+        Float sceneRadius;
+        aggregate.Bounds().BoundingSphere(&pCenter, &sceneRadius);
+        radius = 0.003f * sceneRadius;
+    }
+    Float radiusAlpha = parameters.GetOneFloat("radiusalpha", 0.75f);
+    if (radiusAlpha <= 0 || radiusAlpha > 1)
+        ErrorExit(loc, "\"radiusalpha\" must be in (0, 1].");
+    int seed = parameters.GetOneInt("seed", Options->seed);
+    bool regularize = parameters.GetOneBool("regularize", false);
+    return std::make_unique<VCMIntegrator>(camera, sampler, aggregate, lights, maxDepth,
+                                           radius, radiusAlpha, seed, regularize);
 }
 
 // FunctionIntegrator Method Definitions
@@ -3682,6 +4762,9 @@ std::unique_ptr<Integrator> Integrator::Create(
     else if (name == "sppm")
         integrator = SPPMIntegrator::Create(parameters, colorSpace, camera, sampler,
                                             aggregate, lights, loc);
+    else if (name == "vcm")
+        integrator =
+            VCMIntegrator::Create(parameters, camera, sampler, aggregate, lights, loc);
     else
         ErrorExit(loc, "%s: integrator type unknown.", name);
 
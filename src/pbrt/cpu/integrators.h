@@ -11,6 +11,7 @@
 #include <pbrt/base/sampler.h>
 #include <pbrt/bsdf.h>
 #include <pbrt/cameras.h>
+#include <pbrt/cpu/guiding.h>
 #include <pbrt/cpu/primitive.h>
 #include <pbrt/film.h>
 #include <pbrt/interaction.h>
@@ -90,6 +91,11 @@ class ImageTileIntegrator : public Integrator {
                                      ScratchBuffer &scratchBuffer) = 0;
 
   protected:
+    // ImageTileIntegrator Protected Methods
+    // Called between waves of pixel samples so that integrators can update
+    // state learned from the samples taken so far.
+    virtual void EndWave(int nWaveSamples) {}
+
     // ImageTileIntegrator Protected Members
     Camera camera;
     Sampler samplerPrototype;
@@ -210,7 +216,8 @@ class PathIntegrator : public RayIntegrator {
     PathIntegrator(int maxDepth, Camera camera, Sampler sampler, Primitive aggregate,
                    std::vector<Light> lights,
                    const std::string &lightSampleStrategy = "bvh",
-                   bool regularize = false);
+                   bool regularize = false, int nLightCandidates = 1,
+                   bool guiding = false, bool lightVisibility = false);
 
     SampledSpectrum Li(RayDifferential ray, SampledWavelengths &lambda, Sampler sampler,
                        ScratchBuffer &scratchBuffer,
@@ -224,15 +231,42 @@ class PathIntegrator : public RayIntegrator {
 
     std::string ToString() const;
 
+  protected:
+    void EndWave(int nWaveSamples) {
+        if (guide)
+            guide->Refine(nWaveSamples);
+        if (visibilityCache)
+            visibilityCache->Update();
+    }
+
   private:
     // PathIntegrator Private Methods
+    pstd::optional<SampledLight> SampleLight(const LightSampleContext &ctx,
+                                             const LightSampleContext &regionCtx,
+                                             Float u) const {
+        return visibilityCache ? visibilityCache->Sample(ctx, regionCtx, u)
+                               : lightSampler.Sample(ctx, u);
+    }
+    Float LightPMF(const LightSampleContext &ctx, Light light) const {
+        return visibilityCache ? visibilityCache->PMF(ctx, light)
+                               : lightSampler.PMF(ctx, light);
+    }
+
     SampledSpectrum SampleLd(const SurfaceInteraction &intr, const BSDF *bsdf,
-                             SampledWavelengths &lambda, Sampler sampler) const;
+                             const GuidingRegion *region, SampledWavelengths &lambda,
+                             Sampler sampler) const;
+    SampledSpectrum SampleLdResampled(const SurfaceInteraction &intr, const BSDF *bsdf,
+                                      const GuidingRegion *region,
+                                      const LightSampleContext &ctx,
+                                      SampledWavelengths &lambda, Sampler sampler) const;
 
     // PathIntegrator Private Members
     int maxDepth;
     LightSampler lightSampler;
     bool regularize;
+    int nLightCandidates;
+    std::unique_ptr<PathGuide> guide;
+    std::unique_ptr<LightVisibilityCache> visibilityCache;
 };
 
 // SimpleVolPathIntegrator Definition
@@ -264,11 +298,16 @@ class VolPathIntegrator : public RayIntegrator {
     VolPathIntegrator(int maxDepth, Camera camera, Sampler sampler, Primitive aggregate,
                       std::vector<Light> lights,
                       const std::string &lightSampleStrategy = "bvh",
-                      bool regularize = false)
+                      bool regularize = false, bool guiding = false,
+                      bool residualTracking = false)
         : RayIntegrator(camera, sampler, aggregate, lights),
           maxDepth(maxDepth),
           lightSampler(LightSampler::Create(lightSampleStrategy, lights, Allocator())),
-          regularize(regularize) {}
+          regularize(regularize),
+          residualTracking(residualTracking) {
+        if (guiding && aggregate)
+            guide = std::make_unique<PathGuide>(aggregate.Bounds());
+    }
 
     SampledSpectrum Li(RayDifferential ray, SampledWavelengths &lambda, Sampler sampler,
                        ScratchBuffer &scratchBuffer,
@@ -280,16 +319,26 @@ class VolPathIntegrator : public RayIntegrator {
 
     std::string ToString() const;
 
+  protected:
+    void EndWave(int nWaveSamples) {
+        if (guide)
+            guide->Refine(nWaveSamples);
+    }
+
   private:
     // VolPathIntegrator Private Methods
     SampledSpectrum SampleLd(const Interaction &intr, const BSDF *bsdf,
                              SampledWavelengths &lambda, Sampler sampler,
-                             SampledSpectrum beta, SampledSpectrum inv_w_u) const;
+                             SampledSpectrum beta, SampledSpectrum inv_w_u,
+                             const GuidingRegion *region = nullptr) const;
 
     // VolPathIntegrator Private Members
     int maxDepth;
     LightSampler lightSampler;
     bool regularize;
+    std::unique_ptr<PathGuide> guide;
+    // Estimate shadow ray transmittance with residual ratio tracking
+    bool residualTracking;
 };
 
 // AOIntegrator Definition
@@ -347,18 +396,25 @@ class BDPTIntegrator : public RayIntegrator {
     // BDPTIntegrator Public Methods
     BDPTIntegrator(Camera camera, Sampler sampler, Primitive aggregate,
                    std::vector<Light> lights, int maxDepth, bool visualizeStrategies,
-                   bool visualizeWeights, bool regularize = false)
+                   bool visualizeWeights, bool regularize = false,
+                   bool incrementalMIS = false)
         : RayIntegrator(camera, sampler, aggregate, lights),
           maxDepth(maxDepth),
           regularize(regularize),
           lightSampler(new PowerLightSampler(lights, Allocator())),
           visualizeStrategies(visualizeStrategies),
-          visualizeWeights(visualizeWeights) {}
+          visualizeWeights(visualizeWeights),
+          incrementalMIS(incrementalMIS) {}
 
     SampledSpectrum Li(RayDifferential ray, SampledWavelengths &lambda, Sampler sampler,
                        ScratchBuffer &scratchBuffer,
                        VisibleSurface *visibleSurface) const;
 
+    // Returns the largest difference between the incremental MIS weights and
+    // those of _MISWeight()_ over the strategies for a path sampled through _ray_
+    Float IncrementalMISWeightError(RayDifferential ray, SampledWavelengths &lambda,
+                                    Sampler sampler, ScratchBuffer &scratchBuffer) const;
+
     static std::unique_ptr<BDPTIntegrator> Create(const ParameterDictionary &parameters,
                                                   Camera camera, Sampler sampler,
                                                   Primitive aggregate,
@@ -376,6 +432,9 @@ class BDPTIntegrator : public RayIntegrator {
     LightSampler lightSampler;
     bool visualizeStrategies, visualizeWeights;
     mutable std::vector<Film> weightFilms;
+    // Compute MIS weights from per-subpath partial sums and trace all of a
+    // sample's connection shadow rays after its strategies are evaluated
+    bool incrementalMIS;
 };
 
 // MLTIntegrator Definition
@@ -438,7 +497,9 @@ class SPPMIntegrator : public Integrator {
     // SPPMIntegrator Public Methods
     SPPMIntegrator(Camera camera, Sampler sampler, Primitive aggregate,
                    std::vector<Light> lights, int photonsPerIteration, int maxDepth,
-                   Float initialSearchRadius, int seed, const RGBColorSpace *colorSpace)
+                   Float initialSearchRadius, int seed, const RGBColorSpace *colorSpace,
+                   bool photonGather = false, int photonReuse = 1,
+                   Float targetShrinkage = 0)
         : Integrator(aggregate, lights),
           camera(camera),
           samplerPrototype(sampler),
@@ -448,7 +509,10 @@ class SPPMIntegrator : public Integrator {
                                   ? photonsPerIteration
                                   : camera.GetFilm().PixelBounds().Area()),
           colorSpace(colorSpace),
-          digitPermutationsSeed(seed) {}
+          digitPermutationsSeed(seed),
+          photonGather(photonGather),
+          photonReuse(photonReuse),
+          targetShrinkage(targetShrinkage) {}
 
     static std::unique_ptr<SPPMIntegrator> Create(const ParameterDictionary &parameters,
                                                   const RGBColorSpace *colorSpace,
@@ -475,6 +539,61 @@ class SPPMIntegrator : public Integrator {
     int maxDepth;
     int photonsPerIteration;
     const RGBColorSpace *colorSpace;
+    // Store each pass's photons in a photon map and gather them at visible
+    // points, reusing a map for _photonReuse_ passes
+    bool photonGather;
+    int photonReuse;
+    // Mean relative radius reduction per pass that photon counts adapt to
+    Float targetShrinkage;
+};
+
+// VCMIntegrator Definition
+struct VCMLightPath;
+class VCMLightVertexGrid;
+
+class VCMIntegrator : public Integrator {
+  public:
+    // VCMIntegrator Public Methods
+    VCMIntegrator(Camera camera, Sampler sampler, Primitive aggregate,
+                  std::vector<Light> lights, int maxDepth, Float initialRadius,
+                  Float radiusAlpha, int seed, bool regularize)
+        : Integrator(aggregate, lights),
+          camera(camera),
+          samplerPrototype(sampler),
+          lightSampler(new PowerLightSampler(lights, Allocator())),
+          maxDepth(maxDepth),
+          initialRadius(initialRadius),
+          radiusAlpha(radiusAlpha),
+          seed(seed),
+          regularize(regularize) {}
+
+    static std::unique_ptr<VCMIntegrator> Create(const ParameterDictionary &parameters,
+                                                 Camera camera, Sampler sampler,
+                                                 Primitive aggregate,
+                                                 std::vector<Light> lights,
+                                                 const FileLoc *loc);
+
+    std::string ToString() const;
+
+    void Render();
+
+  private:
+    // VCMIntegrator Private Methods
+    SampledSpectrum Li(RayDifferential ray, SampledWavelengths &lambda, Sampler sampler,
+                       ScratchBuffer &scratchBuffer, const VCMLightPath &lightPath,
+                       pstd::span<const VCMLightPath> lightPaths,
+                       const VCMLightVertexGrid &grid) const;
+
+    // VCMIntegrator Private Members
+    Camera camera;
+    Sampler samplerPrototype;
+    LightSampler lightSampler;
+    int maxDepth;
+    // Merge radius of the first pass and the exponent that governs its
+    // reduction in later ones
+    Float initialRadius, radiusAlpha;
+    int seed;
+    bool regularize;
 };
 
 // FunctionIntegrator Definition
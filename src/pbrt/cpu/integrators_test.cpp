@@ -18,6 +18,7 @@
 #include <pbrt/util/color.h>
 #include <pbrt/util/colorspace.h>
 #include <pbrt/util/image.h>
+#include <pbrt/util/memory.h>
 #include <pbrt/util/spectrum.h>
 #include <pbrt/util/vecmath.h>
 
@@ -270,6 +271,19 @@ std::vector<std::pair<Sampler, std::string>> GetSamplers(const Point2i &resoluti
     return samplers;
 }
 
+// Returns a perspective camera at the origin with a film of its own
+Camera CreateTestCamera(Point2i resolution) {
+    static Transform id;
+    AnimatedTransform identity(id, 0, id, 1);
+    Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
+    FilmBaseParameters fp(resolution, Bounds2i(Point2i(0, 0), resolution), filter, 1.,
+                          PixelSensor::CreateDefault(), inTestDir("test.exr"));
+    RGBFilm *film = new RGBFilm(fp, RGBColorSpace::sRGB);
+    CameraBaseParameters cbp(CameraTransform(identity), film, nullptr, {}, nullptr);
+    return new PerspectiveCamera(cbp, 45, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0.,
+                                 10.);
+}
+
 std::vector<TestIntegrator> GetIntegrators() {
     std::vector<TestIntegrator> integrators;
 
@@ -318,6 +332,69 @@ std::vector<TestIntegrator> GetIntegrators() {
                  scene});
         }
 
+        for (auto &sampler : GetSamplers(resolution)) {
+            Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
+            FilmBaseParameters fp(resolution, Bounds2i(Point2i(0, 0), resolution), filter,
+                                  1., PixelSensor::CreateDefault(),
+                                  inTestDir("test.exr"));
+            RGBFilm *film = new RGBFilm(fp, RGBColorSpace::sRGB);
+            CameraBaseParameters cbp(CameraTransform(identity), film, nullptr, {},
+                                     nullptr);
+            PerspectiveCamera *camera = new PerspectiveCamera(
+                cbp, 45, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 10.);
+
+            const Film filmp = camera->GetFilm();
+            Integrator *integrator =
+                new PathIntegrator(8, camera, sampler.first, scene.aggregate,
+                                   scene.lights, "bvh", false, 4 /* nLightCandidates */);
+            integrators.push_back({integrator, filmp,
+                                   "Path, depth 8, 4 light candidates, Perspective, " +
+                                       sampler.second + ", " + scene.description,
+                                   scene});
+        }
+
+        for (auto &sampler : GetSamplers(resolution)) {
+            Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
+            FilmBaseParameters fp(resolution, Bounds2i(Point2i(0, 0), resolution), filter,
+                                  1., PixelSensor::CreateDefault(),
+                                  inTestDir("test.exr"));
+            RGBFilm *film = new RGBFilm(fp, RGBColorSpace::sRGB);
+            CameraBaseParameters cbp(CameraTransform(identity), film, nullptr, {},
+                                     nullptr);
+            PerspectiveCamera *camera = new PerspectiveCamera(
+                cbp, 45, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 10.);
+
+            const Film filmp = camera->GetFilm();
+            Integrator *integrator =
+                new PathIntegrator(8, camera, sampler.first, scene.aggregate,
+                                   scene.lights, "bvh", false, 1, true /* guiding */);
+            integrators.push_back({integrator, filmp,
+                                   "Path, depth 8, guided, Perspective, " +
+                                       sampler.second + ", " + scene.description,
+                                   scene});
+        }
+
+        for (auto &sampler : GetSamplers(resolution)) {
+            Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
+            FilmBaseParameters fp(resolution, Bounds2i(Point2i(0, 0), resolution), filter,
+                                  1., PixelSensor::CreateDefault(),
+                                  inTestDir("test.exr"));
+            RGBFilm *film = new RGBFilm(fp, RGBColorSpace::sRGB);
+            CameraBaseParameters cbp(CameraTransform(identity), film, nullptr, {},
+                                     nullptr);
+            PerspectiveCamera *camera = new PerspectiveCamera(
+                cbp, 45, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 10.);
+
+            const Film filmp = camera->GetFilm();
+            Integrator *integrator = new PathIntegrator(
+                8, camera, sampler.first, scene.aggregate, scene.lights, "bvh", false, 1,
+                false, true /* lightVisibility */);
+            integrators.push_back({integrator, filmp,
+                                   "Path, depth 8, light visibility, Perspective, " +
+                                       sampler.second + ", " + scene.description,
+                                   scene});
+        }
+
         // Volume path tracing integrators
         for (auto &sampler : GetSamplers(resolution)) {
             Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
@@ -379,26 +456,34 @@ std::vector<TestIntegrator> GetIntegrators() {
                                    scene});
         }
 
-        // BDPT
+        // BDPT and VCM; each integrator renders to the film of its own camera
         for (auto &sampler : GetSamplers(resolution)) {
-            Filter filter = new BoxFilter(Vector2f(0.5, 0.5));
-            FilmBaseParameters fp(resolution, Bounds2i(Point2i(0, 0), resolution), filter,
-                                  1., PixelSensor::CreateDefault(),
-                                  inTestDir("test.exr"));
-            RGBFilm *film = new RGBFilm(fp, RGBColorSpace::sRGB);
-            CameraBaseParameters cbp(CameraTransform(identity), film, nullptr, {},
-                                     nullptr);
-            PerspectiveCamera *camera = new PerspectiveCamera(
-                cbp, 45, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 10.);
-            const Film filmp = camera->GetFilm();
-
+            Camera camera = CreateTestCamera(resolution);
             Integrator *integrator =
                 new BDPTIntegrator(camera, sampler.first, scene.aggregate, scene.lights,
                                    6, false, false, false);
-            integrators.push_back({integrator, filmp,
-                                   "BDPT, depth 8, Perspective, " + sampler.second +
+            integrators.push_back({integrator, camera.GetFilm(),
+                                   "BDPT, depth 6, Perspective, " + sampler.second +
                                        ", " + scene.description,
                                    scene});
+
+            camera = CreateTestCamera(resolution);
+            integrator =
+                new BDPTIntegrator(camera, sampler.first, scene.aggregate, scene.lights,
+                                   6, false, false, false, true /* incremental MIS */);
+            integrators.push_back({integrator, camera.GetFilm(),
+                                   "BDPT incremental MIS, depth 6, Perspective, " +
+                                       sampler.second + ", " + scene.description,
+                                   scene});
+
+            camera = CreateTestCamera(resolution);
+            integrator = new VCMIntegrator(camera, sampler.first, scene.aggregate,
+                                           scene.lights, 6, 0.01f /* radius */,
+                                           0.75f /* radius alpha */, 0 /* seed */, false);
+            integrators.push_back({integrator, camera.GetFilm(),
+                                   "VCM, depth 6, Perspective, " + sampler.second + ", " +
+                                       scene.description,
+                                   scene});
         }
 
         // MLT
@@ -445,3 +530,32 @@ TEST_P(RenderTest, RadianceMatches) {
 
 INSTANTIATE_TEST_CASE_P(AnalyticTestScenes, RenderTest,
                         testing::ValuesIn(GetIntegrators()));
+
+TEST(BDPT, IncrementalMISWeights) {
+    Point2i resolution(10, 10);
+    for (const auto &scene : GetScenes()) {
+        Camera camera = CreateTestCamera(resolution);
+        Sampler sampler = new IndependentSampler(1);
+        BDPTIntegrator bdpt(camera, sampler, scene.aggregate, scene.lights, 6, false,
+                            false);
+        ScratchBuffer scratchBuffer;
+        for (int i = 0; i < 1000; ++i) {
+            // Sample a camera ray and compare the MIS weights of its strategies
+            Point2i pPixel(i % resolution.x, (i / resolution.x) % resolution.y);
+            sampler.StartPixelSample(pPixel, i);
+            SampledWavelengths lambda =
+                SampledWavelengths::SampleVisible(sampler.Get1D());
+            CameraSample cameraSample;
+            cameraSample.pFilm = Point2f(pPixel) + Vector2f(sampler.Get2D());
+            cameraSample.pLens = sampler.Get2D();
+            pstd::optional<CameraRayDifferential> cameraRay =
+                camera.GenerateRayDifferential(cameraSample, lambda);
+            ASSERT_TRUE(cameraRay.has_value());
+
+            Float error = bdpt.IncrementalMISWeightError(cameraRay->ray, lambda, sampler,
+                                                         scratchBuffer);
+            EXPECT_LT(error, 1e-4f) << scene.description << ", sample " << i;
+            scratchBuffer.Reset();
+        }
+    }
+}
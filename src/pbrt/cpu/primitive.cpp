@@ -16,6 +16,9 @@
 
 namespace pbrt {
 
+STAT_COUNTER("Geometry/Lazy primitives", nLazyPrimitives);
+STAT_COUNTER("Geometry/Lazy primitives created", nLazyPrimitivesCreated);
+
 Bounds3f Primitive::Bounds() const {
     auto bounds = [&](auto ptr) { return ptr->Bounds(); };
     return DispatchCPU(bounds);
@@ -157,4 +160,37 @@ bool AnimatedPrimitive::IntersectP(const Ray &r, Float tMax) const {
     return primitive.IntersectP(ray, tMax);
 }
 
+// LazyPrimitive Method Definitions
+LazyPrimitive::LazyPrimitive(const Bounds3f &bounds, std::function<Primitive()> create)
+    : bounds(bounds), create(std::move(create)) {
+    ++nLazyPrimitives;
+    primitiveMemory += sizeof(*this);
+}
+
+Primitive LazyPrimitive::GetPrimitive() const {
+    std::call_once(createOnce, [this]() {
+        primitive = create();
+        // Release anything the creation function was holding on to.
+        create = nullptr;
+        ++nLazyPrimitivesCreated;
+    });
+    return primitive;
+}
+
+pstd::optional<ShapeIntersection> LazyPrimitive::Intersect(const Ray &r,
+                                                           Float tMax) const {
+    // Only create the underlying primitive once a ray reaches its bounds
+    if (!bounds.IntersectP(r.o, r.d, tMax))
+        return {};
+    Primitive p = GetPrimitive();
+    return p ? p.Intersect(r, tMax) : pstd::optional<ShapeIntersection>{};
+}
+
+bool LazyPrimitive::IntersectP(const Ray &r, Float tMax) const {
+    if (!bounds.IntersectP(r.o, r.d, tMax))
+        return false;
+    Primitive p = GetPrimitive();
+    return p && p.IntersectP(r, tMax);
+}
+
 }  // namespace pbrt
@@ -16,7 +16,9 @@
 #include <pbrt/util/taggedptr.h>
 #include <pbrt/util/transform.h>
 
+#include <functional>
 #include <memory>
+#include <mutex>
 
 namespace pbrt {
 
@@ -26,13 +28,15 @@ class SimplePrimitive;
 class GeometricPrimitive;
 class TransformedPrimitive;
 class AnimatedPrimitive;
+class LazyPrimitive;
 class BVHAggregate;
 class KdTreeAggregate;
 
 // Primitive Definition
 class Primitive
     : public TaggedPointer<SimplePrimitive, GeometricPrimitive, TransformedPrimitive,
-                           AnimatedPrimitive, BVHAggregate, KdTreeAggregate> {
+                           AnimatedPrimitive, LazyPrimitive, BVHAggregate,
+                           KdTreeAggregate> {
   public:
     // Primitive Interface
     using TaggedPointer::TaggedPointer;
@@ -117,6 +121,27 @@ class AnimatedPrimitive {
     AnimatedTransform renderFromPrimitive;
 };
 
+// LazyPrimitive Definition
+class LazyPrimitive {
+  public:
+    // LazyPrimitive Public Methods
+    LazyPrimitive(const Bounds3f &bounds, std::function<Primitive()> create);
+
+    Bounds3f Bounds() const { return bounds; }
+    pstd::optional<ShapeIntersection> Intersect(const Ray &r, Float tMax) const;
+    bool IntersectP(const Ray &r, Float tMax) const;
+
+  private:
+    // LazyPrimitive Private Methods
+    Primitive GetPrimitive() const;
+
+    // LazyPrimitive Private Members
+    Bounds3f bounds;
+    mutable std::function<Primitive()> create;
+    mutable std::once_flag createOnce;
+    mutable Primitive primitive;
+};
+
 }  // namespace pbrt
 
 #endif  // PBRT_CPU_PRIMITIVE_H
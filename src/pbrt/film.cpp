@@ -1038,6 +1038,10 @@ SpectralFilm *SpectralFilm::Create(const ParameterDictionary &parameters,
                                    Float exposureTime, Filter filter,
                                    const RGBColorSpace *colorSpace, const FileLoc *loc,
                                    Allocator alloc) {
+#ifdef PBRT_RGB_RENDERING
+    ErrorExit(loc, "The SpectralFilm is unavailable when pbrt is built with "
+                   "PBRT_RGB_RENDERING.");
+#endif
     PixelSensor *sensor =
         PixelSensor::Create(parameters, colorSpace, exposureTime, loc, alloc);
     FilmBaseParameters filmBaseParameters(parameters, filter, sensor, loc);
@@ -75,6 +75,24 @@ class PixelSensor {
         if (!m)
             ErrorExit("Sensor XYZ from RGB matrix could not be solved.");
         XYZFromSensorRGB = *m;
+
+#ifdef PBRT_RGB_RENDERING
+        // Fit the sensor's response to radiance in the sRGB rendering color space
+        Float renderRGB[nSwatchReflectances][3];
+        for (int i = 0; i < nSwatchReflectances; ++i) {
+            XYZ xyz = ProjectReflectance<XYZ>(swatchReflectances[i], sensorIllum,
+                                              &Spectra::X(), &Spectra::Y(),
+                                              &Spectra::Z());
+            RGB rgb = RGBColorSpace::sRGB->ToRGB(xyz) * (sensorWhiteY / sensorWhiteG);
+            for (int c = 0; c < 3; ++c)
+                renderRGB[i][c] = rgb[c];
+        }
+        pstd::optional<SquareMatrix<3>> sm =
+            LinearLeastSquares(renderRGB, rgbCamera, nSwatchReflectances);
+        if (!sm)
+            ErrorExit("Sensor RGB from rendering RGB matrix could not be solved.");
+        sensorRGBFromRGB = *sm;
+#endif
     }
 
     PixelSensor(const RGBColorSpace *outputColorSpace, Spectrum sensorIllum,
@@ -89,14 +107,25 @@ class PixelSensor {
             Point2f targetWhite = outputColorSpace->w;
             XYZFromSensorRGB = WhiteBalance(sourceWhite, targetWhite);
         }
+#ifdef PBRT_RGB_RENDERING
+        // The sensor responds with the $XYZ$ of the rendering RGB
+        sensorRGBFromRGB = RGBColorSpace::sRGB->XYZFromRGB;
+#endif
     }
 
     PBRT_CPU_GPU
     RGB ToSensorRGB(SampledSpectrum L, const SampledWavelengths &lambda) const {
+#ifdef PBRT_RGB_RENDERING
+        // Apply the sensor's response to RGB radiance; as in the spectral
+        // case, it integrates unnormalized matching functions
+        RGB rgb = imagingRatio * CIE_Y_integral * RGB(L[0], L[1], L[2]);
+        return sensorRGBFromRGB * rgb;
+#else
         L = SafeDiv(L, lambda.PDF());
         return imagingRatio * RGB((r_bar.Sample(lambda) * L).Average(),
                                   (g_bar.Sample(lambda) * L).Average(),
                                   (b_bar.Sample(lambda) * L).Average());
+#endif
     }
 
     // PixelSensor Public Members
@@ -111,6 +140,9 @@ class PixelSensor {
     // PixelSensor Private Members
     DenselySampledSpectrum r_bar, g_bar, b_bar;
     Float imagingRatio;
+#ifdef PBRT_RGB_RENDERING
+    SquareMatrix<3> sensorRGBFromRGB;
+#endif
     static constexpr int nSwatchReflectances = 24;
     static Spectrum swatchReflectances[nSwatchReflectances];
 };
@@ -12,6 +12,7 @@
 #ifdef PBRT_BUILD_GPU_RENDERER
 #include <pbrt/gpu/memory.h>
 #endif  // PBRT_BUILD_GPU_RENDERER
+#include <pbrt/options.h>
 #include <pbrt/paramdict.h>
 #include <pbrt/samplers.h>
 #include <pbrt/shapes.h>
@@ -21,6 +22,7 @@
 #include <pbrt/util/error.h>
 #include <pbrt/util/file.h>
 #include <pbrt/util/float.h>
+#include <pbrt/util/hash.h>
 #include <pbrt/util/math.h>
 #include <pbrt/util/memory.h>
 #include <pbrt/util/parallel.h>
@@ -30,6 +32,7 @@
 #include <pbrt/util/stats.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <mutex>
 
 namespace pbrt {
@@ -1003,6 +1006,81 @@ std::string UniformInfiniteLight::ToString() const {
     return StringPrintf("[ UniformInfiniteLight %s Lemit: %s ]", BaseToString(), Lemit);
 }
 
+// Light Sampling Distribution Cache Functions
+// Cache files hold a header with _DistributionCacheMagic_ and the cache key,
+// followed by each distribution's node count and node values.
+static constexpr uint64_t DistributionCacheMagic = 0x7473696474726270;
+static constexpr uint32_t DistributionCacheVersion = 1;
+
+static uint64_t HashImage(const Image &image) {
+    // Hash image pixels in parallel chunks and then hash the chunk hashes
+    const uint8_t *pixels = (const uint8_t *)image.RawPointer({0, 0});
+    size_t size = image.BytesUsed();
+    constexpr size_t chunkSize = 1 << 20;
+    std::vector<uint64_t> chunkHashes((size + chunkSize - 1) / chunkSize);
+    ParallelFor(0, chunkHashes.size(), [&](int64_t i) {
+        size_t start = i * chunkSize;
+        chunkHashes[i] = HashBuffer(pixels + start, std::min(chunkSize, size - start));
+    });
+    return Hash(HashBuffer(chunkHashes.data(), chunkHashes.size() * sizeof(uint64_t)),
+                image.Resolution(), image.Format(), image.NChannels());
+}
+
+static std::string DistributionCacheFilename(uint64_t key) {
+    return Options->cacheDirectory + "/" + StringPrintf("%016x.pbrtdist", key);
+}
+
+static bool ReadCachedDistributions(uint64_t key,
+                                    std::initializer_list<pstd::span<Float>> nodes) {
+    std::string filename = DistributionCacheFilename(key);
+    FILE *f = FOpenRead(filename);
+    if (!f)
+        return false;
+
+    uint64_t header[2];
+    bool ok = fread(header, sizeof(header), 1, f) == 1 &&
+              header[0] == DistributionCacheMagic && header[1] == key;
+    for (pstd::span<Float> n : nodes) {
+        uint64_t count;
+        ok = ok && fread(&count, sizeof(count), 1, f) == 1 && count == n.size() &&
+             fread(n.data(), sizeof(Float), n.size(), f) == n.size();
+    }
+    fclose(f);
+
+    if (ok)
+        LOG_VERBOSE("%s: read cached light sampling distributions", filename);
+    else
+        Warning("%s: ignoring invalid cached light sampling distributions.", filename);
+    return ok;
+}
+
+static void WriteCachedDistributions(
+    uint64_t key, std::initializer_list<pstd::span<const Float>> nodes) {
+    // Write to a temporary file that is renamed once complete so that
+    // concurrent runs never see a partially written cache file
+    std::string filename = DistributionCacheFilename(key);
+    std::string tempFilename = UniqueTemporaryFilename(filename);
+    FILE *f = FOpenWrite(tempFilename);
+    if (!f) {
+        Warning("%s: %s", tempFilename, ErrorString());
+        return;
+    }
+    uint64_t header[2] = {DistributionCacheMagic, key};
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+    for (pstd::span<const Float> n : nodes) {
+        uint64_t count = n.size();
+        ok = ok && fwrite(&count, sizeof(count), 1, f) == 1 &&
+             fwrite(n.data(), sizeof(Float), n.size(), f) == n.size();
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        Warning("%s: unable to write light sampling distribution cache: %s", filename,
+                ErrorString());
+        std::remove(tempFilename.c_str());
+    }
+}
+
 // ImageInfiniteLight Method Definitions
 ImageInfiniteLight::ImageInfiniteLight(Transform renderFromLight, Image im,
                                        const RGBColorSpace *imageColorSpace, Float scale,
@@ -1026,9 +1104,23 @@ ImageInfiniteLight::ImageInfiniteLight(Transform renderFromLight, Image im,
         ErrorExit("%s: image resolution (%d, %d) is non-square. It's unlikely "
                   "this is an equal area environment map.",
                   filename, image.Resolution().x, image.Resolution().y);
+    // Use sampling distributions cached by a previous run, if available
+    uint64_t cacheKey = 0;
+    if (!Options->cacheDirectory.empty()) {
+        cacheKey = Hash(HashImage(image), sizeof(Float), DistributionCacheVersion);
+        size_t nNodes = Hierarchical2DWarp::NodeCount(image.Resolution());
+        pstd::vector<Float> nodes(nNodes, alloc), compensatedNodes(nNodes, alloc);
+        if (ReadCachedDistributions(cacheKey, {pstd::span<Float>(nodes),
+                                               pstd::span<Float>(compensatedNodes)})) {
+            distribution = Hierarchical2DWarp(image.Resolution(), std::move(nodes));
+            compensatedDistribution =
+                Hierarchical2DWarp(image.Resolution(), std::move(compensatedNodes));
+            return;
+        }
+    }
+
     Array2D<Float> d = image.GetSamplingDistribution();
-    Bounds2f domain = Bounds2f(Point2f(0, 0), Point2f(1, 1));
-    distribution = PiecewiseConstant2D(d, domain, alloc);
+    distribution = Hierarchical2DWarp(d, alloc);
 
     // Initialize compensated PDF for image infinite area light
     Float average = std::accumulate(d.begin(), d.end(), 0.) / d.size();
@@ -1036,7 +1128,11 @@ ImageInfiniteLight::ImageInfiniteLight(Transform renderFromLight, Image im,
         v = std::max<Float>(v - average, 0);
     if (std::all_of(d.begin(), d.end(), [](Float v) { return v == 0; }))
         std::fill(d.begin(), d.end(), Float(1));
-    compensatedDistribution = PiecewiseConstant2D(d, domain, alloc);
+    compensatedDistribution = Hierarchical2DWarp(d, alloc);
+
+    if (cacheKey)
+        WriteCachedDistributions(
+            cacheKey, {distribution.Nodes(), compensatedDistribution.Nodes()});
 }
 
 PBRT_CPU_GPU Float ImageInfiniteLight::PDF_Li(LightSampleContext ctx, Vector3f w,
@@ -1076,7 +1172,7 @@ PBRT_CPU_GPU pstd::optional<LightLeSample> ImageInfiniteLight::SampleLe(Point2f
     // Sample infinite light image and compute ray direction _w_
     Float mapPDF;
     pstd::optional<Point2f> uv = distribution.Sample(u1, &mapPDF);
-    if (!uv)
+    if (mapPDF == 0)
         return {};
     Vector3f wLight = EqualAreaSquareToSphere(*uv);
     Vector3f w = -renderFromLight(wLight);
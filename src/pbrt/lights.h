@@ -623,8 +623,8 @@ class ImageInfiniteLight : public LightBase {
     Float scale;
     Point3f sceneCenter;
     Float sceneRadius;
-    PiecewiseConstant2D distribution;
-    PiecewiseConstant2D compensatedDistribution;
+    Hierarchical2DWarp distribution;
+    Hierarchical2DWarp compensatedDistribution;
 };
 
 // PortalImageInfiniteLight Definition
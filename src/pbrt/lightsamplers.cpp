@@ -12,6 +12,7 @@
 #include <pbrt/util/lowdiscrepancy.h>
 #include <pbrt/util/math.h>
 #include <pbrt/util/memory.h>
+#include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/sampling.h>
 #include <pbrt/util/spectrum.h>
@@ -105,6 +106,25 @@ std::string PowerLightSampler::ToString() const {
 STAT_MEMORY_COUNTER("Memory/Light BVH", lightBVHBytes);
 STAT_INT_DISTRIBUTION("Integrator/Lights sampled per lookup", nLightsSampled);
 
+// Finds the binary nodes that become the children of the wide node for
+// interior node _index_: its children's children, or the children
+// themselves if they are leaves.
+static int gatherWideChildren(const std::vector<LightBVHNode> &binaryNodes, int index,
+                              int children[WideLightBVHNode::Width]) {
+    DCHECK(!binaryNodes[index].isLeaf);
+    int nChildren = 0;
+    for (int child : {index + 1, int(binaryNodes[index].childOrLightIndex)}) {
+        const LightBVHNode &c = binaryNodes[child];
+        if (c.isLeaf)
+            children[nChildren++] = child;
+        else {
+            children[nChildren++] = child + 1;
+            children[nChildren++] = c.childOrLightIndex;
+        }
+    }
+    return nChildren;
+}
+
 // BVHLightSampler Method Definitions
 BVHLightSampler::BVHLightSampler(pstd::span<const Light> lights, Allocator alloc)
     : lights(lights.begin(), lights.end(), alloc),
@@ -124,17 +144,25 @@ BVHLightSampler::BVHLightSampler(pstd::span<const Light> lights, Allocator alloc
             allLightBounds = Union(allLightBounds, lightBounds->bounds);
         }
     }
-    if (!bvhLights.empty())
-        buildBVH(bvhLights, 0, bvhLights.size(), 0, 0);
-    lightBVHBytes += nodes.size() * sizeof(LightBVHNode) +
-                     lightToBitTrail.capacity() * sizeof(uint32_t) +
+    if (!bvhLights.empty()) {
+        // Build binary light BVH and convert it to a 4-wide BVH
+        std::vector<LightBVHNode> binaryNodes;
+        buildBVH(bvhLights, 0, bvhLights.size(), 0, binaryNodes);
+        int rootChildren[WideLightBVHNode::Width], nRootChildren = 1;
+        rootChildren[0] = 0;
+        if (!binaryNodes[0].isLeaf)
+            nRootChildren = gatherWideChildren(binaryNodes, 0, rootChildren);
+        buildWideBVH(binaryNodes, pstd::MakeConstSpan(rootChildren, nRootChildren), 0, 0);
+    }
+    lightBVHBytes += nodes.size() * sizeof(WideLightBVHNode) +
+                     lightToBitTrail.capacity() * sizeof(uint64_t) +
                      lights.size() * sizeof(Light) +
                      infiniteLights.size() * sizeof(Light);
 }
 
 std::pair<int, LightBounds> BVHLightSampler::buildBVH(
     std::vector<std::pair<int, LightBounds>> &bvhLights, int start, int end,
-    uint32_t bitTrail, int depth) {
+    int depth, std::vector<LightBVHNode> &nodes) {
     DCHECK_LT(start, end);
     // Initialize leaf node if only a single light remains
     if (end - start == 1) {
@@ -142,7 +170,6 @@ std::pair<int, LightBounds> BVHLightSampler::buildBVH(
         CompactLightBounds cb(bvhLights[start].second, allLightBounds);
         int lightIndex = bvhLights[start].first;
         nodes.push_back(LightBVHNode::MakeLeaf(lightIndex, cb));
-        lightToBitTrail.Insert(lights[lightIndex], bitTrail);
         return {nodeIndex, bvhLights[start].second};
     }
 
@@ -225,10 +252,9 @@ std::pair<int, LightBounds> BVHLightSampler::buildBVH(
     nodes.push_back(LightBVHNode());
     CHECK_LT(depth, 64);
     std::pair<int, LightBounds> child0 =
-        buildBVH(bvhLights, start, mid, bitTrail, depth + 1);
+        buildBVH(bvhLights, start, mid, depth + 1, nodes);
     DCHECK_EQ(nodeIndex + 1, child0.first);
-    std::pair<int, LightBounds> child1 =
-        buildBVH(bvhLights, mid, end, bitTrail | (1u << depth), depth + 1);
+    std::pair<int, LightBounds> child1 = buildBVH(bvhLights, mid, end, depth + 1, nodes);
 
     // Initialize interior node and return node index and bounds
     LightBounds lb = Union(child0.second, child1.second);
@@ -237,16 +263,197 @@ std::pair<int, LightBounds> BVHLightSampler::buildBVH(
     return {nodeIndex, lb};
 }
 
+int BVHLightSampler::buildWideBVH(const std::vector<LightBVHNode> &binaryNodes,
+                                  pstd::span<const int> binaryIndices,
+                                  uint64_t bitTrail, int depth) {
+    // Each wide node holds the given binary nodes; since the wide nodes for
+    // interior nodes are made from their grandchildren, the wide BVH is
+    // half as deep as the binary one.
+    CHECK_LE(binaryIndices.size(), WideLightBVHNode::Width);
+    CHECK_LT(depth, 32);
+    int nodeIndex = nodes.size();
+    nodes.push_back(WideLightBVHNode());
+    WideLightBVHNode wideNode = {};
+    for (size_t i = 0; i < binaryIndices.size(); ++i) {
+        // Initialize child _i_ of the wide node from its binary node
+        const LightBVHNode &node = binaryNodes[binaryIndices[i]];
+        const CompactLightBounds &cb = node.lightBounds;
+        Vector3f w = cb.W();
+        wideNode.phi[i] = cb.Phi();
+        wideNode.wx[i] = w.x;
+        wideNode.wy[i] = w.y;
+        wideNode.wz[i] = w.z;
+        for (int j = 0; j < 2; ++j)
+            for (int c = 0; c < 3; ++c)
+                wideNode.qb[j][c][i] = cb.QuantizedBounds(j, c);
+        wideNode.qCosTheta_o[i] = cb.QuantizedCosTheta_o();
+        wideNode.qCosTheta_e[i] = cb.QuantizedCosTheta_e();
+        if (cb.TwoSided())
+            wideNode.twoSidedMask |= 1u << i;
+
+        uint64_t childBitTrail = bitTrail | (uint64_t(i) << (2 * depth));
+        if (node.isLeaf) {
+            wideNode.leafMask |= 1u << i;
+            wideNode.childOrLightIndex[i] = node.childOrLightIndex;
+            lightToBitTrail.Insert(lights[node.childOrLightIndex], childBitTrail);
+        } else {
+            int children[WideLightBVHNode::Width];
+            int nChildren = gatherWideChildren(binaryNodes, binaryIndices[i], children);
+            wideNode.childOrLightIndex[i] =
+                buildWideBVH(binaryNodes, pstd::MakeConstSpan(children, nChildren),
+                             childBitTrail, depth + 1);
+        }
+    }
+    nodes[nodeIndex] = wideNode;
+    return nodeIndex;
+}
+
+int BVHLightSampler::VisibilitySlotsForLight(Light light, int slots[3]) const {
+    if (!lightToBitTrail.HasKey(light))
+        return 0;
+    // Follow _light_'s bit trail through the nodes that have visibility factors
+    uint64_t bitTrail = lightToBitTrail[light];
+    int nodeIndex = 0, visibilityNode = 0, nSlots = 0;
+    while (visibilityNode < VisibilityNodes) {
+        int child = bitTrail & (WideLightBVHNode::Width - 1);
+        slots[nSlots++] = WideLightBVHNode::Width * visibilityNode + child;
+        const WideLightBVHNode &node = nodes[nodeIndex];
+        if (node.IsLeaf(child))
+            break;
+        nodeIndex = node.childOrLightIndex[child];
+        visibilityNode = WideLightBVHNode::Width * visibilityNode + 1 + child;
+        bitTrail >>= 2;
+    }
+    return nSlots;
+}
+
 std::string BVHLightSampler::ToString() const {
     return StringPrintf("[ BVHLightSampler nodes: %s ]", nodes);
 }
 
+std::string WideLightBVHNode::ToString() const {
+    return StringPrintf("[ WideLightBVHNode phi: %s childOrLightIndex: %s leafMask: %d "
+                        "twoSidedMask: %d ]",
+                        pstd::MakeConstSpan(phi, Width),
+                        pstd::MakeConstSpan(childOrLightIndex, Width), leafMask,
+                        twoSidedMask);
+}
+
 std::string LightBVHNode::ToString() const {
     return StringPrintf(
         "[ LightBVHNode lightBounds: %s childOrLightIndex: %d isLeaf: %d ]", lightBounds,
         childOrLightIndex, isLeaf);
 }
 
+// LightVisibilityCache Constants
+// Regions are grid cells, _VisibilityCacheResolution_ of them along the
+// scene's largest extent, further split by the dominant axis of the
+// surface normal.  Visibility estimates are only used once a node's lights
+// have been tested _MinVisibilityTests_ times from a region and are
+// clamped to _MinVisibility_ so that no light's probability goes to zero.
+static constexpr Float VisibilityCacheResolution = 64;
+static constexpr size_t VisibilityCacheRegions = 1 << 15;
+static constexpr int VisibilityCacheMaxProbes = 8;
+static constexpr uint32_t MinVisibilityTests = 16;
+static constexpr Float MinVisibility = 0.05f;
+
+STAT_MEMORY_COUNTER("Memory/Light visibility cache", visibilityCacheBytes);
+STAT_PERCENT("Integrator/Occluded light samples", nOccludedLightSamples,
+             nLightVisibilityTests);
+
+// LightVisibilityCache Method Definitions
+LightVisibilityCache::LightVisibilityCache(const BVHLightSampler *lightSampler,
+                                           const Bounds3f &sceneBounds)
+    : lightSampler(lightSampler),
+      pMin(sceneBounds.pMin),
+      nRegions(VisibilityCacheRegions),
+      regions(new Region[VisibilityCacheRegions]) {
+    Float extent = MaxComponentValue(sceneBounds.Diagonal());
+    invCellSize = extent > 0 ? VisibilityCacheResolution / extent : 1;
+
+    for (size_t i = 0; i < nRegions; ++i)
+        for (int j = 0; j < Slots; ++j) {
+            regions[i].nUnoccluded[j] = regions[i].nTested[j] = 0;
+            regions[i].visibility[j] = 1;
+        }
+    visibilityCacheBytes += nRegions * sizeof(Region);
+}
+
+uint64_t LightVisibilityCache::RegionKey(const LightSampleContext &ctx) const {
+    // Find the grid cell containing the point and the normal's orientation
+    Vector3f pc = (ctx.p() - pMin) * invCellSize;
+    int orientation = 6;
+    if (ctx.n != Normal3f(0, 0, 0)) {
+        int axis = MaxComponentIndex(Abs(ctx.n));
+        orientation = 2 * axis + (ctx.n[axis] > 0);
+    }
+    uint64_t key = Hash(int(pstd::floor(pc.x)), int(pstd::floor(pc.y)),
+                        int(pstd::floor(pc.z)), orientation);
+    // Zero is reserved for unused regions
+    return key != 0 ? key : 1;
+}
+
+const Float *LightVisibilityCache::Lookup(const LightSampleContext &ctx) const {
+    uint64_t key = RegionKey(ctx);
+    for (int i = 0; i < VisibilityCacheMaxProbes; ++i) {
+        const Region &region = regions[(key + i) % nRegions];
+        uint64_t regionKey = region.key.load(std::memory_order_relaxed);
+        if (regionKey == key)
+            return region.visibility;
+        if (regionKey == 0)
+            return nullptr;
+    }
+    return nullptr;
+}
+
+void LightVisibilityCache::Record(const LightSampleContext &ctx, Light light,
+                                  bool unoccluded) const {
+    ++nLightVisibilityTests;
+    if (!unoccluded)
+        ++nOccludedLightSamples;
+    int slots[3];
+    int nSlots = lightSampler->VisibilitySlotsForLight(light, slots);
+    if (nSlots == 0)
+        return;
+
+    // Find or claim the region for _ctx_ and update its visibility counts
+    uint64_t key = RegionKey(ctx);
+    for (int i = 0; i < VisibilityCacheMaxProbes; ++i) {
+        Region &region = regions[(key + i) % nRegions];
+        uint64_t regionKey = region.key.load(std::memory_order_relaxed);
+        if (regionKey == 0 && region.key.compare_exchange_strong(regionKey, key))
+            regionKey = key;
+        if (regionKey != key)
+            continue;
+        for (int j = 0; j < nSlots; ++j) {
+            region.nTested[slots[j]].fetch_add(1, std::memory_order_relaxed);
+            if (unoccluded)
+                region.nUnoccluded[slots[j]].fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+}
+
+void LightVisibilityCache::Update() {
+    ParallelFor(0, nRegions, [&](int64_t i) {
+        Region &region = regions[i];
+        if (region.key == 0)
+            return;
+        for (int j = 0; j < Slots; ++j) {
+            uint32_t nTested = region.nTested[j], nUnoccluded = region.nUnoccluded[j];
+            if (nTested >= MinVisibilityTests)
+                region.visibility[j] = std::max(
+                    MinVisibility, Float(nUnoccluded + 1) / Float(nTested + 2));
+        }
+    });
+}
+
+std::string LightVisibilityCache::ToString() const {
+    return StringPrintf("[ LightVisibilityCache lightSampler: %s pMin: %s "
+                        "invCellSize: %f nRegions: %d ]",
+                        *lightSampler, pMin, invCellSize, nRegions);
+}
+
 // ExhaustiveLightSampler Method Definitions
 ExhaustiveLightSampler::ExhaustiveLightSampler(pstd::span<const Light> lights,
                                                Allocator alloc)
@@ -17,7 +17,9 @@
 #include <pbrt/util/vecmath.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 
 namespace pbrt {
@@ -126,6 +128,16 @@ class CompactLightBounds {
     PBRT_CPU_GPU
     bool TwoSided() const { return twoSided; }
     PBRT_CPU_GPU
+    Float Phi() const { return phi; }
+    PBRT_CPU_GPU
+    Vector3f W() const { return Vector3f(w); }
+    PBRT_CPU_GPU
+    uint16_t QuantizedBounds(int i, int c) const { return qb[i][c]; }
+    PBRT_CPU_GPU
+    uint16_t QuantizedCosTheta_o() const { return qCosTheta_o; }
+    PBRT_CPU_GPU
+    uint16_t QuantizedCosTheta_e() const { return qCosTheta_e; }
+    PBRT_CPU_GPU
     Float CosTheta_o() const { return 2 * (qCosTheta_o / 32767.f) - 1; }
     PBRT_CPU_GPU
     Float CosTheta_e() const { return 2 * (qCosTheta_e / 32767.f) - 1; }
@@ -256,14 +268,99 @@ struct alignas(32) LightBVHNode {
     };
 };
 
+// WideLightBVHNode Definition
+struct alignas(32) WideLightBVHNode {
+    // WideLightBVHNode Public Methods
+    static constexpr int Width = 4;
+
+    PBRT_CPU_GPU
+    bool IsLeaf(int child) const { return leafMask & (1u << child); }
+
+    // Computes the importance of all children at once.  The child bounds
+    // are stored in SoA layout and each lane's computation is free of
+    // branches so that the loop can be vectorized.
+    PBRT_CPU_GPU
+    void Importance(Point3f p, Normal3f n, const Bounds3f &allb,
+                    Float importance[Width]) const {
+        bool haveNormal = n != Normal3f(0, 0, 0);
+        for (int i = 0; i < Width; ++i) {
+            // Compute child bounds, reference distance, and bounding sphere
+            Point3f pMin(Lerp(qb[0][0][i] / 65535.f, allb.pMin.x, allb.pMax.x),
+                         Lerp(qb[0][1][i] / 65535.f, allb.pMin.y, allb.pMax.y),
+                         Lerp(qb[0][2][i] / 65535.f, allb.pMin.z, allb.pMax.z));
+            Point3f pMax(Lerp(qb[1][0][i] / 65535.f, allb.pMin.x, allb.pMax.x),
+                         Lerp(qb[1][1][i] / 65535.f, allb.pMin.y, allb.pMax.y),
+                         Lerp(qb[1][2][i] / 65535.f, allb.pMin.z, allb.pMax.z));
+            Point3f pc = (pMin + pMax) / 2;
+            Float radius = Length(pMax - pMin) / 2;
+            Float dc2 = DistanceSquared(p, pc);
+            Float d2 = std::max(dc2, radius);
+
+            // Compute sine and cosine of angle to vector _w_
+            Vector3f wi = (p - pc) / std::sqrt(std::max<Float>(dc2, 1e-30f));
+            Float cosTheta_w = wx[i] * wi.x + wy[i] * wi.y + wz[i] * wi.z;
+            cosTheta_w = (twoSidedMask & (1u << i)) ? std::abs(cosTheta_w) : cosTheta_w;
+            Float sinTheta_w = SafeSqrt(1 - Sqr(cosTheta_w));
+
+            // Compute $\cos\,\theta_\roman{\+b}$ for the child's bounding sphere
+            Float cosTheta_b =
+                dc2 < Sqr(radius) ? -1 : SafeSqrt(1 - Sqr(radius) / dc2);
+            Float sinTheta_b = SafeSqrt(1 - Sqr(cosTheta_b));
+
+            // Compute $\cos\,\theta'$ and test against $\cos\,\theta_\roman{e}$
+            Float cosTheta_o = 2 * (qCosTheta_o[i] / 32767.f) - 1;
+            Float cosTheta_e = 2 * (qCosTheta_e[i] / 32767.f) - 1;
+            Float sinTheta_o = SafeSqrt(1 - Sqr(cosTheta_o));
+            bool wInCone = cosTheta_w > cosTheta_o;
+            Float cosTheta_x =
+                wInCone ? 1 : (cosTheta_w * cosTheta_o + sinTheta_w * sinTheta_o);
+            Float sinTheta_x =
+                wInCone ? 0 : (sinTheta_w * cosTheta_o - cosTheta_w * sinTheta_o);
+            Float cosThetap = cosTheta_x > cosTheta_b
+                                  ? 1
+                                  : (cosTheta_x * cosTheta_b + sinTheta_x * sinTheta_b);
+
+            // Account for $\cos\theta_\roman{i}$ at surfaces
+            Float cosTheta_i = std::abs(wi.x * n.x + wi.y * n.y + wi.z * n.z);
+            Float sinTheta_i = SafeSqrt(1 - Sqr(cosTheta_i));
+            Float cosThetap_i = cosTheta_i > cosTheta_b
+                                    ? 1
+                                    : (cosTheta_i * cosTheta_b + sinTheta_i * sinTheta_b);
+            cosThetap_i = haveNormal ? cosThetap_i : 1;
+
+            Float imp = phi[i] * cosThetap * cosThetap_i / d2;
+            importance[i] = (phi[i] > 0 && cosThetap > cosTheta_e && imp > 0) ? imp : 0;
+        }
+    }
+
+    std::string ToString() const;
+
+    // WideLightBVHNode Public Members
+    Float phi[Width];
+    Float wx[Width], wy[Width], wz[Width];
+    uint16_t qb[2][3][Width];
+    uint16_t qCosTheta_o[Width], qCosTheta_e[Width];
+    uint32_t childOrLightIndex[Width];
+    uint8_t leafMask, twoSidedMask;
+};
+
 // BVHLightSampler Definition
 class BVHLightSampler {
   public:
     // BVHLightSampler Public Methods
     BVHLightSampler(pstd::span<const Light> lights, Allocator alloc);
 
+    // Visibility factors that scale the importance of the children of the
+    // nodes in the top three levels of the tree may be provided to
+    // _Sample()_ and _PMF()_.  Nodes are indexed as in a complete 4-wide
+    // tree stored in breadth-first order, so the factor for child _c_ of
+    // node _i_ is at index $4i+c$ and that child's node index is $4i+1+c$.
+    static constexpr int VisibilityNodes = 21;
+    static constexpr int VisibilitySlots = WideLightBVHNode::Width * VisibilityNodes;
+
     PBRT_CPU_GPU
-    pstd::optional<SampledLight> Sample(const LightSampleContext &ctx, Float u) const {
+    pstd::optional<SampledLight> Sample(const LightSampleContext &ctx, Float u,
+                                        const Float *visibility = nullptr) const {
         // Compute infinite light sampling probability _pInfinite_
         Float pInfinite = Float(infiniteLights.size()) /
                           Float(infiniteLights.size() + (nodes.empty() ? 0 : 1));
@@ -284,49 +381,42 @@ class BVHLightSampler {
             Point3f p = ctx.p();
             Normal3f n = ctx.ns;
             u = std::min<Float>((u - pInfinite) / (1 - pInfinite), OneMinusEpsilon);
-            int nodeIndex = 0;
+            int nodeIndex = 0, visibilityNode = 0;
             Float pmf = 1 - pInfinite;
 
             while (true) {
-                // Process light BVH node for light sampling
-                LightBVHNode node = nodes[nodeIndex];
-                if (!node.isLeaf) {
-                    // Compute light BVH child node importances
-                    const LightBVHNode *children[2] = {&nodes[nodeIndex + 1],
-                                                       &nodes[node.childOrLightIndex]};
-                    Float ci[2] = {
-                        children[0]->lightBounds.Importance(p, n, allLightBounds),
-                        children[1]->lightBounds.Importance(p, n, allLightBounds)};
-                    if (ci[0] == 0 && ci[1] == 0)
-                        return {};
-
-                    // Randomly sample light BVH child node
-                    Float nodePMF;
-                    int child = SampleDiscrete(ci, u, &nodePMF, &u);
-                    pmf *= nodePMF;
-                    nodeIndex = (child == 0) ? (nodeIndex + 1) : node.childOrLightIndex;
-
-                } else {
-                    // Confirm light has nonzero importance before returning light sample
-                    if (nodeIndex > 0)
-                        DCHECK_GT(node.lightBounds.Importance(p, n, allLightBounds), 0);
-                    if (nodeIndex > 0 ||
-                        node.lightBounds.Importance(p, n, allLightBounds) > 0)
-                        return SampledLight{lights[node.childOrLightIndex], pmf};
+                // Compute importances of the node's children
+                const WideLightBVHNode &node = nodes[nodeIndex];
+                Float ci[WideLightBVHNode::Width];
+                node.Importance(p, n, allLightBounds, ci);
+                ApplyVisibility(visibility, visibilityNode, ci);
+                bool anyNonzero = false;
+                for (int i = 0; i < WideLightBVHNode::Width; ++i)
+                    anyNonzero |= ci[i] > 0;
+                if (!anyNonzero)
                     return {};
-                }
+
+                // Randomly sample light BVH child node
+                Float nodePMF;
+                int child = SampleDiscrete(ci, u, &nodePMF, &u);
+                pmf *= nodePMF;
+                if (node.IsLeaf(child))
+                    return SampledLight{lights[node.childOrLightIndex[child]], pmf};
+                nodeIndex = node.childOrLightIndex[child];
+                visibilityNode = WideLightBVHNode::Width * visibilityNode + 1 + child;
             }
         }
     }
 
     PBRT_CPU_GPU
-    Float PMF(const LightSampleContext &ctx, Light light) const {
+    Float PMF(const LightSampleContext &ctx, Light light,
+              const Float *visibility = nullptr) const {
         // Handle infinite _light_ PMF computation
         if (!lightToBitTrail.HasKey(light))
             return 1.f / (infiniteLights.size() + (nodes.empty() ? 0 : 1));
 
         // Initialize local variables for BVH traversal for PMF computation
-        uint32_t bitTrail = lightToBitTrail[light];
+        uint64_t bitTrail = lightToBitTrail[light];
         Point3f p = ctx.p();
         Normal3f n = ctx.ns;
         // Compute infinite light sampling probability _pInfinite_
@@ -334,26 +424,30 @@ class BVHLightSampler {
                           Float(infiniteLights.size() + (nodes.empty() ? 0 : 1));
 
         Float pmf = 1 - pInfinite;
-        int nodeIndex = 0;
+        int nodeIndex = 0, visibilityNode = 0;
 
         // Compute light's PMF by walking down tree nodes to the light
         while (true) {
-            const LightBVHNode *node = &nodes[nodeIndex];
-            if (node->isLeaf) {
-                DCHECK_EQ(light, lights[node->childOrLightIndex]);
-                return pmf;
-            }
             // Compute child importances and update PMF for current node
-            const LightBVHNode *child0 = &nodes[nodeIndex + 1];
-            const LightBVHNode *child1 = &nodes[node->childOrLightIndex];
-            Float ci[2] = {child0->lightBounds.Importance(p, n, allLightBounds),
-                           child1->lightBounds.Importance(p, n, allLightBounds)};
-            DCHECK_GT(ci[bitTrail & 1], 0);
-            pmf *= ci[bitTrail & 1] / (ci[0] + ci[1]);
+            const WideLightBVHNode &node = nodes[nodeIndex];
+            Float ci[WideLightBVHNode::Width];
+            node.Importance(p, n, allLightBounds, ci);
+            ApplyVisibility(visibility, visibilityNode, ci);
+            int child = bitTrail & (WideLightBVHNode::Width - 1);
+            DCHECK_GT(ci[child], 0);
+            Float ciSum = 0;
+            for (int i = 0; i < WideLightBVHNode::Width; ++i)
+                ciSum += ci[i];
+            pmf *= ci[child] / ciSum;
 
             // Use _bitTrail_ to find next node index and update its value
-            nodeIndex = (bitTrail & 1) ? node->childOrLightIndex : (nodeIndex + 1);
-            bitTrail >>= 1;
+            if (node.IsLeaf(child)) {
+                DCHECK_EQ(light, lights[node.childOrLightIndex[child]]);
+                return pmf;
+            }
+            nodeIndex = node.childOrLightIndex[child];
+            visibilityNode = WideLightBVHNode::Width * visibilityNode + 1 + child;
+            bitTrail >>= 2;
         }
     }
 
@@ -372,13 +466,25 @@ class BVHLightSampler {
         return 1.f / lights.size();
     }
 
+    int VisibilitySlotsForLight(Light light, int slots[3]) const;
+
     std::string ToString() const;
 
   private:
     // BVHLightSampler Private Methods
+    PBRT_CPU_GPU
+    static void ApplyVisibility(const Float *visibility, int visibilityNode,
+                                Float ci[WideLightBVHNode::Width]) {
+        if (visibility && visibilityNode < VisibilityNodes)
+            for (int i = 0; i < WideLightBVHNode::Width; ++i)
+                ci[i] *= visibility[WideLightBVHNode::Width * visibilityNode + i];
+    }
+
     std::pair<int, LightBounds> buildBVH(
         std::vector<std::pair<int, LightBounds>> &bvhLights, int start, int end,
-        uint32_t bitTrail, int depth);
+        int depth, std::vector<LightBVHNode> &binaryNodes);
+    int buildWideBVH(const std::vector<LightBVHNode> &binaryNodes,
+                     pstd::span<const int> binaryIndices, uint64_t bitTrail, int depth);
 
     Float EvaluateCost(const LightBounds &b, const Bounds3f &bounds, int dim) const {
         // Evaluate direction bounds measure for _LightBounds_
@@ -399,8 +505,54 @@ class BVHLightSampler {
     pstd::vector<Light> lights;
     pstd::vector<Light> infiniteLights;
     Bounds3f allLightBounds;
-    pstd::vector<LightBVHNode> nodes;
-    HashMap<Light, uint32_t> lightToBitTrail;
+    pstd::vector<WideLightBVHNode> nodes;
+    HashMap<Light, uint64_t> lightToBitTrail;
+};
+
+// LightVisibilityCache Definition
+// Learns how often shadow rays to the lights under the top nodes of a
+// _BVHLightSampler_'s tree are unoccluded from each region of space and
+// uses those estimates to bias light selection toward visible lights.
+// Estimates are only updated between rendering waves, so that _Sample()_
+// and _PMF()_ are consistent while a wave is being rendered. Regions are
+// found from the unoffset intersection point, which _Sample()_ takes
+// separately from the (possibly offset) context passed to the light sampler.
+class LightVisibilityCache {
+  public:
+    // LightVisibilityCache Public Methods
+    LightVisibilityCache(const BVHLightSampler *lightSampler, const Bounds3f &sceneBounds);
+
+    pstd::optional<SampledLight> Sample(const LightSampleContext &ctx,
+                                        const LightSampleContext &regionCtx,
+                                        Float u) const {
+        return lightSampler->Sample(ctx, u, Lookup(regionCtx));
+    }
+    Float PMF(const LightSampleContext &ctx, Light light) const {
+        return lightSampler->PMF(ctx, light, Lookup(ctx));
+    }
+
+    void Record(const LightSampleContext &ctx, Light light, bool unoccluded) const;
+    void Update();
+
+    std::string ToString() const;
+
+  private:
+    // LightVisibilityCache Private Methods
+    uint64_t RegionKey(const LightSampleContext &ctx) const;
+    const Float *Lookup(const LightSampleContext &ctx) const;
+
+    // LightVisibilityCache Private Members
+    static constexpr int Slots = BVHLightSampler::VisibilitySlots;
+    struct Region {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint32_t> nUnoccluded[Slots], nTested[Slots];
+        Float visibility[Slots];
+    };
+    const BVHLightSampler *lightSampler;
+    Point3f pMin;
+    Float invCellSize;
+    size_t nRegions;
+    std::unique_ptr<Region[]> regions;
 };
 
 // ExhaustiveLightSampler Definition
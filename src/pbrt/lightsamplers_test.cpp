@@ -295,6 +295,76 @@ TEST(BVHLightSampling, PdfMethod) {
     }
 }
 
+TEST(BVHLightSampling, PdfMethodVisibility) {
+    RNG rng(5251);
+    auto r = [&rng]() { return rng.Uniform<Float>(); };
+
+    std::vector<Light> lights;
+    std::vector<Shape> tris;
+    std::tie(lights, tris) = randomLights(20, Allocator());
+
+    BVHLightSampler distrib(lights, Allocator());
+    Float visibility[BVHLightSampler::VisibilitySlots];
+    for (Float &v : visibility)
+        v = Lerp(r(), 0.05f, 1.f);
+
+    for (int i = 0; i < 100; ++i) {
+        Point3f p{-1 + 3 * r(), -1 + 3 * r(), -1 + 3 * r()};
+        Float u = rng.Uniform<Float>();
+        Interaction intr(Point3fi(p), Normal3f(0, 0, 0), Point2f(0, 0));
+        pstd::optional<SampledLight> sampledLight = distrib.Sample(intr, u, visibility);
+        if (sampledLight)
+            EXPECT_FLOAT_EQ(sampledLight->p,
+                            distrib.PMF(intr, sampledLight->light, visibility));
+    }
+}
+
+TEST(LightVisibilityCache, OccludedLight) {
+    RNG rng(6502);
+    auto r = [&rng]() { return rng.Uniform<Float>(); };
+
+    std::vector<Light> lights;
+    std::vector<Shape> tris;
+    std::tie(lights, tris) = randomLights(20, Allocator());
+
+    BVHLightSampler distrib(lights, Allocator());
+    LightVisibilityCache cache(&distrib, Bounds3f(Point3f(-5, -5, -5), Point3f(5, 5, 5)));
+
+    // Report that a point light is always occluded and all others are visible
+    Interaction intr(Point3fi(Point3f(0.25, 0.5, 0.75)), Normal3f(0, 0, 0),
+                     Point2f(0, 0));
+    Light occluded = lights[1];
+    for (int i = 0; i < 100; ++i)
+        for (Light light : lights)
+            cache.Record(intr, light, light != occluded);
+
+    // Light sampling should not change until the cache is updated
+    EXPECT_EQ(distrib.PMF(intr, occluded), cache.PMF(intr, occluded));
+    cache.Update();
+    EXPECT_LT(cache.PMF(intr, occluded), distrib.PMF(intr, occluded));
+
+    for (int i = 0; i < 100; ++i) {
+        pstd::optional<SampledLight> sampledLight = cache.Sample(intr, intr, r());
+        if (sampledLight)
+            EXPECT_FLOAT_EQ(sampledLight->p, cache.PMF(intr, sampledLight->light));
+    }
+
+    // The region is given by the second context, even if the point used for
+    // light sampling is offset into a neighboring cell.
+    Interaction offset(Point3fi(Point3f(0.4, 0.5, 0.75)), Normal3f(0, 0, 0),
+                       Point2f(0, 0));
+    for (int i = 0; i < 100; ++i) {
+        Float u = r();
+        pstd::optional<SampledLight> sampledLight = cache.Sample(offset, intr, u);
+        pstd::optional<SampledLight> unknownRegion = cache.Sample(offset, offset, u);
+        ASSERT_TRUE(sampledLight && unknownRegion);
+        if (sampledLight->light == occluded)
+            EXPECT_LT(sampledLight->p, distrib.PMF(offset, occluded));
+        if (unknownRegion->light == occluded)
+            EXPECT_FLOAT_EQ(unknownRegion->p, distrib.PMF(offset, occluded));
+    }
+}
+
 TEST(ExhaustiveLightSampling, PdfMethod) {
     RNG rng(5251);
     auto r = [&rng]() { return rng.Uniform<Float>(); };
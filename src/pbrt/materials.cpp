@@ -6,8 +6,12 @@
 
 #include <pbrt/bsdf.h>
 #include <pbrt/bssrdf.h>
+#ifdef PBRT_BUILD_GPU_RENDERER
+#include <pbrt/gpu/memory.h>
+#endif  // PBRT_BUILD_GPU_RENDERER
 #include <pbrt/interaction.h>
 #include <pbrt/media.h>
+#include <pbrt/options.h>
 #include <pbrt/paramdict.h>
 #include <pbrt/textures.h>
 #include <pbrt/util/color.h>
@@ -19,7 +23,11 @@
 #include <pbrt/util/print.h>
 #include <pbrt/util/spectrum.h>
 
+#include <array>
 #include <cmath>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <string>
 
@@ -250,6 +258,47 @@ ConductorMaterial *ConductorMaterial::Create(const TextureParameterDictionary &p
                                                remapRoughness);
 }
 
+// Layered Material Tabulation
+static bool GetConstantValue(FloatTexture tex, Float *value) {
+    if (!tex.Is<FloatConstantTexture>())
+        return false;
+    *value = tex.Cast<FloatConstantTexture>()->Evaluate(TextureEvalContext());
+    return true;
+}
+
+static bool IsZero(SpectrumTexture tex) {
+    if (!tex.Is<SpectrumConstantTexture>())
+        return false;
+    SampledWavelengths lambda = SampledWavelengths::SampleVisible(0.5f);
+    return !tex.Cast<SpectrumConstantTexture>()->Evaluate(TextureEvalContext(), lambda);
+}
+
+// Tables are shared by all layered materials with the same parameters,
+// which are given by the material type followed by its parameter values.
+// Because they outlive any one scene, they are allocated from memory that is
+// never freed rather than with a scene's allocator.
+static const LayeredBxDFTable *LookupLayeredBxDFTable(
+    std::array<Float, 6> key,
+    std::function<const LayeredBxDFTable *(Allocator)> create) {
+    static std::mutex mutex;
+    static std::map<std::array<Float, 6>, const LayeredBxDFTable *> tables;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (auto iter = tables.find(key); iter != tables.end())
+        return iter->second;
+    lock.unlock();
+
+    // Tabulate outside of the lock, since it runs a _ParallelFor()_
+    Allocator alloc;
+#ifdef PBRT_BUILD_GPU_RENDERER
+    if (Options->useGPU)
+        alloc = Allocator(&CUDATrackedMemoryResource::singleton);
+#endif
+    const LayeredBxDFTable *table = create(alloc);
+    lock.lock();
+    // Keep the first table if another thread created one for _key_ meanwhile
+    return tables.insert({key, table}).first->second;
+}
+
 // CoatedDiffuseMaterial Method Definitions
 template <typename TextureEvaluator>
 PBRT_CPU_GPU CoatedDiffuseBxDF CoatedDiffuseMaterial::GetBxDF(TextureEvaluator texEval,
@@ -279,7 +328,7 @@ PBRT_CPU_GPU CoatedDiffuseBxDF CoatedDiffuseMaterial::GetBxDF(TextureEvaluator t
     Float gg = Clamp(texEval(g, ctx), -1, 1);
 
     return CoatedDiffuseBxDF(DielectricBxDF(sampledEta, distrib), DiffuseBxDF(r), thick,
-                             a, gg, maxDepth, nSamples);
+                             a, gg, maxDepth, nSamples, table, r);
 }
 
 // Explicit template instantiation
@@ -337,9 +386,37 @@ CoatedDiffuseMaterial *CoatedDiffuseMaterial::Create(
     FloatTexture displacement = parameters.GetFloatTextureOrNull("displacement", alloc);
     bool remapRoughness = parameters.GetOneBool("remaproughness", true);
 
+    // Tabulate the coated diffuse BSDF if requested and possible
+    const LayeredBxDFTable *table = nullptr;
+    if (parameters.GetOneBool("tabulate", false)) {
+        Float urough, vrough, thick;
+        if (!GetConstantValue(uRoughness, &urough) ||
+            !GetConstantValue(vRoughness, &vrough) || urough != vrough ||
+            !GetConstantValue(thickness, &thick) || !IsZero(albedo) ||
+            !eta.Is<ConstantSpectrum>())
+            Warning(loc, "\"tabulate\" requires constant, isotropic roughness, constant "
+                         "thickness and eta, and zero albedo. Using stochastic "
+                         "evaluation.");
+        else {
+            Float alpha =
+                remapRoughness ? TrowbridgeReitzDistribution::RoughnessToAlpha(urough)
+                               : urough;
+            Float e = eta(550);
+            if (e == 0)
+                e = 1;
+            DielectricBxDF top(e, TrowbridgeReitzDistribution(alpha, alpha));
+            table = LookupLayeredBxDFTable(
+                {0, alpha, e, thick, Float(maxDepth), 0}, [&](Allocator tableAlloc) {
+                    return CoatedDiffuseBxDF::Tabulate(
+                        top, [](const SampledSpectrum &r) { return DiffuseBxDF(r); },
+                        thick, maxDepth, tableAlloc);
+                });
+        }
+    }
+
     return alloc.new_object<CoatedDiffuseMaterial>(
         reflectance, uRoughness, vRoughness, thickness, albedo, g, eta, displacement,
-        normalMap, remapRoughness, maxDepth, nSamples);
+        normalMap, remapRoughness, maxDepth, nSamples, table);
 }
 
 template <typename TextureEvaluator>
@@ -386,9 +463,16 @@ PBRT_CPU_GPU CoatedConductorBxDF CoatedConductorMaterial::GetBxDF(TextureEvaluat
     SampledSpectrum a = Clamp(texEval(albedo, ctx, lambda), 0, 1);
     Float gg = Clamp(texEval(g, ctx), -1, 1);
 
+    // Compute normal-incidence conductor reflectance for tabulated evaluation
+    SampledSpectrum r0(0.f);
+    if (table) {
+        SampledSpectrum one(1.f);
+        r0 = (Sqr(ce - one) + Sqr(ck)) / (Sqr(ce + one) + Sqr(ck));
+    }
+
     return CoatedConductorBxDF(DielectricBxDF(ieta, interfaceDistrib),
                                ConductorBxDF(conductorDistrib, ce, ck), thick, a, gg,
-                               maxDepth, nSamples);
+                               maxDepth, nSamples, table, r0);
 }
 
 template PBRT_CPU_GPU CoatedConductorBxDF CoatedConductorMaterial::GetBxDF(
@@ -480,10 +564,50 @@ CoatedConductorMaterial *CoatedConductorMaterial::Create(
     FloatTexture displacement = parameters.GetFloatTextureOrNull("displacement", alloc);
     bool remapRoughness = parameters.GetOneBool("remaproughness", true);
 
+    // Tabulate the coated conductor BSDF if requested and possible
+    const LayeredBxDFTable *table = nullptr;
+    if (parameters.GetOneBool("tabulate", false)) {
+        Float iurough, ivrough, curough, cvrough, thick;
+        if (!GetConstantValue(interfaceURoughness, &iurough) ||
+            !GetConstantValue(interfaceVRoughness, &ivrough) || iurough != ivrough ||
+            !GetConstantValue(conductorURoughness, &curough) ||
+            !GetConstantValue(conductorVRoughness, &cvrough) || curough != cvrough ||
+            !GetConstantValue(thickness, &thick) || !IsZero(albedo) ||
+            !interfaceEta.Is<ConstantSpectrum>())
+            Warning(loc, "\"tabulate\" requires constant, isotropic roughnesses, "
+                         "constant thickness and interface eta, and zero albedo. Using "
+                         "stochastic evaluation.");
+        else {
+            if (remapRoughness) {
+                iurough = TrowbridgeReitzDistribution::RoughnessToAlpha(iurough);
+                curough = TrowbridgeReitzDistribution::RoughnessToAlpha(curough);
+            }
+            Float e = interfaceEta(550);
+            if (e == 0)
+                e = 1;
+            DielectricBxDF top(e, TrowbridgeReitzDistribution(iurough, iurough));
+            // The table is indexed by the conductor's normal-incidence reflectance
+            // in the coating, which matches the conductor's Fresnel reflectance
+            // closely at the angles that light refracted by the coating reaches.
+            TrowbridgeReitzDistribution conductorDistrib(curough, curough);
+            auto bottom = [conductorDistrib](const SampledSpectrum &r) {
+                SampledSpectrum rc = Clamp(r, 0, .9999);
+                return ConductorBxDF(conductorDistrib, SampledSpectrum(1.f),
+                                     2 * Sqrt(rc) / Sqrt(SampledSpectrum(1) - rc));
+            };
+            table = LookupLayeredBxDFTable(
+                {1, iurough, e, thick, Float(maxDepth), curough},
+                [&](Allocator tableAlloc) {
+                    return CoatedConductorBxDF::Tabulate(top, bottom, thick, maxDepth,
+                                                         tableAlloc);
+                });
+        }
+    }
+
     return alloc.new_object<CoatedConductorMaterial>(
         interfaceURoughness, interfaceVRoughness, thickness, interfaceEta, g, albedo,
         conductorURoughness, conductorVRoughness, conductorEta, k, reflectance,
-        displacement, normalMap, remapRoughness, maxDepth, nSamples);
+        displacement, normalMap, remapRoughness, maxDepth, nSamples, table);
 }
 
 // SubsurfaceMaterial Method Definitions
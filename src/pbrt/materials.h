@@ -560,7 +560,8 @@ class CoatedDiffuseMaterial {
                           FloatTexture vRoughness, FloatTexture thickness,
                           SpectrumTexture albedo, FloatTexture g, Spectrum eta,
                           FloatTexture displacement, Image *normalMap,
-                          bool remapRoughness, int maxDepth, int nSamples)
+                          bool remapRoughness, int maxDepth, int nSamples,
+                          const LayeredBxDFTable *table)
         : displacement(displacement),
           normalMap(normalMap),
           reflectance(reflectance),
@@ -572,7 +573,8 @@ class CoatedDiffuseMaterial {
           eta(eta),
           remapRoughness(remapRoughness),
           maxDepth(maxDepth),
-          nSamples(nSamples) {}
+          nSamples(nSamples),
+          table(table) {}
 
     static const char *Name() { return "CoatedDiffuseMaterial"; }
 
@@ -613,6 +615,7 @@ class CoatedDiffuseMaterial {
     Spectrum eta;
     bool remapRoughness;
     int maxDepth, nSamples;
+    const LayeredBxDFTable *table;
 };
 
 // CoatedConductorMaterial Definition
@@ -629,7 +632,7 @@ class CoatedConductorMaterial {
                             SpectrumTexture conductorEta, SpectrumTexture k,
                             SpectrumTexture reflectance, FloatTexture displacement,
                             Image *normalMap, bool remapRoughness, int maxDepth,
-                            int nSamples)
+                            int nSamples, const LayeredBxDFTable *table)
         : displacement(displacement),
           normalMap(normalMap),
           interfaceURoughness(interfaceURoughness),
@@ -645,7 +648,8 @@ class CoatedConductorMaterial {
           reflectance(reflectance),
           remapRoughness(remapRoughness),
           maxDepth(maxDepth),
-          nSamples(nSamples) {}
+          nSamples(nSamples),
+          table(table) {}
 
     static const char *Name() { return "CoatedConductorMaterial"; }
 
@@ -690,6 +694,7 @@ class CoatedConductorMaterial {
     SpectrumTexture conductorEta, k, reflectance;
     bool remapRoughness;
     int maxDepth, nSamples;
+    const LayeredBxDFTable *table;
 };
 
 // SubsurfaceMaterial Definition
@@ -5,6 +5,7 @@
 #include <pbrt/media.h>
 
 #include <pbrt/interaction.h>
+#include <pbrt/options.h>
 #include <pbrt/paramdict.h>
 #include <pbrt/samplers.h>
 #include <pbrt/textures.h>
@@ -23,6 +24,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 
 namespace pbrt {
 
@@ -41,8 +43,9 @@ std::string PhaseFunction::ToString() const {
 }
 
 std::string RayMajorantSegment::ToString() const {
-    return StringPrintf("[ RayMajorantSegment tMin: %f tMax: %f sigma_maj: %s ]", tMin,
-                        tMax, sigma_maj);
+    return StringPrintf("[ RayMajorantSegment tMin: %f tMax: %f sigma_maj: %s "
+                        "sigma_min: %s ]",
+                        tMin, tMax, sigma_maj, sigma_min);
 }
 
 std::string RayMajorantIterator::ToString() const {
@@ -59,11 +62,12 @@ std::string DDAMajorantIterator::ToString() const {
     return StringPrintf("[ DDAMajorantIterator tMin: %f tMax: %f sigma_t: %s "
                         "nextCrossingT: [ %f %f %f ] deltaT: [ %f %f %f ] "
                         "step: [ %d %d %d ] voxelLimit: [ %d %d %d ] voxel: [ %d %d %d ] "
-                        "grid: %p ]",
+                        "subOffset: %d finishVoxel: %s subVoxel: [ %d %d %d ] grid: %p ]",
                         tMin, tMax, sigma_t, nextCrossingT[0], nextCrossingT[1],
                         nextCrossingT[2], deltaT[0], deltaT[1], deltaT[2], step[0],
                         step[1], step[2], voxelLimit[0], voxelLimit[1], voxelLimit[2],
-                        voxel[0], voxel[1], voxel[2], grid);
+                        voxel[0], voxel[1], voxel[2], subOffset, finishVoxel,
+                        subVoxel[0], subVoxel[1], subVoxel[2], grid);
 }
 
 // HenyeyGreenstein Method Definitions
@@ -207,6 +211,16 @@ std::string HomogeneousMedium::ToString() const {
 }
 
 STAT_MEMORY_COUNTER("Memory/Volume grids", volumeGridBytes);
+STAT_MEMORY_COUNTER("Memory/Majorant grids", majorantGridBytes);
+
+// Majorant Grid Constants
+// Voxels of the majorant grids of _GridMedium_ and _RGBGridMedium_ may be
+// refined into _GridMajorantSubRes_^3 subvoxels.  _NanoVDBMedium_'s
+// majorant voxels cover the same index space extent as the VDB tree's
+// lower internal nodes and are refined into voxels that match its leaves.
+static constexpr int GridMajorantSubRes = 4;
+static constexpr int NanoVDBLeafRes = 8;
+static constexpr int NanoVDBMajorantSubRes = 16;
 
 // GridMedium Method Definitions
 GridMedium::GridMedium(const Bounds3f &bounds, const Transform &renderFromMedium,
@@ -238,12 +252,10 @@ GridMedium::GridMedium(const Bounds3f &bounds, const Transform &renderFromMedium
     isEmissive = temperatureGrid ? true : (Le_spec.MaxValue() > 0);
 
     // Initialize _majorantGrid_ for _GridMedium_
-    for (int z = 0; z < majorantGrid.res.z; ++z)
-        for (int y = 0; y < majorantGrid.res.y; ++y)
-            for (int x = 0; x < majorantGrid.res.x; ++x) {
-                Bounds3f bounds = majorantGrid.VoxelBounds(x, y, z);
-                majorantGrid.Set(x, y, z, densityGrid.MaxValue(bounds));
-            }
+    majorantGrid.Initialize(GridMajorantSubRes, [&](const Bounds3f &b) {
+        return Interval(densityGrid.MinValue(b), densityGrid.MaxValue(b));
+    });
+    majorantGridBytes += majorantGrid.BytesAllocated();
 }
 
 GridMedium *GridMedium::Create(const ParameterDictionary &parameters,
@@ -362,19 +374,15 @@ RGBGridMedium::RGBGridMedium(const Bounds3f &bounds, const Transform &renderFrom
         volumeGridBytes += LeGrid->BytesAllocated();
 
     // Initialize _majorantGrid_ for _RGBGridMedium_
-    for (int z = 0; z < majorantGrid.res.z; ++z)
-        for (int y = 0; y < majorantGrid.res.y; ++y)
-            for (int x = 0; x < majorantGrid.res.x; ++x) {
-                Bounds3f bounds = majorantGrid.VoxelBounds(x, y, z);
-                // Initialize _majorantGrid_ voxel for RGB $\sigmaa$ and $\sigmas$
-                auto max = [] PBRT_CPU_GPU(RGBUnboundedSpectrum s) {
-                    return s.MaxValue();
-                };
-                Float maxSigma_t =
-                    (sigma_aGrid ? sigma_aGrid->MaxValue(bounds, max) : 1) +
-                    (sigma_sGrid ? sigma_sGrid->MaxValue(bounds, max) : 1);
-                majorantGrid.Set(x, y, z, sigmaScale * maxSigma_t);
-            }
+    majorantGrid.Initialize(GridMajorantSubRes, [&](const Bounds3f &bounds) {
+        // Compute majorant for RGB $\sigmaa$ and $\sigmas$ inside _bounds_
+        auto max = [] PBRT_CPU_GPU(RGBUnboundedSpectrum s) { return s.MaxValue(); };
+        Float maxSigma_t = (sigma_aGrid ? sigma_aGrid->MaxValue(bounds, max) : 1) +
+                           (sigma_sGrid ? sigma_sGrid->MaxValue(bounds, max) : 1);
+        // RGB spectra don't provide a lower bound over wavelengths, so zero is used
+        return Interval(0, sigmaScale * maxSigma_t);
+    });
+    majorantGridBytes += majorantGrid.BytesAllocated();
 }
 
 RGBGridMedium *RGBGridMedium::Create(const ParameterDictionary &parameters,
@@ -508,22 +516,117 @@ static nanovdb::GridHandle<Buffer> readGrid(const std::string &filename,
     return grid;
 }
 
+void WriteMappableNanoVDBGrids(
+    const std::string &filename,
+    const std::vector<nanovdb::GridHandle<NanoVDBBuffer>> &grids) {
+    std::ofstream os(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!os)
+        ErrorExit("%s: %s", filename, ErrorString());
+    try {
+        // Write each grid uncompressed in its own segment
+        for (const nanovdb::GridHandle<NanoVDBBuffer> &grid : grids) {
+            nanovdb::io::Segment segment(nanovdb::io::Codec::NONE);
+            segment.add(grid);
+            nanovdb::io::GridMetaData &meta = segment.meta.back();
+            meta.fileSize = grid.size();
+
+            // Pad the grid's name so that its data starts at an aligned offset
+            // The name is stored with its NUL terminator and read back as a C
+            // string, so readers ignore the additional NULs.
+            uint64_t dataOffset = uint64_t(os.tellp()) + sizeof(nanovdb::io::Header) +
+                                  sizeof(nanovdb::io::MetaData) + meta.nameSize;
+            uint64_t padding = (NANOVDB_DATA_ALIGNMENT -
+                                dataOffset % NANOVDB_DATA_ALIGNMENT) %
+                               NANOVDB_DATA_ALIGNMENT;
+            meta.gridName.append(padding, '\0');
+            meta.nameSize += padding;
+
+            segment.write(os);
+            os.write((const char *)grid.data(), grid.size());
+        }
+    } catch (const std::exception &e) {
+        ErrorExit("nanovdb: %s: %s", filename, e.what());
+    }
+    if (!os.flush())
+        ErrorExit("%s: %s", filename, ErrorString());
+}
+
+nanovdb::GridHandle<NanoVDBBuffer> MapNanoVDBGrid(const std::string &filename,
+                                                  const MappedFile &mappedFile,
+                                                  const std::string &gridName,
+                                                  const FileLoc *loc) {
+    // Find the offset of the grid's data in the file
+    std::ifstream is(filename, std::ios::in | std::ios::binary);
+    nanovdb::io::Segment segment;
+    int64_t gridOffset = -1;
+    uint64_t gridSize = 0;
+    try {
+        while (gridOffset == -1 && segment.read(is)) {
+            // Grid data follows the segment's metadata in order
+            int64_t offset = is.tellg();
+            for (const nanovdb::io::GridMetaData &meta : segment.meta) {
+                if (meta.gridName != gridName) {
+                    offset += meta.fileSize;
+                    continue;
+                }
+                if (meta.codec != nanovdb::io::Codec::NONE) {
+                    Warning(loc,
+                            "%s: \"%s\" grid is compressed and will be read into "
+                            "memory. (Use nanovdb2pbrt --outfile to write an "
+                            "uncompressed file.)",
+                            filename, gridName);
+                    return {};
+                }
+                gridOffset = offset;
+                gridSize = meta.gridSize;
+                break;
+            }
+            is.seekg(offset);
+        }
+    } catch (const std::exception &e) {
+        ErrorExit("nanovdb: %s: %s", filename, e.what());
+    }
+    if (gridOffset == -1 || gridOffset + gridSize > mappedFile.size())
+        return {};
+
+    // NanoVDB requires aligned grids; the mapping itself is page-aligned
+    if (gridOffset % NANOVDB_DATA_ALIGNMENT != 0) {
+        Warning(loc,
+                "%s: \"%s\" grid isn't %d-byte aligned in the file and will be "
+                "read into memory. (Use nanovdb2pbrt --outfile to write an "
+                "aligned file.)",
+                filename, gridName, NANOVDB_DATA_ALIGNMENT);
+        return {};
+    }
+
+    uint8_t *data = (uint8_t *)mappedFile.data() + gridOffset;
+    nanovdb::GridHandle<NanoVDBBuffer> grid(NanoVDBBuffer(data, gridSize));
+    if (!grid.grid<float>())
+        ErrorExit(loc, "%s: \"%s\" isn't a float grid?", filename, gridName);
+    if (!grid.gridMetaData()->isFogVolume() && !grid.gridMetaData()->isUnknown())
+        ErrorExit(loc, "%s: \"%s\" isn't a FogVolume grid?", filename, gridName);
+    LOG_VERBOSE("%s: mapped %d \"%s\" voxels", filename,
+                grid.gridMetaData()->activeVoxelCount(), gridName);
+    return grid;
+}
+
 NanoVDBMedium::NanoVDBMedium(const Transform &renderFromMedium, Spectrum sigma_a,
                              Spectrum sigma_s, Float sigmaScale, Float g,
                              nanovdb::GridHandle<NanoVDBBuffer> dg,
                              nanovdb::GridHandle<NanoVDBBuffer> tg, Float LeScale,
                              Float temperatureOffset, Float temperatureScale,
-                             Allocator alloc)
+                             std::shared_ptr<MappedFile> mappedFile, Allocator alloc)
     : renderFromMedium(renderFromMedium),
       sigma_a_spec(sigma_a, alloc),
       sigma_s_spec(sigma_s, alloc),
       phase(g),
-      majorantGrid(Bounds3f(), {64, 64, 64}, alloc),
+      majorantGrid(Bounds3f(), {1, 1, 1}, alloc),
       densityGrid(std::move(dg)),
       temperatureGrid(std::move(tg)),
       LeScale(LeScale),
       temperatureOffset(temperatureOffset),
-      temperatureScale(temperatureScale) {
+      temperatureScale(temperatureScale),
+      mappedFile(std::move(mappedFile)) {
     densityFloatGrid = densityGrid.grid<float>();
 
     sigma_a_spec.Scale(sigmaScale);
@@ -545,33 +648,33 @@ NanoVDBMedium::NanoVDBMedium(const Transform &renderFromMedium, Spectrum sigma_a
                                    Point3f(bbox.max()[0], bbox.max()[1], bbox.max()[2])));
     }
 
-    majorantGrid.bounds = bounds;
+    // Align majorant grid voxels with the VDB tree's nodes in index space
+    nanovdb::CoordBBox indexBBox = densityFloatGrid->indexBBox();
+    constexpr int voxelExtent = NanoVDBLeafRes * NanoVDBMajorantSubRes;
+    Point3i index0, res;
+    for (int c = 0; c < 3; ++c) {
+        int i0 = indexBBox.min()[c], i1 = indexBBox.max()[c] + 1;
+        // Round the lower bound down to a multiple of _voxelExtent_
+        int i0Voxel =
+            i0 >= 0 ? i0 / voxelExtent : -((voxelExtent - 1 - i0) / voxelExtent);
+        index0[c] = i0Voxel * voxelExtent;
+        res[c] = std::max(1, (i1 - index0[c] + voxelExtent - 1) / voxelExtent);
+    }
+    Bounds3f majorantBounds = bounds;
+    for (int corner = 0; corner < 8; ++corner) {
+        nanovdb::Vec3R pIndex(index0[0] + ((corner & 1) ? res[0] * voxelExtent : 0),
+                              index0[1] + ((corner & 2) ? res[1] * voxelExtent : 0),
+                              index0[2] + ((corner & 4) ? res[2] * voxelExtent : 0));
+        nanovdb::Vec3R p = densityFloatGrid->indexToWorldF(pIndex);
+        majorantBounds = Union(majorantBounds, Point3f(p[0], p[1], p[2]));
+    }
+    majorantGrid = MajorantGrid(majorantBounds, res, alloc);
 
     // Initialize majorantGrid
-#if 0
-    // For debugging: single, medium-wide majorant...
-    majorantGridRes = Point3i(1, 1, 1);
-    Float minDensity, maxDensity;
-    densityFloatGrid->tree().extrema(minDensity, maxDensity);
-    majorantGrid.Set(0, 0, 0, maxDensity);
-#else
     LOG_VERBOSE("Starting nanovdb grid GetMaxDensityGrid()");
-
-    int gridSize = majorantGrid.res.x * majorantGrid.res.y * majorantGrid.res.z;
-    ParallelFor(0, gridSize, [&](size_t index) {
-        // Indices into majorantGrid
-        int x = index % majorantGrid.res.x;
-        int y = (index / majorantGrid.res.x) % majorantGrid.res.y;
-        int z = index / (majorantGrid.res.x * majorantGrid.res.y);
-        CHECK_EQ(index, x + majorantGrid.res.x * (y + majorantGrid.res.y * z));
-
+    majorantGrid.Initialize(NanoVDBMajorantSubRes, [&](const Bounds3f &b) {
         // World (aka medium) space bounds of this max grid cell
-        Bounds3f wb(bounds.Lerp(Point3f(Float(x) / majorantGrid.res.x,
-                                        Float(y) / majorantGrid.res.y,
-                                        Float(z) / majorantGrid.res.z)),
-                    bounds.Lerp(Point3f(Float(x + 1) / majorantGrid.res.x,
-                                        Float(y + 1) / majorantGrid.res.y,
-                                        Float(z + 1) / majorantGrid.res.z)));
+        Bounds3f wb(majorantBounds.Lerp(b.pMin), majorantBounds.Lerp(b.pMax));
 
         // Compute corresponding NanoVDB index-space bounds in floating-point.
         nanovdb::Vec3R i0 = densityFloatGrid->worldToIndexF(
@@ -581,14 +684,13 @@ NanoVDBMedium::NanoVDBMedium(const Transform &renderFromMedium, Spectrum sigma_a
 
         // Now find integer index-space bounds, accounting for both
         // filtering and the overall index bounding box.
-        auto bbox = densityFloatGrid->indexBBox();
         Float delta = 1.f;  // Filter slop
-        int nx0 = std::max(int(i0[0] - delta), bbox.min()[0]);
-        int nx1 = std::min(int(i1[0] + delta), bbox.max()[0]);
-        int ny0 = std::max(int(i0[1] - delta), bbox.min()[1]);
-        int ny1 = std::min(int(i1[1] + delta), bbox.max()[1]);
-        int nz0 = std::max(int(i0[2] - delta), bbox.min()[2]);
-        int nz1 = std::min(int(i1[2] + delta), bbox.max()[2]);
+        int nx0 = std::max(int(pstd::floor(i0[0] - delta)), indexBBox.min()[0]);
+        int nx1 = std::min(int(i1[0] + delta), indexBBox.max()[0]);
+        int ny0 = std::max(int(pstd::floor(i0[1] - delta)), indexBBox.min()[1]);
+        int ny1 = std::min(int(i1[1] + delta), indexBBox.max()[1]);
+        int nz0 = std::max(int(pstd::floor(i0[2] - delta)), indexBBox.min()[2]);
+        int nz1 = std::min(int(i1[2] + delta), indexBBox.max()[2]);
 
         // FIXME: While the following is properly conservative, it can lead
         // to voxels with majorants that are much higher than any actual
@@ -601,22 +703,61 @@ NanoVDBMedium::NanoVDBMedium(const Transform &renderFromMedium, Spectrum sigma_a
         // boundary samples.  The impact of these majorants is not
         // insignificant; they cause a roughly 10% slowdown in practice
         // due to excess null scattering in such voxels.
-        float maxValue = 0;
+        float minValue = Infinity, maxValue = 0;
         auto accessor = densityFloatGrid->getAccessor();
+        // Lookups that filter samples outside the index bounding box
+        // interpolate with the background value there
+        if (int(pstd::floor(i0[0] - delta)) < indexBBox.min()[0] ||
+            int(i1[0] + delta) > indexBBox.max()[0] ||
+            int(pstd::floor(i0[1] - delta)) < indexBBox.min()[1] ||
+            int(i1[1] + delta) > indexBBox.max()[1] ||
+            int(pstd::floor(i0[2] - delta)) < indexBBox.min()[2] ||
+            int(i1[2] + delta) > indexBBox.max()[2]) {
+            nanovdb::Coord pOutside(indexBBox.max()[0] + 1, indexBBox.max()[1] + 1,
+                                    indexBBox.max()[2] + 1);
+            float background = accessor.getValue(pOutside);
+            minValue = background;
+            maxValue = std::max(maxValue, background);
+        }
         // Apparently nanovdb integer bounding boxes are inclusive on
         // the upper end...
         for (int nz = nz0; nz <= nz1; ++nz)
             for (int ny = ny0; ny <= ny1; ++ny)
-                for (int nx = nx0; nx <= nx1; ++nx)
-                    maxValue = std::max(maxValue, accessor.getValue({nx, ny, nz}));
-
-        // Only write into maxGrid once when we're done to minimize
-        // cache thrashing..
-        majorantGrid.Set(x, y, z, maxValue);
+                for (int nx = nx0; nx <= nx1; ++nx) {
+                    float value = accessor.getValue({nx, ny, nz});
+                    minValue = std::min(minValue, value);
+                    maxValue = std::max(maxValue, value);
+                }
+        return Interval(std::min(minValue, maxValue), maxValue);
     });
-
-    LOG_VERBOSE("Finished nanovdb grid GetMaxDensityGrid()");
-#endif
+    majorantGridBytes += majorantGrid.BytesAllocated();
+    LOG_VERBOSE("Finished nanovdb grid GetMaxDensityGrid(): %d bytes",
+                majorantGrid.BytesAllocated());
+
+    if (this->mappedFile) {
+        // Prepare memory-mapped grids for paging in leaf nodes on demand
+        for (const nanovdb::FloatGrid *grid : {densityFloatGrid, temperatureFloatGrid}) {
+            // Grids that couldn't be mapped were read into memory instead
+            const char *start = (const char *)grid;
+            if (!grid || start < this->mappedFile->data() ||
+                start >= this->mappedFile->data() + this->mappedFile->size())
+                continue;
+            const nanovdb::FloatTree &tree = grid->tree();
+            size_t gridOffset = start - this->mappedFile->data();
+            size_t leafOffset =
+                (const char *)tree.getFirstNode<0>() - this->mappedFile->data();
+            size_t leafBytes =
+                size_t(tree.nodeCount(0)) * nanovdb::FloatTree::LeafNodeType::memUsage();
+            // Keep the upper levels of the tree resident
+            this->mappedFile->Advise(gridOffset, leafOffset - gridOffset,
+                                     MappedFile::Access::WillNeed);
+            // Release the leaves read to compute majorants; lookups are
+            // incoherent, so reading ahead of them only wastes memory.
+            this->mappedFile->Advise(leafOffset, leafBytes,
+                                     MappedFile::Access::DontNeed);
+            this->mappedFile->Advise(leafOffset, leafBytes, MappedFile::Access::Random);
+        }
+    }
 }
 
 std::string NanoVDBMedium::ToString() const {
@@ -632,16 +773,35 @@ NanoVDBMedium *NanoVDBMedium::Create(const ParameterDictionary &parameters,
     if (filename.empty())
         ErrorExit(loc, "Must supply \"filename\" to \"nanovdb\" medium.");
 
+    // Memory-map the file if requested so that grids needn't fit in memory
+    std::shared_ptr<MappedFile> mappedFile;
+    if (parameters.GetOneBool("mmap", false)) {
+        if (Options->useGPU)
+            Warning(loc, "\"mmap\" is not supported with the GPU; reading grids "
+                         "into memory.");
+        else if (!(mappedFile = MappedFile::Open(filename)))
+            Warning(loc, "%s: unable to memory-map file; reading grids into memory.",
+                    filename);
+    }
+    auto getGrid = [&](const std::string &gridName) {
+        nanovdb::GridHandle<NanoVDBBuffer> grid;
+        if (mappedFile)
+            grid = MapNanoVDBGrid(filename, *mappedFile, gridName, loc);
+        if (!grid)
+            grid = readGrid<NanoVDBBuffer>(filename, gridName, loc, alloc);
+        return grid;
+    };
+
     nanovdb::GridHandle<NanoVDBBuffer> densityGrid;
     std::string gridname = parameters.GetOneString("gridname", "density");
-    densityGrid = readGrid<NanoVDBBuffer>(filename, gridname, loc, alloc);
+    densityGrid = getGrid(gridname);
     if (!densityGrid)
         ErrorExit(loc, "%s: didn't find \"density\" grid.", filename);
 
     nanovdb::GridHandle<NanoVDBBuffer> temperatureGrid;
     std::string temperaturename =
         parameters.GetOneString("temperaturename", "temperature");
-    temperatureGrid = readGrid<NanoVDBBuffer>(filename, temperaturename, loc, alloc);
+    temperatureGrid = getGrid(temperaturename);
 
     Float LeScale = parameters.GetOneFloat("Lescale", 1.f);
     Float temperatureOffset = parameters.GetOneFloat("temperatureoffset",
@@ -661,7 +821,8 @@ NanoVDBMedium *NanoVDBMedium::Create(const ParameterDictionary &parameters,
 
     return alloc.new_object<NanoVDBMedium>(
         renderFromMedium, sigma_a, sigma_s, sigmaScale, g, std::move(densityGrid),
-        std::move(temperatureGrid), LeScale, temperatureOffset, temperatureScale, alloc);
+        std::move(temperatureGrid), LeScale, temperatureOffset, temperatureScale,
+        std::move(mappedFile), alloc);
 }
 
 Medium Medium::Create(const std::string &name, const ParameterDictionary &parameters,
@@ -13,6 +13,7 @@
 #include <pbrt/textures.h>
 #include <pbrt/util/colorspace.h>
 #include <pbrt/util/error.h>
+#include <pbrt/util/file.h>
 #include <pbrt/util/memory.h>
 #include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
@@ -83,8 +84,9 @@ class HomogeneousMajorantIterator {
     PBRT_CPU_GPU
     HomogeneousMajorantIterator() : called(true) {}
     PBRT_CPU_GPU
-    HomogeneousMajorantIterator(Float tMin, Float tMax, SampledSpectrum sigma_maj)
-        : seg{tMin, tMax, sigma_maj}, called(false) {}
+    HomogeneousMajorantIterator(Float tMin, Float tMax, SampledSpectrum sigma_maj,
+                                SampledSpectrum sigma_min)
+        : seg{tMin, tMax, sigma_maj, sigma_min}, called(false) {}
 
     PBRT_CPU_GPU
     pstd::optional<RayMajorantSegment> Next() {
@@ -102,11 +104,77 @@ class HomogeneousMajorantIterator {
 };
 
 // MajorantGrid Definition
+// Voxels of the grid may be refined into _subRes_^3 finer voxels that bound
+// the density more tightly in regions where it varies; majorants of
+// refined voxels are stored consecutively in _refinedVoxels_, starting at
+// the voxel's entry in _refinedOffsets_. Lower bounds of the density are
+// stored alongside in _minVoxels_ and _refinedMinVoxels_.
 struct MajorantGrid {
     // MajorantGrid Public Methods
     MajorantGrid() = default;
     MajorantGrid(Bounds3f bounds, Point3i res, Allocator alloc)
-        : bounds(bounds), voxels(res.x * res.y * res.z, alloc), res(res) {}
+        : bounds(bounds),
+          voxels(res.x * res.y * res.z, alloc),
+          minVoxels(res.x * res.y * res.z, alloc),
+          res(res),
+          refinedOffsets(alloc),
+          refinedVoxels(alloc),
+          refinedMinVoxels(alloc) {}
+
+    // Computes the density bounds of all voxels given a function that
+    // returns an _Interval_ bounding the density inside bounds specified
+    // in $[0,1]^3$; voxels are refined if refinement reduces their average
+    // majorant by more than a quarter.
+    template <typename F>
+    void Initialize(int sr, F densityBounds) {
+        subRes = sr;
+        int nVoxels = res.x * res.y * res.z, nSubVoxels = subRes * subRes * subRes;
+        std::vector<std::vector<Interval>> subVoxels(nVoxels);
+        std::vector<char> refine(nVoxels, 0);
+        ParallelFor(0, nVoxels, [&](int64_t index) {
+            // Compute majorants of _index_'s subvoxels and decide whether to refine
+            int x = index % res.x, y = (index / res.x) % res.y;
+            int z = index / (res.x * res.y);
+            Point3i sub0(x * subRes, y * subRes, z * subRes);
+            Point3i subGridRes = res * subRes;
+            std::vector<Interval> &v = subVoxels[index];
+            v.resize(nSubVoxels);
+            Float minValue = Infinity, maxValue = 0, sum = 0;
+            for (int sz = 0; sz < subRes; ++sz)
+                for (int sy = 0; sy < subRes; ++sy)
+                    for (int sx = 0; sx < subRes; ++sx) {
+                        Point3i p = sub0 + Vector3i(sx, sy, sz);
+                        Bounds3f b(Point3f(Float(p.x) / subGridRes.x,
+                                           Float(p.y) / subGridRes.y,
+                                           Float(p.z) / subGridRes.z),
+                                   Point3f(Float(p.x + 1) / subGridRes.x,
+                                           Float(p.y + 1) / subGridRes.y,
+                                           Float(p.z + 1) / subGridRes.z));
+                        Interval d = densityBounds(b);
+                        v[sx + subRes * (sy + subRes * sz)] = d;
+                        minValue = std::min(minValue, d.LowerBound());
+                        maxValue = std::max(maxValue, d.UpperBound());
+                        sum += d.UpperBound();
+                    }
+            voxels[index] = maxValue;
+            minVoxels[index] = minValue;
+            refine[index] =
+                subRes > 1 && maxValue > 0 && sum < 0.75f * nSubVoxels * maxValue;
+        });
+
+        // Store majorants of refined voxels
+        refinedOffsets.resize(nVoxels);
+        refinedVoxels.clear();
+        refinedMinVoxels.clear();
+        for (int i = 0; i < nVoxels; ++i) {
+            refinedOffsets[i] = refine[i] ? int(refinedVoxels.size()) : -1;
+            if (refine[i])
+                for (Interval d : subVoxels[i]) {
+                    refinedVoxels.push_back(d.UpperBound());
+                    refinedMinVoxels.push_back(d.LowerBound());
+                }
+        }
+    }
 
     PBRT_CPU_GPU
     Float Lookup(int x, int y, int z) const {
@@ -114,6 +182,11 @@ struct MajorantGrid {
         return voxels[x + res.x * (y + res.y * z)];
     }
     PBRT_CPU_GPU
+    Float LookupMin(int x, int y, int z) const {
+        DCHECK(x >= 0 && x < res.x && y >= 0 && y < res.y && z >= 0 && z < res.z);
+        return minVoxels[x + res.x * (y + res.y * z)];
+    }
+    PBRT_CPU_GPU
     void Set(int x, int y, int z, Float v) {
         DCHECK(x >= 0 && x < res.x && y >= 0 && y < res.y && z >= 0 && z < res.z);
         voxels[x + res.x * (y + res.y * z)] = v;
@@ -126,10 +199,34 @@ struct MajorantGrid {
         return Bounds3f(p0, p1);
     }
 
+    PBRT_CPU_GPU
+    int RefinedOffset(int x, int y, int z) const {
+        return refinedOffsets.empty() ? -1 : refinedOffsets[x + res.x * (y + res.y * z)];
+    }
+    PBRT_CPU_GPU
+    Float LookupRefined(int offset, int x, int y, int z) const {
+        DCHECK(x >= 0 && x < subRes && y >= 0 && y < subRes && z >= 0 && z < subRes);
+        return refinedVoxels[offset + x + subRes * (y + subRes * z)];
+    }
+    PBRT_CPU_GPU
+    Float LookupRefinedMin(int offset, int x, int y, int z) const {
+        DCHECK(x >= 0 && x < subRes && y >= 0 && y < subRes && z >= 0 && z < subRes);
+        return refinedMinVoxels[offset + x + subRes * (y + subRes * z)];
+    }
+
+    size_t BytesAllocated() const {
+        return (voxels.size() + minVoxels.size()) * sizeof(Float) +
+               refinedOffsets.size() * sizeof(int) +
+               (refinedVoxels.size() + refinedMinVoxels.size()) * sizeof(Float);
+    }
+
     // MajorantGrid Public Members
     Bounds3f bounds;
-    pstd::vector<Float> voxels;
+    pstd::vector<Float> voxels, minVoxels;
     Point3i res;
+    int subRes = 1;
+    pstd::vector<int> refinedOffsets;
+    pstd::vector<Float> refinedVoxels, refinedMinVoxels;
 };
 
 // DDAMajorantIterator Definition
@@ -146,6 +243,7 @@ class DDAMajorantIterator {
         Ray rayGrid(Point3f(grid->bounds.Offset(ray.o)),
                     Vector3f(ray.d.x / diag.x, ray.d.y / diag.y, ray.d.z / diag.z));
         Point3f gridIntersect = rayGrid(tMin);
+        rayGridOrigin = rayGrid.o;
         for (int axis = 0; axis < 3; ++axis) {
             // Initialize ray stepping parameters for _axis_
             // Compute current voxel for axis and handle negative zero direction
@@ -154,6 +252,7 @@ class DDAMajorantIterator {
             deltaT[axis] = 1 / (std::abs(rayGrid.d[axis]) * grid->res[axis]);
             if (rayGrid.d[axis] == -0.f)
                 rayGrid.d[axis] = 0.f;
+            rayGridDirection[axis] = rayGrid.d[axis];
 
             if (rayGrid.d[axis] >= 0) {
                 // Handle ray with positive direction for voxel stepping
@@ -176,6 +275,19 @@ class DDAMajorantIterator {
 
     PBRT_CPU_GPU
     pstd::optional<RayMajorantSegment> Next() {
+        // Continue stepping through the current refined voxel, if any
+        if (subOffset >= 0)
+            return NextSubVoxel();
+        if (finishVoxel) {
+            // Cover the rest of a refined voxel whose subvoxel stepping ended
+            // early due to round-off with the voxel's own majorant
+            finishVoxel = false;
+            RayMajorantSegment seg{tMin, tSubVoxelsExit, sigma_t * voxelMaxDensity,
+                                   sigma_t * voxelMinDensity};
+            tMin = tResume;
+            return seg;
+        }
+
         if (tMin >= tMax)
             return {};
         // Find _stepAxis_ for stepping to next voxel and exit point _tVoxelExit_
@@ -187,8 +299,19 @@ class DDAMajorantIterator {
         Float tVoxelExit = std::min(tMax, nextCrossingT[stepAxis]);
 
         // Get _maxDensity_ for current voxel and initialize _RayMajorantSegment_, _seg_
-        SampledSpectrum sigma_maj = sigma_t * grid->Lookup(voxel[0], voxel[1], voxel[2]);
-        RayMajorantSegment seg{tMin, tVoxelExit, sigma_maj};
+        Float maxDensity = grid->Lookup(voxel[0], voxel[1], voxel[2]);
+        Float minDensity = grid->LookupMin(voxel[0], voxel[1], voxel[2]);
+        RayMajorantSegment seg{tMin, tVoxelExit, sigma_t * maxDensity,
+                               sigma_t * minDensity};
+
+        // Start stepping through subvoxels if the current voxel is refined
+        Float tVoxelEnter = tMin;
+        if (int offset = grid->RefinedOffset(voxel[0], voxel[1], voxel[2]);
+            offset >= 0) {
+            StartSubVoxels(offset, tVoxelExit);
+            voxelMaxDensity = maxDensity;
+            voxelMinDensity = minDensity;
+        }
 
         // Advance to next voxel in maximum density grid
         tMin = tVoxelExit;
@@ -199,18 +322,87 @@ class DDAMajorantIterator {
             tMin = tMax;
         nextCrossingT[stepAxis] += deltaT[stepAxis];
 
+        if (subOffset >= 0) {
+            // Return the refined voxel's first segment, resuming at _tMin_ after it
+            tResume = tMin;
+            tMin = tVoxelEnter;
+            return NextSubVoxel();
+        }
         return seg;
     }
 
     std::string ToString() const;
 
   private:
+    // DDAMajorantIterator Private Methods
+    PBRT_CPU_GPU
+    void StartSubVoxels(int offset, Float tVoxelExit) {
+        // Set up 3D DDA through the subvoxels of the current voxel
+        subOffset = offset;
+        tSubVoxelsExit = tVoxelExit;
+        int subRes = grid->subRes;
+        for (int axis = 0; axis < 3; ++axis) {
+            Float p = rayGridOrigin[axis] + tMin * rayGridDirection[axis];
+            Float subVoxelPos = (p * grid->res[axis] - voxel[axis]) * subRes;
+            subVoxel[axis] = Clamp(int(subVoxelPos), 0, subRes - 1);
+            subDeltaT[axis] = deltaT[axis] / subRes;
+            int next = subVoxel[axis] + (step[axis] > 0 ? 1 : 0);
+            Float nextSubVoxelPos =
+                Float(voxel[axis] * subRes + next) / (grid->res[axis] * subRes);
+            subNextCrossingT[axis] =
+                tMin + (nextSubVoxelPos - p) / rayGridDirection[axis];
+        }
+    }
+
+    PBRT_CPU_GPU
+    RayMajorantSegment NextSubVoxel() {
+        // Find axis for stepping to the next subvoxel and its exit point
+        int bits = ((subNextCrossingT[0] < subNextCrossingT[1]) << 2) +
+                   ((subNextCrossingT[0] < subNextCrossingT[2]) << 1) +
+                   ((subNextCrossingT[1] < subNextCrossingT[2]));
+        const int cmpToAxis[8] = {2, 1, 2, 1, 2, 2, 0, 0};
+        int stepAxis = cmpToAxis[bits];
+        Float tSubVoxelExit = std::min(tSubVoxelsExit, subNextCrossingT[stepAxis]);
+
+        Float maxDensity =
+            grid->LookupRefined(subOffset, subVoxel[0], subVoxel[1], subVoxel[2]);
+        Float minDensity =
+            grid->LookupRefinedMin(subOffset, subVoxel[0], subVoxel[1], subVoxel[2]);
+        RayMajorantSegment seg{tMin, tSubVoxelExit, sigma_t * maxDensity,
+                               sigma_t * minDensity};
+
+        // Advance to the next subvoxel or return to stepping through voxels
+        tMin = tSubVoxelExit;
+        subVoxel[stepAxis] += step[stepAxis];
+        subNextCrossingT[stepAxis] += subDeltaT[stepAxis];
+        if (tMin >= tSubVoxelsExit || subVoxel[stepAxis] < 0 ||
+            subVoxel[stepAxis] == grid->subRes) {
+            subOffset = -1;
+            // The subvoxel's majorant doesn't bound the rest of the voxel if
+            // round-off ended stepping early, so finish it in _Next()_
+            if (tMin < tSubVoxelsExit)
+                finishVoxel = true;
+            else
+                tMin = tResume;
+        }
+        return seg;
+    }
+
     // DDAMajorantIterator Private Members
     SampledSpectrum sigma_t;
     Float tMin = Infinity, tMax = -Infinity;
     const MajorantGrid *grid;
     Float nextCrossingT[3], deltaT[3];
     int step[3], voxelLimit[3], voxel[3];
+    Point3f rayGridOrigin;
+    Vector3f rayGridDirection;
+    // Refined voxel stepping state; _subOffset_ is -1 when not in one
+    int subOffset = -1;
+    bool finishVoxel = false;
+    Float tSubVoxelsExit, tResume;
+    Float voxelMaxDensity, voxelMinDensity;
+    Float subNextCrossingT[3], subDeltaT[3];
+    int subVoxel[3];
 };
 
 // HomogeneousMedium Definition
@@ -250,7 +442,8 @@ class HomogeneousMedium {
                                           const SampledWavelengths &lambda) const {
         SampledSpectrum sigma_a = sigma_a_spec.Sample(lambda);
         SampledSpectrum sigma_s = sigma_s_spec.Sample(lambda);
-        return HomogeneousMajorantIterator(0, tMax, sigma_a + sigma_s);
+        SampledSpectrum sigma_t = sigma_a + sigma_s;
+        return HomogeneousMajorantIterator(0, tMax, sigma_t, sigma_t);
     }
 
     std::string ToString() const;
@@ -484,7 +677,7 @@ class CloudMedium {
         SampledSpectrum sigma_a = sigma_a_spec.Sample(lambda);
         SampledSpectrum sigma_s = sigma_s_spec.Sample(lambda);
         SampledSpectrum sigma_t = sigma_a + sigma_s;
-        return HomogeneousMajorantIterator(tMin, tMax, sigma_t);
+        return HomogeneousMajorantIterator(tMin, tMax, sigma_t, SampledSpectrum(0.f));
     }
 
   private:
@@ -539,11 +732,15 @@ class NanoVDBBuffer {
     NanoVDBBuffer() = default;
     NanoVDBBuffer(Allocator alloc) : alloc(alloc) {}
     NanoVDBBuffer(size_t size, Allocator alloc = {}) : alloc(alloc) { init(size); }
+    // Refers to grid data owned elsewhere (e.g., by a memory-mapped file)
+    NanoVDBBuffer(uint8_t *external, size_t size)
+        : bytesAllocated(size), ptr(external), owned(false) {}
     NanoVDBBuffer(const NanoVDBBuffer &) = delete;
     NanoVDBBuffer(NanoVDBBuffer &&other) noexcept
         : alloc(std::move(other.alloc)),
           bytesAllocated(other.bytesAllocated),
-          ptr(other.ptr) {
+          ptr(other.ptr),
+          owned(other.owned) {
         other.bytesAllocated = 0;
         other.ptr = nullptr;
     }
@@ -556,6 +753,7 @@ class NanoVDBBuffer {
         new (&alloc) Allocator(other.alloc.resource());
         bytesAllocated = other.bytesAllocated;
         ptr = other.ptr;
+        owned = other.owned;
         other.bytesAllocated = 0;
         other.ptr = nullptr;
         return *this;
@@ -571,6 +769,7 @@ class NanoVDBBuffer {
             return;
         bytesAllocated = size;
         ptr = (uint8_t *)alloc.allocate_bytes(bytesAllocated, 128);
+        owned = true;
     }
 
     const uint8_t *data() const { return ptr; }
@@ -579,7 +778,8 @@ class NanoVDBBuffer {
     bool empty() const { return size() == 0; }
 
     void clear() {
-        alloc.deallocate_bytes(ptr, bytesAllocated, 128);
+        if (owned)
+            alloc.deallocate_bytes(ptr, bytesAllocated, 128);
         bytesAllocated = 0;
         ptr = nullptr;
     }
@@ -594,8 +794,24 @@ class NanoVDBBuffer {
     Allocator alloc;
     size_t bytesAllocated = 0;
     uint8_t *ptr = nullptr;
+    bool owned = true;
 };
 
+// NanoVDB Function Declarations
+// Writes _grids_ to an uncompressed NanoVDB file with each grid's data
+// aligned so that the file can be memory-mapped.
+void WriteMappableNanoVDBGrids(
+    const std::string &filename,
+    const std::vector<nanovdb::GridHandle<NanoVDBBuffer>> &grids);
+
+// Returns a handle for the named grid that refers to its data in
+// _mappedFile_, or an empty handle if the grid isn't stored uncompressed
+// and aligned in the file.
+nanovdb::GridHandle<NanoVDBBuffer> MapNanoVDBGrid(const std::string &filename,
+                                                  const MappedFile &mappedFile,
+                                                  const std::string &gridName,
+                                                  const FileLoc *loc);
+
 class NanoVDBMedium {
   public:
     using MajorantIterator = DDAMajorantIterator;
@@ -609,7 +825,8 @@ class NanoVDBMedium {
     NanoVDBMedium(const Transform &renderFromMedium, Spectrum sigma_a, Spectrum sigma_s,
                   Float sigmaScale, Float g, nanovdb::GridHandle<NanoVDBBuffer> dg,
                   nanovdb::GridHandle<NanoVDBBuffer> tg, Float LeScale,
-                  Float temperatureOffset, Float temperatureScale, Allocator alloc);
+                  Float temperatureOffset, Float temperatureScale,
+                  std::shared_ptr<MappedFile> mappedFile, Allocator alloc);
 
     PBRT_CPU_GPU
     bool IsEmissive() const { return temperatureFloatGrid && LeScale > 0; }
@@ -676,6 +893,8 @@ class NanoVDBMedium {
     const nanovdb::FloatGrid *densityFloatGrid = nullptr;
     const nanovdb::FloatGrid *temperatureFloatGrid = nullptr;
     Float LeScale, temperatureOffset, temperatureScale;
+    // Non-null if the grids' data is in a memory-mapped file
+    std::shared_ptr<MappedFile> mappedFile;
 };
 
 PBRT_CPU_GPU inline Float PhaseFunction::p(Vector3f wo, Vector3f wi) const {
@@ -799,6 +1018,83 @@ PBRT_CPU_GPU SampledSpectrum SampleT_maj(Ray ray, Float tMax, Float u, RNG &rng,
     return SampledSpectrum(1.f);
 }
 
+// Variant of _SampleT_maj()_ that also tracks transmittance with respect to
+// the residual majorant $\sigma_r = \sigma_\roman{maj} - \sigma_\roman{min}$ of
+// each segment. Both are passed to _callback_ and returned for the final
+// interval, the latter via _T_r_. If _sampleResidual_ is true, points are
+// sampled according to $\sigma_r$ rather than $\sigma_\roman{maj}$ so that
+// no density lookups are needed where the density is known to be constant.
+template <typename F>
+PBRT_CPU_GPU SampledSpectrum SampleT_residual(Ray ray, Float tMax, Float u, RNG &rng,
+                                              const SampledWavelengths &lambda,
+                                              bool sampleResidual, SampledSpectrum *T_r,
+                                              F callback) {
+    auto sample = [&](auto medium) {
+        using M = typename std::remove_reference_t<decltype(*medium)>;
+        return SampleT_residual<M>(ray, tMax, u, rng, lambda, sampleResidual, T_r,
+                                   callback);
+    };
+    return ray.medium.Dispatch(sample);
+}
+
+template <typename ConcreteMedium, typename F>
+PBRT_CPU_GPU SampledSpectrum SampleT_residual(Ray ray, Float tMax, Float u, RNG &rng,
+                                              const SampledWavelengths &lambda,
+                                              bool sampleResidual, SampledSpectrum *T_r,
+                                              F callback) {
+    // Normalize ray direction and update _tMax_ accordingly
+    tMax *= Length(ray.d);
+    ray.d = Normalize(ray.d);
+
+    // Initialize _MajorantIterator_ for ray majorant sampling
+    ConcreteMedium *medium = ray.medium.Cast<ConcreteMedium>();
+    typename ConcreteMedium::MajorantIterator iter = medium->SampleRay(ray, tMax, lambda);
+
+    // Generate ray majorant samples until termination
+    SampledSpectrum T_maj(1.f);
+    *T_r = SampledSpectrum(1.f);
+    while (true) {
+        // Get next majorant segment from iterator and find its sampling rate
+        pstd::optional<RayMajorantSegment> seg = iter.Next();
+        if (!seg)
+            return T_maj;
+        SampledSpectrum sigma_r = ClampZero(seg->sigma_maj - seg->sigma_min);
+        Float sigma = sampleResidual ? sigma_r[0] : seg->sigma_maj[0];
+
+        // Generate samples along current majorant segment
+        Float tMin = seg->tMin;
+        while (true) {
+            // Try to generate sample along current majorant segment
+            Float t = sigma > 0 ? tMin + SampleExponential(u, sigma) : Infinity;
+            if (sigma > 0)
+                u = rng.Uniform<Float>();
+            if (t < seg->tMax) {
+                // Call callback function for sample within segment
+                T_maj *= FastExp(-(t - tMin) * seg->sigma_maj);
+                *T_r *= FastExp(-(t - tMin) * sigma_r);
+                MediumProperties mp = medium->SamplePoint(ray(t), lambda);
+                if (!callback(ray(t), mp, seg->sigma_maj, T_maj, sigma_r, *T_r)) {
+                    *T_r = SampledSpectrum(1.f);
+                    return SampledSpectrum(1.f);
+                }
+                T_maj = *T_r = SampledSpectrum(1.f);
+                tMin = t;
+
+            } else {
+                // Handle sample past end of majorant segment
+                Float dt = seg->tMax - tMin;
+                // Handle infinite _dt_ for ray majorant segment
+                if (IsInf(dt))
+                    dt = std::numeric_limits<Float>::max();
+
+                T_maj *= FastExp(-dt * seg->sigma_maj);
+                *T_r *= FastExp(-dt * sigma_r);
+                break;
+            }
+        }
+    }
+}
+
 }  // namespace pbrt
 
 #endif  // PBRT_MEDIA_H
@@ -7,9 +7,15 @@
 #include <pbrt/pbrt.h>
 
 #include <pbrt/media.h>
+#include <pbrt/util/file.h>
 #include <pbrt/util/rng.h>
 #include <pbrt/util/sampling.h>
 
+#include <nanovdb/util/Primitives.h>
+
+#include <cstring>
+#include <vector>
+
 using namespace pbrt;
 
 TEST(HenyeyGreenstein, SamplingMatch) {
@@ -96,3 +102,123 @@ TEST(HenyeyGreenstein, g) {
         EXPECT_NEAR(g, gEst, .01);
     }
 }
+
+TEST(MajorantGrid, RefinedDDA) {
+    // Density that is nonzero only in a sphere in the middle of the medium
+    auto density = [](Point3f p) {
+        return std::max<Float>(0, 1 - 4 * Distance(p, Point3f(.5f, .5f, .5f)));
+    };
+    Bounds3f bounds(Point3f(-1, -2, 0), Point3f(3, 1, 2));
+    MajorantGrid grid(bounds, {5, 7, 3}, Allocator());
+    grid.Initialize(4, [&](const Bounds3f &b) {
+        Float maxDensity = 0;
+        for (int z = 0; z <= 8; ++z)
+            for (int y = 0; y <= 8; ++y)
+                for (int x = 0; x <= 8; ++x)
+                    maxDensity = std::max(
+                        maxDensity, density(b.Lerp(Point3f(x / 8.f, y / 8.f, z / 8.f))));
+        // The density is smallest at the corner farthest from the center
+        Float minDensity = density(b.Corner(0));
+        for (int c = 1; c < 8; ++c)
+            minDensity = std::min(minDensity, density(b.Corner(c)));
+        return Interval(minDensity, maxDensity);
+    });
+    EXPECT_GT(grid.refinedVoxels.size(), 0);
+
+    RNG rng;
+    for (int i = 0; i < 1000; ++i) {
+        Point3f o = bounds.Lerp(
+            Point3f(rng.Uniform<Float>(), rng.Uniform<Float>(), rng.Uniform<Float>()));
+        Vector3f d = SampleUniformSphere({rng.Uniform<Float>(), rng.Uniform<Float>()});
+        if (i % 8 == 0)
+            d.y = 0;
+        Ray ray(o, Normalize(d));
+        Float tMin, tMax;
+        ASSERT_TRUE(bounds.IntersectP(ray.o, ray.d, Infinity, &tMin, &tMax));
+
+        // Segments should cover $[t_{\roman{min}},t_{\roman{max}}]$ and bound the density
+        DDAMajorantIterator iter(ray, tMin, tMax, &grid, SampledSpectrum(1.f));
+        Float t = tMin;
+        while (pstd::optional<RayMajorantSegment> seg = iter.Next()) {
+            EXPECT_NEAR(t, seg->tMin, 1e-4f);
+            for (int j = 0; j <= 10; ++j) {
+                Point3f p(bounds.Offset(ray(Lerp(j / 10.f, seg->tMin, seg->tMax))));
+                EXPECT_LE(density(p), seg->sigma_maj[0] + 1e-3f);
+                EXPECT_GE(density(p), seg->sigma_min[0] - 1e-3f);
+            }
+            t = seg->tMax;
+        }
+        EXPECT_NEAR(t, tMax, 1e-4f);
+    }
+}
+
+TEST(GridMedium, ResidualTrackingNearBoundary) {
+    // Constant-density grid; lookups near its faces blend in zero density
+    std::vector<Float> density(8 * 8 * 8, 1.f);
+    Allocator alloc;
+    GridMedium medium(Bounds3f(Point3f(0, 0, 0), Point3f(1, 1, 1)), Transform(),
+                      alloc.new_object<ConstantSpectrum>(1.f),
+                      alloc.new_object<ConstantSpectrum>(1.f), 1.f, 0.f,
+                      SampledGrid<Float>(density, 8, 8, 8, alloc), {}, 1.f, 0.f,
+                      alloc.new_object<ConstantSpectrum>(0.f),
+                      SampledGrid<Float>({Float(1)}, 1, 1, 1, alloc), alloc);
+    SampledWavelengths lambda = SampledWavelengths::SampleUniform(0.5f);
+
+    for (Float y : {Float(0.01), Float(0.05), Float(0.5)}) {
+        Ray ray(Point3f(-0.5f, y, 0.03f), Vector3f(1, 0, 0), 0.f, &medium);
+        // Estimate transmittance with ratio tracking and residual ratio tracking
+        Float T[2] = {0, 0};
+        const int count = 20000;
+        for (int residual = 0; residual < 2; ++residual) {
+            RNG rng(residual);
+            for (int i = 0; i < count; ++i) {
+                Float Tr = 1;
+                SampledSpectrum T_r;
+                SampledSpectrum T_maj = SampleT_residual(
+                    ray, 2.f, rng.Uniform<Float>(), rng, lambda, residual, &T_r,
+                    [&](Point3f p, MediumProperties mp, SampledSpectrum sigma_maj,
+                        SampledSpectrum T_maj, SampledSpectrum sigma_r,
+                        SampledSpectrum T_r) {
+                        Float sigma_n = sigma_maj[0] - mp.sigma_a[0] - mp.sigma_s[0];
+                        Float pdf = residual ? T_r[0] * sigma_r[0]
+                                             : T_maj[0] * sigma_maj[0];
+                        Tr *= T_maj[0] * sigma_n / pdf;
+                        return true;
+                    });
+                Tr *= T_maj[0] / (residual ? T_r[0] : T_maj[0]);
+                T[residual] += Tr / count;
+            }
+        }
+        EXPECT_NEAR(T[0], T[1], 0.02f) << y;
+    }
+}
+
+TEST(NanoVDB, WriteAndMapGrids) {
+    std::vector<nanovdb::GridHandle<NanoVDBBuffer>> grids;
+    grids.push_back(nanovdb::createFogVolumeSphere<float, NanoVDBBuffer>(
+        10.f, nanovdb::Vec3d(0), 1., 3., nanovdb::Vec3d(0), "density"));
+    grids.push_back(nanovdb::createFogVolumeSphere<float, NanoVDBBuffer>(
+        5.f, nanovdb::Vec3d(3, 0, 0), 1., 3., nanovdb::Vec3d(0), "temperature"));
+    std::string filename = "mappable.nvdb";
+    WriteMappableNanoVDBGrids(filename, grids);
+
+    std::unique_ptr<MappedFile> mappedFile = MappedFile::Open(filename);
+    if (mappedFile) {
+        const char *gridNames[] = {"density", "temperature"};
+        for (int i = 0; i < 2; ++i) {
+            nanovdb::GridHandle<NanoVDBBuffer> grid =
+                MapNanoVDBGrid(filename, *mappedFile, gridNames[i], nullptr);
+            ASSERT_TRUE(bool(grid)) << gridNames[i];
+            // The grid should be used in place from the mapping
+            const char *data = (const char *)grid.data();
+            EXPECT_TRUE(data >= mappedFile->data() &&
+                        data < mappedFile->data() + mappedFile->size());
+            EXPECT_EQ(0, (data - mappedFile->data()) % NANOVDB_DATA_ALIGNMENT);
+            ASSERT_EQ(grids[i].size(), grid.size());
+            EXPECT_EQ(0, memcmp(grids[i].data(), grid.data(), grid.size()));
+        }
+        mappedFile.reset();
+    }
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
@@ -42,13 +42,15 @@ std::string PBRTOptions::ToString() const {
         "printStatistics: %s pixelSamples: %s gpuDevice: %s quickRender: %s upgrade: %s "
         "imageFile: %s mseReferenceImage: %s mseReferenceOutput: %s debugStart: %s "
         "displayServer: %s cropWindow: %s pixelBounds: %s pixelMaterial: %s "
-        "displacementEdgeScale: %f ]",
+        "displacementEdgeScale: %f lazyGeometry: %s compressGeometry: %s "
+        "quantizePositions: %s cacheDirectory: %s ]",
         seed, quiet, disablePixelJitter, disableWavelengthJitter, disableTextureFiltering,
         disableImageTextures, forceDiffuse, useGPU, wavefront, interactive, fullscreen,
         renderingSpace, nThreads, logLevel, logFile, logUtilization, writePartialImages,
         recordPixelStatistics, printStatistics, pixelSamples, gpuDevice, quickRender, upgrade,
         imageFile, mseReferenceImage, mseReferenceOutput, debugStart, displayServer, cropWindow,
-        pixelBounds, pixelMaterial, displacementEdgeScale);
+        pixelBounds, pixelMaterial, displacementEdgeScale, lazyGeometry,
+        compressGeometry, quantizePositions, cacheDirectory);
 }
 
 }  // namespace pbrt
@@ -54,6 +54,10 @@ struct PBRTOptions : BasicPBRTOptions {
     pstd::optional<Bounds2i> pixelBounds;
     pstd::optional<Point2i> pixelMaterial;
     Float displacementEdgeScale = 1;
+    bool lazyGeometry = false;
+    bool compressGeometry = false;
+    bool quantizePositions = false;
+    std::string cacheDirectory;
 
     std::string ToString() const;
 };
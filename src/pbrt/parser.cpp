@@ -373,6 +373,12 @@ static double parseFloat(const Token &t) {
         return t.token[0] - '0';
     }
 
+    // Most values in scene files are short decimal numbers that can be
+    // converted exactly without going through the general-purpose parser.
+    Float fastVal;
+    if (AtofFast(t.token, &fastVal))
+        return fastVal;
+
     // Copy to a buffer so we can NUL-terminate it, as strto[idf]() expect.
     char buf[64];
     char *bufp = buf;
@@ -598,6 +604,56 @@ static ParsedParameterVector parseParameters(
     return parameterVector;
 }
 
+static void parseFile(ParserTarget *target, const std::string &filename);
+
+static void parseImport(
+    ParserTarget *target, std::string filename, FileLoc loc,
+    std::vector<std::pair<AsyncJob<int> *, BasicSceneBuilder *>> *imports) {
+    if (FormattingParserTarget *formattingTarget =
+            dynamic_cast<FormattingParserTarget *>(target)) {
+        Printf("%sImport \"%s\"\n", formattingTarget->indent(), filename);
+        return;
+    }
+    if (BinarySceneWriter *writer = dynamic_cast<BinarySceneWriter *>(target)) {
+        writer->Import(filename, loc);
+        return;
+    }
+
+    BasicSceneBuilder *builder = dynamic_cast<BasicSceneBuilder *>(target);
+    CHECK(builder);
+
+    BasicSceneBuilder *importBuilder = builder->CopyForImport(loc);
+    filename = ResolveFilename(filename);
+
+    if (RunningThreads() == 1) {
+        parseFile(importBuilder, filename);
+        builder->MergeImported(importBuilder);
+    } else {
+        auto job = [=](std::string filename) {
+            Timer timer;
+            parseFile(importBuilder, filename);
+            LOG_VERBOSE("Elapsed time to parse \"%s\": %.2fs", filename,
+                        timer.ElapsedSeconds());
+            return 0;
+        };
+        AsyncJob<int> *jobFinished = RunAsync(job, filename);
+        imports->push_back(std::make_pair(jobFinished, importBuilder));
+    }
+}
+
+static void mergeImports(
+    ParserTarget *target,
+    std::vector<std::pair<AsyncJob<int> *, BasicSceneBuilder *>> &imports) {
+    for (auto &import : imports) {
+        import.first->Wait();
+
+        BasicSceneBuilder *builder = dynamic_cast<BasicSceneBuilder *>(target);
+        CHECK(builder);
+        builder->MergeImported(import.second);
+        // HACK: let import.second leak so that its TransformCache isn't deallocated...
+    }
+}
+
 void parse(ParserTarget *target, std::unique_ptr<Tokenizer> t) {
     FormattingParserTarget *formattingTarget =
         dynamic_cast<FormattingParserTarget *>(target);
@@ -771,44 +827,7 @@ void parse(ParserTarget *target, std::unique_ptr<Tokenizer> t) {
             } else if (tok->token == "Import") {
                 Token filenameToken = *nextToken(TokenRequired);
                 std::string filename = toString(dequoteString(filenameToken));
-                if (formatting)
-                    Printf("%sImport \"%s\"\n",
-                           dynamic_cast<FormattingParserTarget *>(target)->indent(),
-                           filename);
-                else {
-                    BasicSceneBuilder *builder =
-                        dynamic_cast<BasicSceneBuilder *>(target);
-                    CHECK(builder);
-
-                    if (builder->currentBlock !=
-                        BasicSceneBuilder::BlockState::WorldBlock)
-                        ErrorExit(&tok->loc, "Import statement only allowed inside world "
-                                             "definition block.");
-
-                    filename = ResolveFilename(filename);
-                    BasicSceneBuilder *importBuilder = builder->CopyForImport();
-
-                    if (RunningThreads() == 1) {
-                        std::unique_ptr<Tokenizer> timport =
-                            Tokenizer::CreateFromFile(filename, parseError);
-                        if (timport)
-                            parse(importBuilder, std::move(timport));
-                        builder->MergeImported(importBuilder);
-                    } else {
-                        auto job = [=](std::string filename) {
-                            Timer timer;
-                            std::unique_ptr<Tokenizer> timport =
-                                Tokenizer::CreateFromFile(filename, parseError);
-                            if (timport)
-                                parse(importBuilder, std::move(timport));
-                            LOG_VERBOSE("Elapsed time to parse \"%s\": %.2fs", filename,
-                                        timer.ElapsedSeconds());
-                            return 0;
-                        };
-                        AsyncJob<int> *jobFinished = RunAsync(job, filename);
-                        imports.push_back(std::make_pair(jobFinished, importBuilder));
-                    }
-                }
+                parseImport(target, filename, tok->loc, &imports);
             } else if (tok->token == "Identity")
                 target->Identity(tok->loc);
             else
@@ -986,36 +1005,37 @@ void parse(ParserTarget *target, std::unique_ptr<Tokenizer> t) {
         }
     }
 
-    for (auto &import : imports) {
-        import.first->Wait();
+    mergeImports(target, imports);
+}
 
-        BasicSceneBuilder *builder = dynamic_cast<BasicSceneBuilder *>(target);
-        CHECK(builder);
-        builder->MergeImported(import.second);
-        // HACK: let import.second leak so that its TransformCache isn't deallocated...
+static void parseBinary(ParserTarget *target, const std::string &filename);
+
+static void parseFile(ParserTarget *target, const std::string &filename) {
+    if (IsBinarySceneFile(filename)) {
+        parseBinary(target, filename);
+        return;
     }
-}
 
-void ParseFiles(ParserTarget *target, pstd::span<const std::string> filenames) {
     auto tokError = [](const char *msg, const FileLoc *loc) {
         ErrorExit(loc, "%s", msg);
     };
+    std::unique_ptr<Tokenizer> t = Tokenizer::CreateFromFile(filename, tokError);
+    if (t)
+        parse(target, std::move(t));
+}
 
+void ParseFiles(ParserTarget *target, pstd::span<const std::string> filenames) {
     // Process scene description
     if (filenames.empty()) {
         // Parse scene from standard input
-        std::unique_ptr<Tokenizer> t = Tokenizer::CreateFromFile("-", tokError);
-        if (t)
-            parse(target, std::move(t));
+        parseFile(target, "-");
     } else {
         // Parse scene from input files
         for (const std::string &fn : filenames) {
             if (fn != "-")
                 SetSearchDirectory(fn);
 
-            std::unique_ptr<Tokenizer> t = Tokenizer::CreateFromFile(fn, tokError);
-            if (t)
-                parse(target, std::move(t));
+            parseFile(target, fn);
         }
     }
 
@@ -1933,4 +1953,667 @@ void FormattingParserTarget::ObjectInstance(const std::string &name, FileLoc loc
 
 void FormattingParserTarget::EndOfFiles() {}
 
+// Binary Scene Format Definitions
+// Binary scene files start with an 8-byte magic string, a format version,
+// and sizeof(Float) for the writer.  Each ParserTarget call is then stored
+// as a one-byte opcode, the line and column of the call's FileLoc, and the
+// call's arguments.  Strings are stored as a 32-bit length followed by the
+// characters; parameter value arrays are stored as a 64-bit count followed
+// by the values' in-memory representation.
+static constexpr char binarySceneMagic[8] = {'p', 'b', 'r', 't', 'b', 'i', 'n', '\0'};
+static constexpr uint32_t binarySceneVersion = 1;
+
+enum class BinarySceneOp : uint8_t {
+    SourceFile,
+    Option,
+    Identity,
+    Translate,
+    Rotate,
+    Scale,
+    LookAt,
+    ConcatTransform,
+    Transform,
+    CoordinateSystem,
+    CoordSysTransform,
+    ActiveTransformAll,
+    ActiveTransformEndTime,
+    ActiveTransformStartTime,
+    TransformTimes,
+    ColorSpace,
+    PixelFilter,
+    Film,
+    Sampler,
+    Accelerator,
+    Integrator,
+    Camera,
+    MakeNamedMedium,
+    MediumInterface,
+    WorldBegin,
+    AttributeBegin,
+    AttributeEnd,
+    Attribute,
+    Texture,
+    Material,
+    MakeNamedMaterial,
+    NamedMaterial,
+    LightSource,
+    AreaLightSource,
+    Shape,
+    ReverseOrientation,
+    ObjectBegin,
+    ObjectEnd,
+    ObjectInstance,
+    Import
+};
+
+bool IsBinarySceneFile(const std::string &filename) {
+    if (filename == "-")
+        return false;
+    FILE *f = FOpenRead(filename);
+    if (!f)
+        return false;
+    char magic[sizeof(binarySceneMagic)];
+    bool isBinary = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                    memcmp(magic, binarySceneMagic, sizeof(magic)) == 0;
+    fclose(f);
+    return isBinary;
+}
+
+// BinarySceneWriter Method Definitions
+BinarySceneWriter::BinarySceneWriter(std::string fn) : filename(std::move(fn)) {
+    file = FOpenWrite(filename);
+    if (!file)
+        ErrorExit("%s: %s", filename, ErrorString());
+
+    write(binarySceneMagic, sizeof(binarySceneMagic));
+    write(binarySceneVersion);
+    write(uint32_t(sizeof(Float)));
+}
+
+BinarySceneWriter::~BinarySceneWriter() {
+    if (file)
+        EndOfFiles();
+}
+
+void BinarySceneWriter::write(const void *ptr, size_t size) {
+    // Large arrays bypass the buffer and are written directly.
+    if (size > 65536) {
+        flush();
+        if (fwrite(ptr, 1, size, file) != size)
+            ErrorExit("%s: %s", filename, ErrorString());
+        return;
+    }
+    buffer.append((const char *)ptr, size);
+    if (buffer.size() > 1024 * 1024)
+        flush();
+}
+
+void BinarySceneWriter::write(const std::string &str) {
+    write(uint32_t(str.size()));
+    write(str.data(), str.size());
+}
+
+void BinarySceneWriter::write(const ParsedParameterVector &params) {
+    write(uint32_t(params.size()));
+    for (ParsedParameter *p : params) {
+        write(p->type);
+        write(p->name);
+        write(int32_t(p->loc.line));
+        write(int32_t(p->loc.column));
+
+        write(uint64_t(p->floats.size()));
+        write(p->floats.data(), p->floats.size() * sizeof(Float));
+        write(uint64_t(p->ints.size()));
+        write(p->ints.data(), p->ints.size() * sizeof(int));
+        write(uint64_t(p->bools.size()));
+        write(p->bools.data(), p->bools.size());
+        write(uint64_t(p->strings.size()));
+        for (const std::string &str : p->strings)
+            write(str);
+
+        delete p;
+    }
+}
+
+void BinarySceneWriter::writeOp(BinarySceneOp op, const FileLoc &loc) {
+    if (loc.filename != currentFilename) {
+        currentFilename = std::string(loc.filename);
+        write(BinarySceneOp::SourceFile);
+        write(currentFilename);
+    }
+    write(op);
+    write(int32_t(loc.line));
+    write(int32_t(loc.column));
+}
+
+void BinarySceneWriter::flush() {
+    if (buffer.empty())
+        return;
+    if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+        ErrorExit("%s: %s", filename, ErrorString());
+    buffer.clear();
+}
+
+void BinarySceneWriter::Option(const std::string &name, const std::string &value,
+                               FileLoc loc) {
+    writeOp(BinarySceneOp::Option, loc);
+    write(name);
+    write(value);
+}
+
+void BinarySceneWriter::Identity(FileLoc loc) {
+    writeOp(BinarySceneOp::Identity, loc);
+}
+
+void BinarySceneWriter::Translate(Float dx, Float dy, Float dz, FileLoc loc) {
+    writeOp(BinarySceneOp::Translate, loc);
+    Float v[3] = {dx, dy, dz};
+    write(v, sizeof(v));
+}
+
+void BinarySceneWriter::Rotate(Float angle, Float ax, Float ay, Float az, FileLoc loc) {
+    writeOp(BinarySceneOp::Rotate, loc);
+    Float v[4] = {angle, ax, ay, az};
+    write(v, sizeof(v));
+}
+
+void BinarySceneWriter::Scale(Float sx, Float sy, Float sz, FileLoc loc) {
+    writeOp(BinarySceneOp::Scale, loc);
+    Float v[3] = {sx, sy, sz};
+    write(v, sizeof(v));
+}
+
+void BinarySceneWriter::LookAt(Float ex, Float ey, Float ez, Float lx, Float ly,
+                               Float lz, Float ux, Float uy, Float uz, FileLoc loc) {
+    writeOp(BinarySceneOp::LookAt, loc);
+    Float v[9] = {ex, ey, ez, lx, ly, lz, ux, uy, uz};
+    write(v, sizeof(v));
+}
+
+void BinarySceneWriter::ConcatTransform(Float transform[16], FileLoc loc) {
+    writeOp(BinarySceneOp::ConcatTransform, loc);
+    write(transform, 16 * sizeof(Float));
+}
+
+void BinarySceneWriter::Transform(Float transform[16], FileLoc loc) {
+    writeOp(BinarySceneOp::Transform, loc);
+    write(transform, 16 * sizeof(Float));
+}
+
+void BinarySceneWriter::CoordinateSystem(const std::string &name, FileLoc loc) {
+    writeOp(BinarySceneOp::CoordinateSystem, loc);
+    write(name);
+}
+
+void BinarySceneWriter::CoordSysTransform(const std::string &name, FileLoc loc) {
+    writeOp(BinarySceneOp::CoordSysTransform, loc);
+    write(name);
+}
+
+void BinarySceneWriter::ActiveTransformAll(FileLoc loc) {
+    writeOp(BinarySceneOp::ActiveTransformAll, loc);
+}
+
+void BinarySceneWriter::ActiveTransformEndTime(FileLoc loc) {
+    writeOp(BinarySceneOp::ActiveTransformEndTime, loc);
+}
+
+void BinarySceneWriter::ActiveTransformStartTime(FileLoc loc) {
+    writeOp(BinarySceneOp::ActiveTransformStartTime, loc);
+}
+
+void BinarySceneWriter::TransformTimes(Float start, Float end, FileLoc loc) {
+    writeOp(BinarySceneOp::TransformTimes, loc);
+    Float v[2] = {start, end};
+    write(v, sizeof(v));
+}
+
+void BinarySceneWriter::ColorSpace(const std::string &n, FileLoc loc) {
+    writeOp(BinarySceneOp::ColorSpace, loc);
+    write(n);
+}
+
+void BinarySceneWriter::PixelFilter(const std::string &name,
+                                    ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::PixelFilter, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::Film(const std::string &type, ParsedParameterVector params,
+                             FileLoc loc) {
+    writeOp(BinarySceneOp::Film, loc);
+    write(type);
+    write(params);
+}
+
+void BinarySceneWriter::Sampler(const std::string &name, ParsedParameterVector params,
+                                FileLoc loc) {
+    writeOp(BinarySceneOp::Sampler, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::Accelerator(const std::string &name,
+                                    ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::Accelerator, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::Integrator(const std::string &name, ParsedParameterVector params,
+                                   FileLoc loc) {
+    writeOp(BinarySceneOp::Integrator, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::Camera(const std::string &name, ParsedParameterVector params,
+                               FileLoc loc) {
+    writeOp(BinarySceneOp::Camera, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::MakeNamedMedium(const std::string &name,
+                                        ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::MakeNamedMedium, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::MediumInterface(const std::string &insideName,
+                                        const std::string &outsideName, FileLoc loc) {
+    writeOp(BinarySceneOp::MediumInterface, loc);
+    write(insideName);
+    write(outsideName);
+}
+
+void BinarySceneWriter::WorldBegin(FileLoc loc) {
+    writeOp(BinarySceneOp::WorldBegin, loc);
+}
+
+void BinarySceneWriter::AttributeBegin(FileLoc loc) {
+    writeOp(BinarySceneOp::AttributeBegin, loc);
+}
+
+void BinarySceneWriter::AttributeEnd(FileLoc loc) {
+    writeOp(BinarySceneOp::AttributeEnd, loc);
+}
+
+void BinarySceneWriter::Attribute(const std::string &target,
+                                  ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::Attribute, loc);
+    write(target);
+    write(params);
+}
+
+void BinarySceneWriter::Texture(const std::string &name, const std::string &type,
+                                const std::string &texname, ParsedParameterVector params,
+                                FileLoc loc) {
+    writeOp(BinarySceneOp::Texture, loc);
+    write(name);
+    write(type);
+    write(texname);
+    write(params);
+}
+
+void BinarySceneWriter::Material(const std::string &name, ParsedParameterVector params,
+                                 FileLoc loc) {
+    writeOp(BinarySceneOp::Material, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::MakeNamedMaterial(const std::string &name,
+                                          ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::MakeNamedMaterial, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::NamedMaterial(const std::string &name, FileLoc loc) {
+    writeOp(BinarySceneOp::NamedMaterial, loc);
+    write(name);
+}
+
+void BinarySceneWriter::LightSource(const std::string &name,
+                                    ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::LightSource, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::AreaLightSource(const std::string &name,
+                                        ParsedParameterVector params, FileLoc loc) {
+    writeOp(BinarySceneOp::AreaLightSource, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::Shape(const std::string &name, ParsedParameterVector params,
+                              FileLoc loc) {
+    writeOp(BinarySceneOp::Shape, loc);
+    write(name);
+    write(params);
+}
+
+void BinarySceneWriter::ReverseOrientation(FileLoc loc) {
+    writeOp(BinarySceneOp::ReverseOrientation, loc);
+}
+
+void BinarySceneWriter::ObjectBegin(const std::string &name, FileLoc loc) {
+    writeOp(BinarySceneOp::ObjectBegin, loc);
+    write(name);
+}
+
+void BinarySceneWriter::ObjectEnd(FileLoc loc) {
+    writeOp(BinarySceneOp::ObjectEnd, loc);
+}
+
+void BinarySceneWriter::ObjectInstance(const std::string &name, FileLoc loc) {
+    writeOp(BinarySceneOp::ObjectInstance, loc);
+    write(name);
+}
+
+void BinarySceneWriter::Import(const std::string &filename, FileLoc loc) {
+    writeOp(BinarySceneOp::Import, loc);
+    write(filename);
+}
+
+void BinarySceneWriter::EndOfFiles() {
+    if (!file)
+        return;
+    flush();
+    if (fclose(file) != 0)
+        ErrorExit("%s: %s", filename, ErrorString());
+    file = nullptr;
+}
+
+// BinarySceneReader Definition
+class BinarySceneReader {
+  public:
+    BinarySceneReader(const std::string &filename) : filename(filename) {
+        mappedFile = MappedFile::Open(filename);
+        if (mappedFile) {
+            pos = mappedFile->data();
+            end = pos + mappedFile->size();
+        } else {
+            contents = ReadFileContents(filename);
+            pos = contents.data();
+            end = pos + contents.size();
+        }
+        // This leaks, but as with the Tokenizer, the FileLocs that refer
+        // to it must remain valid after parsing is done.
+        loc = FileLoc(*new std::string(filename));
+    }
+
+    bool AtEnd() const { return pos == end; }
+
+    void Read(void *ptr, size_t size) {
+        if (size > size_t(end - pos))
+            ErrorExit("%s: premature end of binary scene file", filename);
+        memcpy(ptr, pos, size);
+        pos += size;
+    }
+    template <typename T>
+    T Read() {
+        T v;
+        Read(&v, sizeof(T));
+        return v;
+    }
+    std::string ReadString() {
+        uint32_t length = Read<uint32_t>();
+        if (length > size_t(end - pos))
+            ErrorExit("%s: premature end of binary scene file", filename);
+        std::string str(pos, length);
+        pos += length;
+        return str;
+    }
+
+    // Reads _n_ floating-point values stored with _floatSize_ bytes each.
+    void ReadFloats(Float *v, size_t n) {
+        if (floatSize == sizeof(Float))
+            Read(v, n * sizeof(Float));
+        else
+            for (size_t i = 0; i < n; ++i)
+                v[i] = (floatSize == sizeof(float)) ? Float(Read<float>())
+                                                     : Float(Read<double>());
+    }
+
+    ParsedParameterVector ReadParameters() {
+        ParsedParameterVector params;
+        uint32_t nParams = Read<uint32_t>();
+        for (uint32_t i = 0; i < nParams; ++i) {
+            ParsedParameter *p = new ParsedParameter(loc);
+            p->type = ReadString();
+            p->name = ReadString();
+            p->loc.line = Read<int32_t>();
+            p->loc.column = Read<int32_t>();
+
+            p->floats.resize(readCount(floatSize));
+            ReadFloats(p->floats.data(), p->floats.size());
+            p->ints.resize(readCount(sizeof(int)));
+            Read(p->ints.data(), p->ints.size() * sizeof(int));
+            p->bools.resize(readCount(1));
+            Read(p->bools.data(), p->bools.size());
+            uint64_t nStrings = Read<uint64_t>();
+            for (uint64_t j = 0; j < nStrings; ++j)
+                p->strings.push_back(ReadString());
+
+            params.push_back(p);
+        }
+        return params;
+    }
+
+    std::string filename;
+    FileLoc loc;
+    uint32_t floatSize = sizeof(Float);
+
+  private:
+    uint64_t readCount(size_t elementSize) {
+        uint64_t n = Read<uint64_t>();
+        if (n > size_t(end - pos) / elementSize)
+            ErrorExit("%s: premature end of binary scene file", filename);
+        return n;
+    }
+
+    std::unique_ptr<MappedFile> mappedFile;
+    std::string contents;
+    const char *pos, *end;
+};
+
+static void parseBinary(ParserTarget *target, const std::string &filename) {
+    LOG_VERBOSE("Started parsing binary scene file %s", filename);
+    BinarySceneReader r(filename);
+
+    char magic[sizeof(binarySceneMagic)];
+    r.Read(magic, sizeof(magic));
+    uint32_t version = r.Read<uint32_t>();
+    if (version != binarySceneVersion)
+        ErrorExit("%s: binary scene file version %d is not supported (expected %d).",
+                  filename, version, binarySceneVersion);
+    r.floatSize = r.Read<uint32_t>();
+    if (r.floatSize != sizeof(float) && r.floatSize != sizeof(double))
+        ErrorExit("%s: invalid floating-point size %d in binary scene file.", filename,
+                  r.floatSize);
+
+    std::vector<std::pair<AsyncJob<int> *, BasicSceneBuilder *>> imports;
+    auto readFloats = [&](int n) {
+        pstd::array<Float, 16> v;
+        r.ReadFloats(v.data(), n);
+        return v;
+    };
+
+    while (!r.AtEnd()) {
+        BinarySceneOp op = r.Read<BinarySceneOp>();
+        if (op == BinarySceneOp::SourceFile) {
+            r.loc.filename = *new std::string(r.ReadString());
+            continue;
+        }
+
+        FileLoc loc = r.loc;
+        loc.line = r.Read<int32_t>();
+        loc.column = r.Read<int32_t>();
+
+        switch (op) {
+        case BinarySceneOp::Option: {
+            std::string name = r.ReadString();
+            std::string value = r.ReadString();
+            target->Option(name, value, loc);
+            break;
+        }
+        case BinarySceneOp::Identity:
+            target->Identity(loc);
+            break;
+        case BinarySceneOp::Translate: {
+            pstd::array<Float, 16> v = readFloats(3);
+            target->Translate(v[0], v[1], v[2], loc);
+            break;
+        }
+        case BinarySceneOp::Rotate: {
+            pstd::array<Float, 16> v = readFloats(4);
+            target->Rotate(v[0], v[1], v[2], v[3], loc);
+            break;
+        }
+        case BinarySceneOp::Scale: {
+            pstd::array<Float, 16> v = readFloats(3);
+            target->Scale(v[0], v[1], v[2], loc);
+            break;
+        }
+        case BinarySceneOp::LookAt: {
+            pstd::array<Float, 16> v = readFloats(9);
+            target->LookAt(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], loc);
+            break;
+        }
+        case BinarySceneOp::ConcatTransform: {
+            pstd::array<Float, 16> v = readFloats(16);
+            target->ConcatTransform(v.data(), loc);
+            break;
+        }
+        case BinarySceneOp::Transform: {
+            pstd::array<Float, 16> v = readFloats(16);
+            target->Transform(v.data(), loc);
+            break;
+        }
+        case BinarySceneOp::CoordinateSystem:
+            target->CoordinateSystem(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::CoordSysTransform:
+            target->CoordSysTransform(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::ActiveTransformAll:
+            target->ActiveTransformAll(loc);
+            break;
+        case BinarySceneOp::ActiveTransformEndTime:
+            target->ActiveTransformEndTime(loc);
+            break;
+        case BinarySceneOp::ActiveTransformStartTime:
+            target->ActiveTransformStartTime(loc);
+            break;
+        case BinarySceneOp::TransformTimes: {
+            pstd::array<Float, 16> v = readFloats(2);
+            target->TransformTimes(v[0], v[1], loc);
+            break;
+        }
+        case BinarySceneOp::ColorSpace:
+            target->ColorSpace(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::MediumInterface: {
+            std::string inside = r.ReadString();
+            std::string outside = r.ReadString();
+            target->MediumInterface(inside, outside, loc);
+            break;
+        }
+        case BinarySceneOp::WorldBegin:
+            target->WorldBegin(loc);
+            break;
+        case BinarySceneOp::AttributeBegin:
+            target->AttributeBegin(loc);
+            break;
+        case BinarySceneOp::AttributeEnd:
+            target->AttributeEnd(loc);
+            break;
+        case BinarySceneOp::Texture: {
+            std::string name = r.ReadString();
+            std::string type = r.ReadString();
+            std::string texName = r.ReadString();
+            target->Texture(name, type, texName, r.ReadParameters(), loc);
+            break;
+        }
+        case BinarySceneOp::NamedMaterial:
+            target->NamedMaterial(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::ReverseOrientation:
+            target->ReverseOrientation(loc);
+            break;
+        case BinarySceneOp::ObjectBegin:
+            target->ObjectBegin(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::ObjectEnd:
+            target->ObjectEnd(loc);
+            break;
+        case BinarySceneOp::ObjectInstance:
+            target->ObjectInstance(r.ReadString(), loc);
+            break;
+        case BinarySceneOp::Import:
+            parseImport(target, r.ReadString(), loc, &imports);
+            break;
+        default: {
+            // The remaining directives all take a name and a parameter list
+            void (ParserTarget::*apiFunc)(const std::string &, ParsedParameterVector,
+                                          FileLoc);
+            switch (op) {
+            case BinarySceneOp::PixelFilter:
+                apiFunc = &ParserTarget::PixelFilter;
+                break;
+            case BinarySceneOp::Film:
+                apiFunc = &ParserTarget::Film;
+                break;
+            case BinarySceneOp::Sampler:
+                apiFunc = &ParserTarget::Sampler;
+                break;
+            case BinarySceneOp::Accelerator:
+                apiFunc = &ParserTarget::Accelerator;
+                break;
+            case BinarySceneOp::Integrator:
+                apiFunc = &ParserTarget::Integrator;
+                break;
+            case BinarySceneOp::Camera:
+                apiFunc = &ParserTarget::Camera;
+                break;
+            case BinarySceneOp::MakeNamedMedium:
+                apiFunc = &ParserTarget::MakeNamedMedium;
+                break;
+            case BinarySceneOp::Attribute:
+                apiFunc = &ParserTarget::Attribute;
+                break;
+            case BinarySceneOp::Material:
+                apiFunc = &ParserTarget::Material;
+                break;
+            case BinarySceneOp::MakeNamedMaterial:
+                apiFunc = &ParserTarget::MakeNamedMaterial;
+                break;
+            case BinarySceneOp::LightSource:
+                apiFunc = &ParserTarget::LightSource;
+                break;
+            case BinarySceneOp::AreaLightSource:
+                apiFunc = &ParserTarget::AreaLightSource;
+                break;
+            case BinarySceneOp::Shape:
+                apiFunc = &ParserTarget::Shape;
+                break;
+            default:
+                ErrorExit(&loc, "%d: unknown opcode in binary scene file", int(op));
+            }
+            std::string name = r.ReadString();
+            (target->*apiFunc)(name, r.ReadParameters(), loc);
+        }
+        }
+    }
+
+    mergeImports(target, imports);
+    LOG_VERBOSE("Finished parsing binary scene file %s", filename);
+}
+
 }  // namespace pbrt
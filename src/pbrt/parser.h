@@ -111,6 +111,8 @@ class ParserTarget {
 void ParseFiles(ParserTarget *target, pstd::span<const std::string> filenames);
 void ParseString(ParserTarget *target, std::string str);
 
+bool IsBinarySceneFile(const std::string &filename);
+
 // Token Definition
 struct Token {
     Token() = default;
@@ -271,6 +273,87 @@ class FormattingParserTarget : public ParserTarget {
     std::map<std::string, std::string> definedObjectInstances;
 };
 
+enum class BinarySceneOp : uint8_t;
+
+// BinarySceneWriter Definition
+// Serializes the stream of ParserTarget calls to a compact binary file that
+// ParseFiles() recognizes and can replay without tokenizing; parameter
+// arrays are stored in their in-memory representation.
+class BinarySceneWriter : public ParserTarget {
+  public:
+    BinarySceneWriter(std::string filename);
+    ~BinarySceneWriter();
+
+    void Option(const std::string &name, const std::string &value, FileLoc loc);
+    void Identity(FileLoc loc);
+    void Translate(Float dx, Float dy, Float dz, FileLoc loc);
+    void Rotate(Float angle, Float ax, Float ay, Float az, FileLoc loc);
+    void Scale(Float sx, Float sy, Float sz, FileLoc loc);
+    void LookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux,
+                Float uy, Float uz, FileLoc loc);
+    void ConcatTransform(Float transform[16], FileLoc loc);
+    void Transform(Float transform[16], FileLoc loc);
+    void CoordinateSystem(const std::string &, FileLoc loc);
+    void CoordSysTransform(const std::string &, FileLoc loc);
+    void ActiveTransformAll(FileLoc loc);
+    void ActiveTransformEndTime(FileLoc loc);
+    void ActiveTransformStartTime(FileLoc loc);
+    void TransformTimes(Float start, Float end, FileLoc loc);
+    void ColorSpace(const std::string &n, FileLoc loc);
+    void PixelFilter(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void Film(const std::string &type, ParsedParameterVector params, FileLoc loc);
+    void Sampler(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void Accelerator(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void Integrator(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void Camera(const std::string &, ParsedParameterVector params, FileLoc loc);
+    void MakeNamedMedium(const std::string &name, ParsedParameterVector params,
+                         FileLoc loc);
+    void MediumInterface(const std::string &insideName, const std::string &outsideName,
+                         FileLoc loc);
+    void WorldBegin(FileLoc loc);
+    void AttributeBegin(FileLoc loc);
+    void AttributeEnd(FileLoc loc);
+    void Attribute(const std::string &target, ParsedParameterVector params, FileLoc loc);
+    void Texture(const std::string &name, const std::string &type,
+                 const std::string &texname, ParsedParameterVector params, FileLoc loc);
+    void Material(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void MakeNamedMaterial(const std::string &name, ParsedParameterVector params,
+                           FileLoc loc);
+    void NamedMaterial(const std::string &name, FileLoc loc);
+    void LightSource(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void AreaLightSource(const std::string &name, ParsedParameterVector params,
+                         FileLoc loc);
+    void Shape(const std::string &name, ParsedParameterVector params, FileLoc loc);
+    void ReverseOrientation(FileLoc loc);
+    void ObjectBegin(const std::string &name, FileLoc loc);
+    void ObjectEnd(FileLoc loc);
+    void ObjectInstance(const std::string &name, FileLoc loc);
+
+    // Imported files are not inlined; the Import directive itself is
+    // recorded so that the files can still be parsed in parallel.
+    void Import(const std::string &filename, FileLoc loc);
+
+    void EndOfFiles();
+
+  private:
+    // BinarySceneWriter Private Methods
+    void writeOp(BinarySceneOp op, const FileLoc &loc);
+    void write(const void *ptr, size_t size);
+    template <typename T>
+    void write(T v) {
+        write(&v, sizeof(T));
+    }
+    void write(const std::string &str);
+    void write(const ParsedParameterVector &params);
+    void flush();
+
+    // BinarySceneWriter Private Members
+    std::string filename;
+    FILE *file = nullptr;
+    std::string buffer;
+    std::string currentFilename;
+};
+
 }  // namespace pbrt
 
 #endif  // PBRT_PARSER_H
@@ -144,3 +144,44 @@ Integrator "deep" "float density" [ 2 2.66612 -5e-51]
 
     EXPECT_EQ(0, remove(filename.c_str()));
 }
+
+TEST(Parser, BinaryRoundTrip) {
+    std::string scene = R"(
+LookAt 0 0 5  0 0 0  0 1 0
+Camera "perspective" "float fov" 45
+Film "rgb" "string filename" "out.exr" "integer xresolution" [ 64 ]
+WorldBegin
+AttributeBegin
+  Translate 1 2 3
+  Material "diffuse" "rgb reflectance" [ .5 .25 .125 ]
+  Texture "checks" "spectrum" "checkerboard" "float uscale" 4 "bool dummy" true
+  Shape "trianglemesh" "point3 P" [ 0 0 0 1 0 0 1 1 0 ]
+      "integer indices" [ 0 1 2 ] "string name" [ "a" "b" ]
+AttributeEnd
+ObjectBegin "foo"
+  Shape "sphere"
+ObjectEnd
+ObjectInstance "foo"
+)";
+
+    // Convert the scene to the binary format and then convert the binary
+    // file again; the two should be identical.
+    std::string fn0 = inTestDir("roundtrip0.pbrb"), fn1 = inTestDir("roundtrip1.pbrb");
+    BinarySceneWriter writer0(fn0);
+    ParseString(&writer0, scene);
+    EXPECT_TRUE(IsBinarySceneFile(fn0));
+
+    BinarySceneWriter writer1(fn1);
+    ParseFiles(&writer1, {fn0});
+
+    std::ifstream in0(fn0, std::ios::binary), in1(fn1, std::ios::binary);
+    std::string contents0((std::istreambuf_iterator<char>(in0)),
+                          std::istreambuf_iterator<char>());
+    std::string contents1((std::istreambuf_iterator<char>(in1)),
+                          std::istreambuf_iterator<char>());
+    EXPECT_GT(contents0.size(), 0);
+    EXPECT_EQ(contents0, contents1);
+
+    EXPECT_EQ(0, remove(fn0.c_str()));
+    EXPECT_EQ(0, remove(fn1.c_str()));
+}
@@ -26,6 +26,7 @@
 #include <pbrt/util/string.h>
 #include <pbrt/util/transform.h>
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 
@@ -415,7 +416,11 @@ void BasicSceneBuilder::EndOfFiles() {
     scene->Done();
 }
 
-BasicSceneBuilder *BasicSceneBuilder::CopyForImport() {
+BasicSceneBuilder *BasicSceneBuilder::CopyForImport(FileLoc loc) {
+    if (currentBlock != BlockState::WorldBlock)
+        ErrorExit(&loc, "Import statement only allowed inside world "
+                        "definition block.");
+
     BasicSceneBuilder *importBuilder = new BasicSceneBuilder(scene);
     importBuilder->renderFromWorld = renderFromWorld;
     importBuilder->graphicsState = graphicsState;
@@ -909,13 +914,78 @@ void BasicScene::startLoadingNormalMaps(const ParameterDictionary &parameters) {
     normalMapJobs[filename] = RunAsync(create, filename);
 }
 
+// Returns whether _texture_ depends only on $(u,v)$ and repeats over $[0,1]^2$,
+// given the previously defined float and spectrum textures that do.
+static bool TextureIsPeriodicInUV(const TextureSceneEntity &texture, bool isSpectrum,
+                                  const std::set<std::string> &uvFloatTextures,
+                                  const std::set<std::string> &uvSpectrumTextures) {
+    const std::string &name = texture.name;
+    if (name == "checkerboard" || name == "imagemap") {
+        if (texture.parameters.GetOneString("mapping", "uv") != "uv")
+            return false;
+        if (name == "checkerboard" && texture.parameters.GetOneInt("dimension", 2) != 2)
+            return false;
+        if (name == "imagemap" &&
+            texture.parameters.GetOneString("wrap", "repeat") != "repeat")
+            return false;
+        // The $(u,v)$ scales must cover whole periods of the texture, which
+        // are two units for checkerboards and one for repeating images
+        Float period = (name == "checkerboard") ? 2 : 1;
+        for (const char *scale : {"uscale", "vscale"}) {
+            Float n = texture.parameters.GetOneFloat(scale, 1) / period;
+            if (n != std::round(n))
+                return false;
+        }
+    } else if (name != "constant" && name != "scale" && name != "mix")
+        return false;
+
+    // Check that the textures that _texture_ uses are also periodic in $(u,v)$
+    for (const ParsedParameter *param : texture.parameters.GetParameterVector()) {
+        if (param->type != "texture" || param->strings.empty())
+            continue;
+        bool isFloat = !isSpectrum || param->name == "amount" || param->name == "scale";
+        if (!(isFloat ? uvFloatTextures : uvSpectrumTextures).count(param->strings[0]))
+            return false;
+    }
+    return true;
+}
+
+// Returns the resolution to bake the texture _name_ at, or zero if it
+// shouldn't be baked.
+static int TextureBakeResolution(const std::string &name,
+                                 const TextureSceneEntity &texture, bool periodic) {
+    int resolution = texture.parameters.GetOneInt("bakeresolution", 0);
+    if (resolution <= 0)
+        return 0;
+    if (Options->useGPU) {
+        Warning(&texture.loc, "%s: texture baking is not supported on the GPU.", name);
+        return 0;
+    }
+    if (!periodic) {
+        Warning(&texture.loc,
+                "%s: texture depends on more than (u,v) or doesn't repeat over "
+                "[0,1]^2 and can't be baked.",
+                name);
+        return 0;
+    }
+    return resolution;
+}
+
 void BasicScene::AddFloatTexture(std::string name, TextureSceneEntity texture) {
     if (texture.renderFromObject.IsAnimated())
         Warning(&texture.loc, "Animated world to texture transforms are not supported. "
                               "Using start transform.");
 
     std::lock_guard<std::mutex> lock(textureMutex);
+    bool periodic =
+        TextureIsPeriodicInUV(texture, false, uvFloatTextures, uvSpectrumTextures);
+    if (periodic)
+        uvFloatTextures.insert(name);
+    else
+        uvFloatTextures.erase(name);
     if (texture.name != "imagemap" && texture.name != "ptex") {
+        if (int resolution = TextureBakeResolution(name, texture, periodic))
+            serialFloatBakeResolutions[serialFloatTextures.size()] = resolution;
         serialFloatTextures.push_back(
             std::make_pair(std::move(name), std::move(texture)));
         return;
@@ -956,8 +1026,16 @@ void BasicScene::AddFloatTexture(std::string name, TextureSceneEntity texture) {
 
 void BasicScene::AddSpectrumTexture(std::string name, TextureSceneEntity texture) {
     std::lock_guard<std::mutex> lock(textureMutex);
+    bool periodic =
+        TextureIsPeriodicInUV(texture, true, uvFloatTextures, uvSpectrumTextures);
+    if (periodic)
+        uvSpectrumTextures.insert(name);
+    else
+        uvSpectrumTextures.erase(name);
 
     if (texture.name != "imagemap" && texture.name != "ptex") {
+        if (int resolution = TextureBakeResolution(name, texture, periodic))
+            serialSpectrumBakeResolutions[serialSpectrumTextures.size()] = resolution;
         serialSpectrumTextures.push_back(
             std::make_pair(std::move(name), std::move(texture)));
         return;
@@ -1213,17 +1291,28 @@ NamedTextures BasicScene::CreateTextures() {
     }
 
     // And do the rest serially
-    for (auto &tex : serialFloatTextures) {
+    for (size_t i = 0; i < serialFloatTextures.size(); ++i) {
+        auto &tex = serialFloatTextures[i];
         Allocator alloc = threadAllocators.Get();
 
         pbrt::Transform renderFromTexture = tex.second.renderFromObject.startTransform;
         TextureParameterDictionary texDict(&tex.second.parameters, &textures);
+        auto bake = serialFloatBakeResolutions.find(i);
+        int resolution = (bake != serialFloatBakeResolutions.end()) ? bake->second : 0;
         FloatTexture t = FloatTexture::Create(tex.second.name, renderFromTexture, texDict,
                                               &tex.second.loc, alloc, Options->useGPU);
+        if (resolution > 0) {
+            // Replace the texture with an image texture of its baked values
+            MIPMap *mipmap =
+                BakeTexture(t, resolution, tex.second.parameters.ColorSpace(), alloc);
+            t = alloc.new_object<FloatImageTexture>(alloc.new_object<UVMapping>(),
+                                                    "(baked)", mipmap, 1, false);
+        }
         textures.floatTextures[tex.first] = t;
     }
 
-    for (auto &tex : serialSpectrumTextures) {
+    for (size_t i = 0; i < serialSpectrumTextures.size(); ++i) {
+        auto &tex = serialSpectrumTextures[i];
         Allocator alloc = threadAllocators.Get();
 
         if (tex.second.renderFromObject.IsAnimated())
@@ -1232,6 +1321,8 @@ NamedTextures BasicScene::CreateTextures() {
 
         pbrt::Transform renderFromTexture = tex.second.renderFromObject.startTransform;
         TextureParameterDictionary texDict(&tex.second.parameters, &textures);
+        auto bake = serialSpectrumBakeResolutions.find(i);
+        int resolution = (bake != serialSpectrumBakeResolutions.end()) ? bake->second : 0;
         SpectrumTexture albedoTex = SpectrumTexture::Create(
             tex.second.name, renderFromTexture, texDict, SpectrumType::Albedo,
             &tex.second.loc, alloc, Options->useGPU);
@@ -1241,6 +1332,19 @@ NamedTextures BasicScene::CreateTextures() {
         SpectrumTexture illumTex = SpectrumTexture::Create(
             tex.second.name, renderFromTexture, texDict, SpectrumType::Illuminant,
             &tex.second.loc, alloc, Options->useGPU);
+        if (resolution > 0) {
+            // Bake the unclamped texture once and share its image for all three
+            // _SpectrumType_s, which convert its RGB values as image textures do
+            MIPMap *mipmap = BakeTexture(unboundedTex, resolution,
+                                         tex.second.parameters.ColorSpace(), alloc);
+            auto baked = [&](SpectrumType type) {
+                return alloc.new_object<SpectrumImageTexture>(
+                    alloc.new_object<UVMapping>(), "(baked)", mipmap, 1, false, type);
+            };
+            albedoTex = baked(SpectrumType::Albedo);
+            unboundedTex = baked(SpectrumType::Unbounded);
+            illumTex = baked(SpectrumType::Illuminant);
+        }
 
         textures.albedoSpectrumTextures[tex.first] = albedoTex;
         textures.unboundedSpectrumTextures[tex.first] = unboundedTex;
@@ -1384,13 +1488,34 @@ Primitive BasicScene::CreateAggregate(
     };
 
     // Non-animated shapes
+    // Each lazily-created PLY mesh adds at most one triangle mesh and one
+    // bilinear patch mesh once rendering has started.
+    std::atomic<size_t> nLazyShapes{0};
     auto CreatePrimitivesForShapes =
         [&](std::vector<ShapeSceneEntity> &shapes) -> std::vector<Primitive> {
         // Parallelize Shape::Create calls, which will in turn
         // parallelize PLY file loading, etc...
+        // With --lazy-geometry, PLY meshes that aren't emissive or displaced
+        // are represented by a _LazyPrimitive_; only their bounds are
+        // computed now.
+        auto isLazy = [](const ShapeSceneEntity &sh) {
+            return Options->lazyGeometry && sh.name == "plymesh" && sh.lightIndex == -1 &&
+                   sh.parameters.GetTexture("displacement").empty();
+        };
+
         pstd::vector<pstd::vector<pbrt::Shape>> shapeVectors(shapes.size());
+        std::vector<pstd::optional<Bounds3f>> lazyBounds(shapes.size());
         ParallelFor(0, shapes.size(), [&](int64_t i) {
             const auto &sh = shapes[i];
+            if (isLazy(sh)) {
+                std::string filename =
+                    ResolveFilename(sh.parameters.GetOneString("filename", ""));
+                Bounds3f bounds;
+                for (Point3f p : TriQuadMesh::ReadPLYPositions(filename))
+                    bounds = Union(bounds, (*sh.renderFromObject)(p));
+                lazyBounds[i] = bounds;
+                return;
+            }
             shapeVectors[i] = Shape::Create(
                 sh.name, sh.renderFromObject, sh.objectFromRender, sh.reverseOrientation,
                 sh.parameters, textures.floatTextures, &sh.loc, alloc);
@@ -1400,10 +1525,14 @@ Primitive BasicScene::CreateAggregate(
         for (size_t i = 0; i < shapes.size(); ++i) {
             auto &sh = shapes[i];
             pstd::vector<pbrt::Shape> &shapes = shapeVectors[i];
-            if (shapes.empty())
+            if (shapes.empty() && (!lazyBounds[i] || lazyBounds[i]->IsDegenerate()))
                 continue;
 
             FloatTexture alphaTex = getAlphaTexture(sh.parameters, &sh.loc);
+            if (lazyBounds[i])
+                // Mark the remaining "plymesh" parameter as used so that
+                // errors are reported now rather than during rendering.
+                (void)sh.parameters.GetOneFloat("edgelength", 1.f);
             sh.parameters.ReportUnused();  // do now so can grab alpha...
 
             pbrt::Material mtl = nullptr;
@@ -1420,6 +1549,42 @@ Primitive BasicScene::CreateAggregate(
             pbrt::MediumInterface mi(findMedium(sh.insideMedium, &sh.loc),
                                      findMedium(sh.outsideMedium, &sh.loc));
 
+            if (lazyBounds[i]) {
+                // Defer creating the mesh and its BVH until it's first needed.
+                // Creation happens inside a render worker's parallel loop
+                // iteration, so it runs serially: a thread that helped
+                // with a nested parallel loop could otherwise pick up a
+                // render tile that waits on this very primitive.
+                auto create = [sh, mtl, mi, alphaTex,
+                               floatTextures = &textures.floatTextures]() mutable {
+                    SerialScope serial;
+                    Allocator alloc;
+                    pstd::vector<pbrt::Shape> shapes = Shape::Create(
+                        sh.name, sh.renderFromObject, sh.objectFromRender,
+                        sh.reverseOrientation, sh.parameters, *floatTextures, &sh.loc,
+                        alloc);
+                    sh.parameters.FreeParameters();
+
+                    std::vector<Primitive> prims;
+                    for (pbrt::Shape s : shapes) {
+                        if (!mi.IsMediumTransition() && !alphaTex)
+                            prims.push_back(new SimplePrimitive(s, mtl));
+                        else
+                            prims.push_back(new GeometricPrimitive(
+                                s, mtl, nullptr /* area light */, mi, alphaTex));
+                    }
+                    if (prims.empty())
+                        return Primitive(nullptr);
+                    if (prims.size() == 1)
+                        return prims[0];
+                    return Primitive(new BVHAggregate(std::move(prims)));
+                };
+                primitives.push_back(new LazyPrimitive(*lazyBounds[i], create));
+                ++nLazyShapes;
+                sh = ShapeSceneEntity();
+                continue;
+            }
+
             auto iter = shapeIndexToAreaLights.find(i);
             for (size_t j = 0; j < shapes.size(); ++j) {
                 // Possibly create area light for shape
@@ -1580,6 +1745,12 @@ Primitive BasicScene::CreateAggregate(
     instances.shrink_to_fit();
     LOG_VERBOSE("Finished instances");
 
+    // Reserve mesh indices for lazily-created shapes before rendering starts
+    if (nLazyShapes > 0) {
+        Triangle::ReserveMeshes(nLazyShapes);
+        BilinearPatch::ReserveMeshes(nLazyShapes);
+    }
+
     // Accelerator
     Primitive aggregate = nullptr;
     LOG_VERBOSE("Starting top-level accelerator");
@@ -370,6 +370,10 @@ class BasicScene {
     std::vector<std::pair<std::string, TextureSceneEntity>> serialSpectrumTextures;
     std::vector<std::pair<std::string, TextureSceneEntity>> asyncSpectrumTextures;
     std::set<std::string> loadingTextureFilenames;
+    // Textures that depend only on $(u,v)$ and repeat over $[0,1]^2$, and the
+    // resolutions of the serial textures to bake, indexed by position
+    std::set<std::string> uvFloatTextures, uvSpectrumTextures;
+    std::map<size_t, int> serialFloatBakeResolutions, serialSpectrumBakeResolutions;
     std::map<std::string, AsyncJob<FloatTexture> *> floatTextureJobs;
     std::map<std::string, AsyncJob<SpectrumTexture> *> spectrumTextureJobs;
     int nMissingTextures = 0;
@@ -430,7 +434,7 @@ class BasicSceneBuilder : public ParserTarget {
 
     void EndOfFiles();
 
-    BasicSceneBuilder *CopyForImport();
+    BasicSceneBuilder *CopyForImport(FileLoc loc);
     void MergeImported(BasicSceneBuilder *);
 
     std::string ToString() const;
@@ -149,6 +149,7 @@ std::string TriangleIntersection::ToString() const {
 }
 
 pstd::vector<const TriangleMesh *> *Triangle::allMeshes;
+bool Triangle::meshesReserved;
 #if defined(PBRT_BUILD_GPU_RENDERER)
 PBRT_GPU pstd::vector<const TriangleMesh *> *allTriangleMeshesGPU;
 #endif
@@ -162,6 +163,13 @@ void Triangle::Init(Allocator alloc) {
 #endif
 }
 
+void Triangle::ReserveMeshes(size_t n) {
+    // Make room for meshes that are created while rendering, so that adding
+    // them never reallocates _allMeshes_ while other threads read it
+    allMeshes->reserve(allMeshes->size() + n);
+    meshesReserved = true;
+}
+
 STAT_MEMORY_COUNTER("Memory/Triangles", triangleBytes);
 
 // Triangle Functions
@@ -273,6 +281,9 @@ pstd::vector<Shape> Triangle::CreateTriangles(const TriangleMesh *mesh, Allocato
     static std::mutex allMeshesLock;
     allMeshesLock.lock();
     CHECK_LT(allMeshes->size(), 1 << 31);
+    // Other threads may be reading _allMeshes_ once its space has been reserved
+    if (meshesReserved)
+        CHECK_LT(allMeshes->size(), allMeshes->capacity());
     int meshIndex = int(allMeshes->size());
     allMeshes->push_back(mesh);
     allMeshesLock.unlock();
@@ -290,8 +301,8 @@ pstd::vector<Shape> Triangle::CreateTriangles(const TriangleMesh *mesh, Allocato
 PBRT_CPU_GPU Bounds3f Triangle::Bounds() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
     const TriangleMesh *mesh = GetMesh();
-    const int *v = &mesh->vertexIndices[3 * triIndex];
-    Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+    pstd::array<int, 3> v = mesh->Indices(triIndex);
+    Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
     return Union(Bounds3f(p0, p1), p2);
 }
@@ -299,13 +310,13 @@ PBRT_CPU_GPU Bounds3f Triangle::Bounds() const {
 PBRT_CPU_GPU DirectionCone Triangle::NormalBounds() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
     const TriangleMesh *mesh = GetMesh();
-    const int *v = &mesh->vertexIndices[3 * triIndex];
-    Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+    pstd::array<int, 3> v = mesh->Indices(triIndex);
+    Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
     Normal3f n = Normalize(Normal3f(Cross(p1 - p0, p2 - p0)));
     // Ensure correct orientation of geometric normal for normal bounds
-    if (mesh->n) {
-        Normal3f ns(mesh->n[v[0]] + mesh->n[v[1]] + mesh->n[v[2]]);
+    if (mesh->HasNormals()) {
+        Normal3f ns(mesh->N(v[0]) + mesh->N(v[1]) + mesh->N(v[2]));
         n = FaceForward(n, ns);
     } else if (mesh->reverseOrientation ^ mesh->transformSwapsHandedness)
         n *= -1;
@@ -319,8 +330,8 @@ PBRT_CPU_GPU pstd::optional<ShapeIntersection> Triangle::Intersect(const Ray &ra
 #endif
     // Get triangle vertices in _p0_, _p1_, and _p2_
     const TriangleMesh *mesh = GetMesh();
-    const int *v = &mesh->vertexIndices[3 * triIndex];
-    Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+    pstd::array<int, 3> v = mesh->Indices(triIndex);
+    Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
     pstd::optional<TriangleIntersection> triIsect =
         IntersectTriangle(ray, tMax, p0, p1, p2);
@@ -340,8 +351,8 @@ PBRT_CPU_GPU bool Triangle::IntersectP(const Ray &ray, Float tMax) const {
 #endif
     // Get triangle vertices in _p0_, _p1_, and _p2_
     const TriangleMesh *mesh = GetMesh();
-    const int *v = &mesh->vertexIndices[3 * triIndex];
-    Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+    pstd::array<int, 3> v = mesh->Indices(triIndex);
+    Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
     pstd::optional<TriangleIntersection> isect = IntersectTriangle(ray, tMax, p0, p1, p2);
     if (isect) {
@@ -356,10 +367,10 @@ PBRT_CPU_GPU bool Triangle::IntersectP(const Ray &ray, Float tMax) const {
 std::string Triangle::ToString() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
     auto mesh = GetMesh();
-    const int *v = &mesh->vertexIndices[3 * triIndex];
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    pstd::array<int, 3> v = mesh->Indices(triIndex);
+    Point3f p0 = mesh->P(v[0]);
+    Point3f p1 = mesh->P(v[1]);
+    Point3f p2 = mesh->P(v[2]);
 
     return StringPrintf("[ Triangle meshIndex: %d triIndex: %d -> p [ %s %s %s ] ]",
                         meshIndex, triIndex, p0, p1, p2);
@@ -434,7 +445,8 @@ TriangleMesh *Triangle::CreateMesh(const Transform *renderFromObject,
 
     return alloc.new_object<TriangleMesh>(
         *renderFromObject, reverseOrientation, std::move(vi), std::move(P), std::move(S),
-        std::move(N), std::move(uvs), std::move(faceIndices), alloc);
+        std::move(N), std::move(uvs), std::move(faceIndices), alloc,
+        Options->compressGeometry && !Options->useGPU, Options->quantizePositions);
 }
 
 STAT_MEMORY_COUNTER("Memory/Curves", curveBytes);
@@ -1003,6 +1015,9 @@ pstd::vector<Shape> BilinearPatch::CreatePatches(const BilinearPatchMesh *mesh,
     static std::mutex allMeshesLock;
     allMeshesLock.lock();
     CHECK_LT(allMeshes->size(), 1 << 31);
+    // Other threads may be reading _allMeshes_ once its space has been reserved
+    if (meshesReserved)
+        CHECK_LT(allMeshes->size(), allMeshes->capacity());
     int meshIndex = int(allMeshes->size());
     allMeshes->push_back(mesh);
     allMeshesLock.unlock();
@@ -1018,6 +1033,7 @@ pstd::vector<Shape> BilinearPatch::CreatePatches(const BilinearPatchMesh *mesh,
 }
 
 pstd::vector<const BilinearPatchMesh *> *BilinearPatch::allMeshes;
+bool BilinearPatch::meshesReserved;
 #if defined(PBRT_BUILD_GPU_RENDERER)
 PBRT_GPU pstd::vector<const BilinearPatchMesh *> *allBilinearMeshesGPU;
 #endif
@@ -1032,6 +1048,12 @@ void BilinearPatch::Init(Allocator alloc) {
 #endif
 }
 
+void BilinearPatch::ReserveMeshes(size_t n) {
+    // See the comment in _Triangle::ReserveMeshes()_
+    allMeshes->reserve(allMeshes->size() + n);
+    meshesReserved = true;
+}
+
 STAT_MEMORY_COUNTER("Memory/Bilinear patches", blpBytes);
 
 // BilinearPatch Method Definitions
@@ -1455,10 +1477,21 @@ pstd::vector<Shape> Shape::Create(
         }
 
         if (!plyMesh.triIndices.empty()) {
-            TriangleMesh *mesh = alloc.new_object<TriangleMesh>(
-                *renderFromObject, reverseOrientation, plyMesh.triIndices, plyMesh.p,
-                std::vector<Vector3f>(), plyMesh.n, plyMesh.uv, plyMesh.faceIndices,
-                alloc);
+            bool compress = Options->compressGeometry && !Options->useGPU;
+            TriangleMesh *mesh;
+            if (plyMesh.quadIndices.empty())
+                // The vertex data isn't needed afterward, so avoid copying it
+                mesh = alloc.new_object<TriangleMesh>(
+                    *renderFromObject, reverseOrientation,
+                    std::move(plyMesh.triIndices), std::move(plyMesh.p),
+                    std::vector<Vector3f>(), std::move(plyMesh.n), std::move(plyMesh.uv),
+                    std::move(plyMesh.faceIndices), alloc, compress,
+                    Options->quantizePositions);
+            else
+                mesh = alloc.new_object<TriangleMesh>(
+                    *renderFromObject, reverseOrientation, plyMesh.triIndices, plyMesh.p,
+                    std::vector<Vector3f>(), plyMesh.n, plyMesh.uv, plyMesh.faceIndices,
+                    alloc, compress, Options->quantizePositions);
             shapes = Triangle::CreateTriangles(mesh, alloc);
         }
 
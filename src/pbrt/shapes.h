@@ -834,6 +834,7 @@ class Triangle {
   public:
     // Triangle Public Methods
     static pstd::vector<Shape> CreateTriangles(const TriangleMesh *mesh, Allocator alloc);
+    static void ReserveMeshes(size_t n);
 
     Triangle() = default;
     Triangle(int meshIndex, int triIndex) : meshIndex(meshIndex), triIndex(triIndex) {}
@@ -853,8 +854,8 @@ class Triangle {
     Float Area() const {
         // Get triangle vertices in _p0_, _p1_, and _p2_
         const TriangleMesh *mesh = GetMesh();
-        const int *v = &mesh->vertexIndices[3 * triIndex];
-        Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+        pstd::array<int, 3> v = mesh->Indices(triIndex);
+        Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
         return 0.5f * Length(Cross(p1 - p0, p2 - p0));
     }
@@ -873,8 +874,8 @@ class Triangle {
     Float SolidAngle(Point3f p) const {
         // Get triangle vertices in _p0_, _p1_, and _p2_
         const TriangleMesh *mesh = GetMesh();
-        const int *v = &mesh->vertexIndices[3 * triIndex];
-        Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+        pstd::array<int, 3> v = mesh->Indices(triIndex);
+        Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
         return SphericalTriangleArea(Normalize(p0 - p), Normalize(p1 - p),
                                      Normalize(p2 - p));
@@ -885,15 +886,15 @@ class Triangle {
                                                           int triIndex,
                                                           TriangleIntersection ti,
                                                           Float time, Vector3f wo) {
-        const int *v = &mesh->vertexIndices[3 * triIndex];
-        Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+        pstd::array<int, 3> v = mesh->Indices(triIndex);
+        Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
         // Compute triangle partial derivatives
         // Compute deltas and matrix determinant for triangle partial derivatives
         // Get triangle texture coordinates in _uv_ array
         pstd::array<Point2f, 3> uv =
-            mesh->uv
+            mesh->HasUVs()
                 ? pstd::array<Point2f, 3>(
-                      {mesh->uv[v[0]], mesh->uv[v[1]], mesh->uv[v[2]]})
+                      {mesh->UV(v[0]), mesh->UV(v[1]), mesh->UV(v[2])})
                 : pstd::array<Point2f, 3>({Point2f(0, 0), Point2f(1, 0), Point2f(1, 1)});
 
         Vector2f duv02 = uv[0] - uv[2], duv12 = uv[1] - uv[2];
@@ -937,13 +938,13 @@ class Triangle {
         if (mesh->reverseOrientation ^ mesh->transformSwapsHandedness)
             isect.n = isect.shading.n = -isect.n;
 
-        if (mesh->n || mesh->s) {
+        if (mesh->HasNormals() || mesh->s) {
             // Initialize _Triangle_ shading geometry
             // Compute shading normal _ns_ for triangle
             Normal3f ns;
-            if (mesh->n) {
+            if (mesh->HasNormals()) {
                 ns =
-                    ti.b0 * mesh->n[v[0]] + ti.b1 * mesh->n[v[1]] + ti.b2 * mesh->n[v[2]];
+                    ti.b0 * mesh->N(v[0]) + ti.b1 * mesh->N(v[1]) + ti.b2 * mesh->N(v[2]);
                 ns = LengthSquared(ns) > 0 ? Normalize(ns) : isect.n;
             } else
                 ns = isect.n;
@@ -967,12 +968,12 @@ class Triangle {
 
             // Compute $\dndu$ and $\dndv$ for triangle shading geometry
             Normal3f dndu, dndv;
-            if (mesh->n) {
+            if (mesh->HasNormals()) {
                 // Compute deltas for triangle partial derivatives of normal
                 Vector2f duv02 = uv[0] - uv[2];
                 Vector2f duv12 = uv[1] - uv[2];
-                Normal3f dn1 = mesh->n[v[0]] - mesh->n[v[2]];
-                Normal3f dn2 = mesh->n[v[1]] - mesh->n[v[2]];
+                Normal3f dn1 = mesh->N(v[0]) - mesh->N(v[2]);
+                Normal3f dn2 = mesh->N(v[1]) - mesh->N(v[2]);
 
                 Float determinant =
                     DifferenceOfProducts(duv02[0], duv12[1], duv02[1], duv12[0]);
@@ -984,8 +985,8 @@ class Triangle {
                     // (rather than giving up) so that ray differentials for
                     // rays reflected from triangles with degenerate
                     // parameterizations are still reasonable.
-                    Vector3f dn = Cross(Vector3f(mesh->n[v[2]] - mesh->n[v[0]]),
-                                        Vector3f(mesh->n[v[1]] - mesh->n[v[0]]));
+                    Vector3f dn = Cross(Vector3f(mesh->N(v[2]) - mesh->N(v[0])),
+                                        Vector3f(mesh->N(v[1]) - mesh->N(v[0])));
 
                     if (LengthSquared(dn) == 0)
                         dndu = dndv = Normal3f(0, 0, 0);
@@ -1013,8 +1014,8 @@ class Triangle {
     pstd::optional<ShapeSample> Sample(Point2f u) const {
         // Get triangle vertices in _p0_, _p1_, and _p2_
         const TriangleMesh *mesh = GetMesh();
-        const int *v = &mesh->vertexIndices[3 * triIndex];
-        Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+        pstd::array<int, 3> v = mesh->Indices(triIndex);
+        Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
         // Sample point on triangle uniformly by area
         pstd::array<Float, 3> b = SampleUniformTriangle(u);
@@ -1022,9 +1023,9 @@ class Triangle {
 
         // Compute surface normal for sampled point on triangle
         Normal3f n = Normalize(Normal3f(Cross(p1 - p0, p2 - p0)));
-        if (mesh->n) {
-            Normal3f ns(b[0] * mesh->n[v[0]] + b[1] * mesh->n[v[1]] +
-                        (1 - b[0] - b[1]) * mesh->n[v[2]]);
+        if (mesh->HasNormals()) {
+            Normal3f ns(b[0] * mesh->N(v[0]) + b[1] * mesh->N(v[1]) +
+                        (1 - b[0] - b[1]) * mesh->N(v[2]));
             n = FaceForward(n, ns);
         } else if (mesh->reverseOrientation ^ mesh->transformSwapsHandedness)
             n *= -1;
@@ -1032,9 +1033,9 @@ class Triangle {
         // Compute $(u,v)$ for sampled point on triangle
         // Get triangle texture coordinates in _uv_ array
         pstd::array<Point2f, 3> uv =
-            mesh->uv
+            mesh->HasUVs()
                 ? pstd::array<Point2f, 3>(
-                      {mesh->uv[v[0]], mesh->uv[v[1]], mesh->uv[v[2]]})
+                      {mesh->UV(v[0]), mesh->UV(v[1]), mesh->UV(v[2])})
                 : pstd::array<Point2f, 3>({Point2f(0, 0), Point2f(1, 0), Point2f(1, 1)});
 
         Point2f uvSample = b[0] * uv[0] + b[1] * uv[1] + b[2] * uv[2];
@@ -1053,8 +1054,8 @@ class Triangle {
     pstd::optional<ShapeSample> Sample(const ShapeSampleContext &ctx, Point2f u) const {
         // Get triangle vertices in _p0_, _p1_, and _p2_
         const TriangleMesh *mesh = GetMesh();
-        const int *v = &mesh->vertexIndices[3 * triIndex];
-        Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+        pstd::array<int, 3> v = mesh->Indices(triIndex);
+        Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
         // Use uniform area sampling for numerically unstable cases
         Float solidAngle = SolidAngle(ctx.p());
@@ -1109,9 +1110,9 @@ class Triangle {
         Point3f p = b[0] * p0 + b[1] * p1 + b[2] * p2;
         // Compute surface normal for sampled point on triangle
         Normal3f n = Normalize(Normal3f(Cross(p1 - p0, p2 - p0)));
-        if (mesh->n) {
-            Normal3f ns(b[0] * mesh->n[v[0]] + b[1] * mesh->n[v[1]] +
-                        (1 - b[0] - b[1]) * mesh->n[v[2]]);
+        if (mesh->HasNormals()) {
+            Normal3f ns(b[0] * mesh->N(v[0]) + b[1] * mesh->N(v[1]) +
+                        (1 - b[0] - b[1]) * mesh->N(v[2]));
             n = FaceForward(n, ns);
         } else if (mesh->reverseOrientation ^ mesh->transformSwapsHandedness)
             n *= -1;
@@ -1119,9 +1120,9 @@ class Triangle {
         // Compute $(u,v)$ for sampled point on triangle
         // Get triangle texture coordinates in _uv_ array
         pstd::array<Point2f, 3> uv =
-            mesh->uv
+            mesh->HasUVs()
                 ? pstd::array<Point2f, 3>(
-                      {mesh->uv[v[0]], mesh->uv[v[1]], mesh->uv[v[2]]})
+                      {mesh->UV(v[0]), mesh->UV(v[1]), mesh->UV(v[2])})
                 : pstd::array<Point2f, 3>({Point2f(0, 0), Point2f(1, 0), Point2f(1, 1)});
 
         Point2f uvSample = b[0] * uv[0] + b[1] * uv[1] + b[2] * uv[2];
@@ -1154,8 +1155,8 @@ class Triangle {
         if (ctx.ns != Normal3f(0, 0, 0)) {
             // Get triangle vertices in _p0_, _p1_, and _p2_
             const TriangleMesh *mesh = GetMesh();
-            const int *v = &mesh->vertexIndices[3 * triIndex];
-            Point3f p0 = mesh->p[v[0]], p1 = mesh->p[v[1]], p2 = mesh->p[v[2]];
+            pstd::array<int, 3> v = mesh->Indices(triIndex);
+            Point3f p0 = mesh->P(v[0]), p1 = mesh->P(v[1]), p2 = mesh->P(v[2]);
 
             Point2f u = InvertSphericalTriangleSample({p0, p1, p2}, ctx.p(), wi);
             // Compute $\cos\theta$-based weights _w_ at sample domain corners
@@ -1187,6 +1188,7 @@ class Triangle {
     // Triangle Private Members
     int meshIndex = -1, triIndex = -1;
     static pstd::vector<const TriangleMesh *> *allMeshes;
+    static bool meshesReserved;
     static constexpr Float MinSphericalSampleArea = 3e-4;
     static constexpr Float MaxSphericalSampleArea = 6.22;
 };
@@ -1361,6 +1363,7 @@ class BilinearPatch {
 
     static pstd::vector<Shape> CreatePatches(const BilinearPatchMesh *mesh,
                                              Allocator alloc);
+    static void ReserveMeshes(size_t n);
 
     PBRT_CPU_GPU
     Bounds3f Bounds() const;
@@ -1534,6 +1537,7 @@ class BilinearPatch {
     // BilinearPatch Private Members
     int meshIndex, blpIndex;
     static pstd::vector<const BilinearPatchMesh *> *allMeshes;
+    static bool meshesReserved;
     Float area;
     static constexpr Float MinSphericalSampleArea = 1e-4;
 };
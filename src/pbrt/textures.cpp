@@ -14,6 +14,7 @@
 #include <pbrt/util/error.h>
 #include <pbrt/util/file.h>
 #include <pbrt/util/float.h>
+#include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/splines.h>
 #include <pbrt/util/stats.h>
@@ -1561,6 +1562,74 @@ SpectrumTexture SpectrumTexture::Create(const std::string &name,
     return tex;
 }
 
+// Texture Baking Function Definitions
+STAT_COUNTER("Texture/Baked textures", nBakedTextures);
+
+static TextureEvalContext BakeEvalContext(Point2i p, int resolution) {
+    // Evaluate at the texel's center, filtering over the texel; rows run
+    // downward in $v$ as in image textures
+    Point2f uv((p.x + 0.5f) / resolution, 1 - (p.y + 0.5f) / resolution);
+    Float width = Float(1) / resolution;
+    return TextureEvalContext(Point3f(), Vector3f(), Vector3f(), Normal3f(0, 0, 1), uv,
+                              width, 0, 0, width, 0);
+}
+
+static MIPMap *BakedMIPMap(Image image, const RGBColorSpace *colorSpace,
+                           Allocator alloc) {
+    ++nBakedTextures;
+    // Only textures that repeat over $[0,1]^2$ are baked, so repeating the
+    // image matches them outside of it
+    MIPMapFilterOptions options;
+    options.filter = FilterFunction::Trilinear;
+    return alloc.new_object<MIPMap>(std::move(image), colorSpace, WrapMode::Repeat,
+                                     alloc, options);
+}
+
+MIPMap *BakeTexture(FloatTexture tex, int resolution, const RGBColorSpace *colorSpace,
+                    Allocator alloc) {
+    Image image(PixelFormat::Float, Point2i(resolution, resolution), {"Y"}, nullptr,
+                alloc);
+    ParallelFor(0, resolution, [&](int64_t y) {
+        for (int x = 0; x < resolution; ++x) {
+            Point2i p(x, y);
+            image.SetChannel(p, 0, tex.Evaluate(BakeEvalContext(p, resolution)));
+        }
+    });
+    return BakedMIPMap(std::move(image), colorSpace, alloc);
+}
+
+MIPMap *BakeTexture(SpectrumTexture tex, int resolution,
+                    const RGBColorSpace *colorSpace, Allocator alloc) {
+    Image image(PixelFormat::Float, Point2i(resolution, resolution), {"R", "G", "B"},
+                nullptr, alloc);
+    ParallelFor(0, resolution, [&](int64_t y) {
+        for (int x = 0; x < resolution; ++x) {
+            Point2i p(x, y);
+            TextureEvalContext ctx = BakeEvalContext(p, resolution);
+#ifdef PBRT_RGB_RENDERING
+            SampledSpectrum s = tex.Evaluate(ctx, SampledWavelengths::RGBWavelengths());
+            RGB rgb = Mul<RGB>(colorSpace->reflectanceRGBFromRenderRGB,
+                               RGB(s[0], s[1], s[2]));
+#else
+            // Compute the texel's RGB reflectance under the color space's illuminant
+            constexpr int nLambdaSamples = 16;
+            XYZ xyz;
+            for (int i = 0; i < nLambdaSamples; ++i) {
+                SampledWavelengths lambda =
+                    SampledWavelengths::SampleVisible((i + 0.5f) / nLambdaSamples);
+                SampledSpectrum s =
+                    tex.Evaluate(ctx, lambda) * colorSpace->illuminant.Sample(lambda);
+                xyz += s.ToXYZ(lambda) / nLambdaSamples;
+            }
+            RGB rgb = colorSpace->ToRGB(xyz);
+#endif
+            for (int c = 0; c < 3; ++c)
+                image.SetChannel(p, c, rgb[c]);
+        }
+    });
+    return BakedMIPMap(std::move(image), colorSpace, alloc);
+}
+
 // UniversalTextureEvaluator Method Definitions
 Float UniversalTextureEvaluator::operator()(FloatTexture tex, TextureEvalContext ctx) {
     return tex.Evaluate(ctx);
@@ -549,6 +549,14 @@ class ImageTextureBase {
         textureCache[texInfo] = mipmap;
     }
 
+    ImageTextureBase(TextureMapping2D mapping, std::string filename, MIPMap *mipmap,
+                     Float scale, bool invert)
+        : mapping(mapping),
+          filename(filename),
+          scale(scale),
+          invert(invert),
+          mipmap(mipmap) {}
+
     static void ClearCache() { textureCache.clear(); }
 
     void MultiplyScale(Float s) { scale *= s; }
@@ -575,6 +583,9 @@ class FloatImageTexture : public ImageTextureBase {
                       bool invert, ColorEncoding encoding, Allocator alloc)
         : ImageTextureBase(m, filename, filterOptions, wm, scale, invert, encoding,
                            alloc) {}
+    FloatImageTexture(TextureMapping2D m, const std::string &filename, MIPMap *mipmap,
+                      Float scale, bool invert)
+        : ImageTextureBase(m, filename, mipmap, scale, invert) {}
     PBRT_CPU_GPU
     Float Evaluate(TextureEvalContext ctx) const {
 #ifdef PBRT_IS_GPU_CODE
@@ -608,6 +619,10 @@ class SpectrumImageTexture : public ImageTextureBase {
         : ImageTextureBase(mapping, filename, filterOptions, wrapMode, scale, invert,
                            encoding, alloc),
           spectrumType(spectrumType) {}
+    SpectrumImageTexture(TextureMapping2D mapping, std::string filename, MIPMap *mipmap,
+                         Float scale, bool invert, SpectrumType spectrumType)
+        : ImageTextureBase(mapping, filename, mipmap, scale, invert),
+          spectrumType(spectrumType) {}
 
     PBRT_CPU_GPU
     SampledSpectrum Evaluate(TextureEvalContext ctx, SampledWavelengths lambda) const;
@@ -1136,6 +1151,12 @@ inline SampledSpectrum SpectrumTexture::Evaluate(TextureEvalContext ctx,
     return Dispatch(eval);
 }
 
+// Texture Baking Function Declarations
+MIPMap *BakeTexture(FloatTexture tex, int resolution, const RGBColorSpace *colorSpace,
+                    Allocator alloc);
+MIPMap *BakeTexture(SpectrumTexture tex, int resolution,
+                    const RGBColorSpace *colorSpace, Allocator alloc);
+
 // UniversalTextureEvaluator Definition
 class UniversalTextureEvaluator {
   public:
@@ -0,0 +1,65 @@
+// pbrt is Copyright(c) 1998-2020 Matt Pharr, Wenzel Jakob, and Greg Humphreys.
+// The pbrt source code is licensed under the Apache License, Version 2.0.
+// SPDX: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <pbrt/pbrt.h>
+#include <pbrt/textures.h>
+#include <pbrt/util/colorspace.h>
+#include <pbrt/util/image.h>
+#include <pbrt/util/mipmap.h>
+#include <pbrt/util/spectrum.h>
+
+using namespace pbrt;
+
+// Returns the context that texel _p_ of a baked image was evaluated with,
+// offset by _offset_ in $(u,v)$.
+static TextureEvalContext BakedTexelContext(Point2i p, int resolution,
+                                            Vector2f offset) {
+    Point2f uv((p.x + 0.5f) / resolution, 1 - (p.y + 0.5f) / resolution);
+    Float width = Float(1) / resolution;
+    return TextureEvalContext(Point3f(), Vector3f(), Vector3f(), Normal3f(0, 0, 1),
+                              uv + offset, width, 0, 0, width, 0);
+}
+
+TEST(Texture, BakeFloat) {
+    // A checkerboard over whole periods scaled by a second one, as baking
+    // requires of textures that repeat over $[0,1]^2$
+    UVMapping mapping4(4, 4), mapping2(2, -6, 0.5f, 0.25f);
+    FloatConstantTexture c0(0.25f), c1(1.5f), c2(0.5f), c3(2.f);
+    FloatCheckerboardTexture checks4(&mapping4, nullptr, &c0, &c1);
+    FloatCheckerboardTexture checks2(&mapping2, nullptr, &c2, &c3);
+    FloatScaledTexture tex(&checks4, &checks2);
+
+    int resolution = 64;
+    MIPMap *mipmap =
+        BakeTexture(FloatTexture(&tex), resolution, RGBColorSpace::sRGB, Allocator());
+    const Image &image = mipmap->GetLevel(0);
+    ASSERT_EQ(Point2i(resolution, resolution), image.Resolution());
+
+    // Baked texels should match the source, including where the baked image
+    // repeats outside $[0,1]^2$
+    for (int y = 0; y < resolution; ++y)
+        for (int x = 0; x < resolution; ++x)
+            for (Vector2f offset : {Vector2f(0, 0), Vector2f(1, 0), Vector2f(-1, 2)}) {
+                Point2i p(x, y);
+                Float v = tex.Evaluate(BakedTexelContext(p, resolution, offset));
+                EXPECT_NEAR(v, image.GetChannel(p, 0), 1e-4f) << p << " " << offset;
+            }
+}
+
+TEST(Texture, BakeSpectrum) {
+    RGB rgb(0.2f, 0.4f, 0.6f);
+    RGBUnboundedSpectrum spec(*RGBColorSpace::sRGB, rgb);
+    SpectrumConstantTexture tex(&spec);
+
+    int resolution = 4;
+    MIPMap *mipmap = BakeTexture(SpectrumTexture(&tex), resolution, RGBColorSpace::sRGB,
+                                 Allocator());
+    const Image &image = mipmap->GetLevel(0);
+    for (int y = 0; y < resolution; ++y)
+        for (int x = 0; x < resolution; ++x)
+            for (int c = 0; c < 3; ++c)
+                EXPECT_NEAR(rgb[c], image.GetChannel({x, y}, c), 0.01f);
+}
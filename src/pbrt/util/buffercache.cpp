@@ -14,6 +14,10 @@ BufferCache<Point2f> *point2BufferCache;
 BufferCache<Point3f> *point3BufferCache;
 BufferCache<Vector3f> *vector3BufferCache;
 BufferCache<Normal3f> *normal3BufferCache;
+BufferCache<uint16_t> *uint16BufferCache;
+BufferCache<uint64_t> *uint64BufferCache;
+BufferCache<OctahedralVector> *octahedralVectorBufferCache;
+BufferCache<Half> *halfBufferCache;
 
 void InitBufferCaches() {
     CHECK(intBufferCache == nullptr);
@@ -22,6 +26,10 @@ void InitBufferCaches() {
     point3BufferCache = new BufferCache<Point3f>;
     vector3BufferCache = new BufferCache<Vector3f>;
     normal3BufferCache = new BufferCache<Normal3f>;
+    uint16BufferCache = new BufferCache<uint16_t>;
+    uint64BufferCache = new BufferCache<uint64_t>;
+    octahedralVectorBufferCache = new BufferCache<OctahedralVector>;
+    halfBufferCache = new BufferCache<Half>;
 }
 
 }  // namespace pbrt
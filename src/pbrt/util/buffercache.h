@@ -8,6 +8,7 @@
 #include <pbrt/pbrt.h>
 
 #include <pbrt/util/check.h>
+#include <pbrt/util/float.h>
 #include <pbrt/util/hash.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/pstd.h>
@@ -108,6 +109,10 @@ extern BufferCache<Point2f> *point2BufferCache;
 extern BufferCache<Point3f> *point3BufferCache;
 extern BufferCache<Vector3f> *vector3BufferCache;
 extern BufferCache<Normal3f> *normal3BufferCache;
+extern BufferCache<uint16_t> *uint16BufferCache;
+extern BufferCache<uint64_t> *uint64BufferCache;
+extern BufferCache<OctahedralVector> *octahedralVectorBufferCache;
+extern BufferCache<Half> *halfBufferCache;
 
 void InitBufferCaches();
 
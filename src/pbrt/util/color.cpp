@@ -28,6 +28,16 @@ std::string RGBSigmoidPolynomial::ToString() const {
 }
 
 // RGBToSpectrumTable Method Definitions
+RGBToSpectrumTable::RGBToSpectrumTable(const float *zNodes,
+                                       const CoefficientArray *coeffs)
+    : zNodes(zNodes), coeffs(coeffs) {
+    // Initialize _zIndex_ with the intervals at the start of each of its cells
+    for (int k = 0; k < zIndexRes; ++k) {
+        float z = float(k) / zIndexRes;
+        zIndex[k] = FindInterval(res, [&](int i) { return zNodes[i] < z; });
+    }
+}
+
 PBRT_CPU_GPU RGBSigmoidPolynomial RGBToSpectrumTable::operator()(RGB rgb) const {
     DCHECK(rgb[0] >= 0.f && rgb[1] >= 0.f && rgb[2] >= 0.f && rgb[0] <= 1.f &&
            rgb[1] <= 1.f && rgb[2] <= 1.f);
@@ -46,7 +56,7 @@ PBRT_CPU_GPU RGBSigmoidPolynomial RGBToSpectrumTable::operator()(RGB rgb) const
 
     // Compute integer indices and offsets for coefficient interpolation
     int xi = std::min((int)x, res - 2), yi = std::min((int)y, res - 2),
-        zi = FindInterval(res, [&](int i) { return zNodes[i] < z; });
+        zi = ZInterval(z);
     Float dx = x - xi, dy = y - yi, dz = (z - zNodes[zi]) / (zNodes[zi + 1] - zNodes[zi]);
 
     // Trilinearly interpolate sigmoid polynomial coefficients _c_
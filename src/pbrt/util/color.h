@@ -369,16 +369,26 @@ class RGBToSpectrumTable {
   public:
     // RGBToSpectrumTable Public Constants
     static constexpr int res = 64;
+    static constexpr int zIndexRes = 256;
 
     using CoefficientArray = float[3][res][res][res][3];
 
     // RGBToSpectrumTable Public Methods
-    RGBToSpectrumTable(const float *zNodes, const CoefficientArray *coeffs)
-        : zNodes(zNodes), coeffs(coeffs) {}
+    RGBToSpectrumTable(const float *zNodes, const CoefficientArray *coeffs);
 
     PBRT_CPU_GPU
     RGBSigmoidPolynomial operator()(RGB rgb) const;
 
+    PBRT_CPU_GPU
+    int ZInterval(float z) const {
+        // The $z$ interval is found starting from the one given by _zIndex_; only
+        // a few nodes fall in a single _zIndex_ cell, even where they are densest.
+        int zi = zIndex[std::min<int>(z * zIndexRes, zIndexRes - 1)];
+        while (zi < res - 2 && zNodes[zi + 1] < z)
+            ++zi;
+        return zi;
+    }
+
     static void Init(Allocator alloc);
 
     static const RGBToSpectrumTable *sRGB;
@@ -392,6 +402,8 @@ class RGBToSpectrumTable {
     // RGBToSpectrumTable Private Members
     const float *zNodes;
     const CoefficientArray *coeffs;
+    // _zIndex[k]_ is the _zNodes_ interval containing _k_ / _zIndexRes_
+    pstd::array<uint8_t, zIndexRes> zIndex;
 };
 
 // ColorEncoding Definitions
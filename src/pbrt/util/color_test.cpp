@@ -8,6 +8,8 @@
 
 #include <pbrt/util/color.h>
 #include <pbrt/util/colorspace.h>
+#include <pbrt/util/float.h>
+#include <pbrt/util/math.h>
 #include <pbrt/util/sampling.h>
 #include <pbrt/util/spectrum.h>
 
@@ -125,6 +127,8 @@ TEST(RGBAlbedoSpectrum, MaxValue) {
     }
 }
 
+#ifndef PBRT_RGB_RENDERING
+// These check the spectra computed for RGB values, which RGB rendering doesn't use
 TEST(RGBAlbedoSpectrum, RoundTripsRGB) {
     RNG rng;
     const RGBColorSpace &cs = *RGBColorSpace::sRGB;
@@ -268,6 +272,7 @@ TEST(RGBIlluminantSpectrum, RoundTripACES) {
             << rgb << " vs " << rgb2 << " xyz " << xyz;
     }
 }
+#endif  // !PBRT_RGB_RENDERING
 
 TEST(sRGB, Conversion) {
     // Check the basic 8 bit values
@@ -292,3 +297,33 @@ TEST(sRGB, Conversion) {
             << StringPrintf("i = %d -> linear %f -> srgb %f", i, x, y);
     }
 }
+
+TEST(RGBToSpectrumTable, ZInterval) {
+    // Nodes spaced as in the generated tables, which cluster them toward
+    // both ends, and nodes packed into a narrow range
+    constexpr int res = RGBToSpectrumTable::res;
+    auto smoothstep = [](float x) { return x * x * (3 - 2 * x); };
+    float generated[res], packed[res];
+    for (int i = 0; i < res; ++i) {
+        float x = float(i) / (res - 1);
+        generated[i] = smoothstep(smoothstep(x));
+        packed[i] = i < 2 ? x : 0.5f + 1e-4f * x;
+    }
+    packed[res - 1] = 1;
+
+    for (const float *zNodes : {generated, packed}) {
+        RGBToSpectrumTable table(zNodes, nullptr);
+        auto check = [&](float z) {
+            int zi = FindInterval(res, [&](int i) { return zNodes[i] < z; });
+            EXPECT_EQ(zi, table.ZInterval(z)) << "z = " << z;
+        };
+        // Sweep $z$ finely and check the nodes and their neighbors
+        for (int k = 0; k <= 1 << 16; ++k)
+            check(float(k) / (1 << 16));
+        for (int i = 0; i < res; ++i) {
+            check(zNodes[i]);
+            check(NextFloatDown(zNodes[i]));
+            check(std::min(NextFloatUp(zNodes[i]), 1.f));
+        }
+    }
+}
@@ -32,6 +32,22 @@ RGBColorSpace::RGBColorSpace(Point2f r, Point2f g, Point2f b, Spectrum illuminan
     XYZ C = InvertOrExit(rgb) * W;
     XYZFromRGB = rgb * SquareMatrix<3>::Diag(C[0], C[1], C[2]);
     RGBFromXYZ = InvertOrExit(XYZFromRGB);
+
+#ifdef PBRT_RGB_RENDERING
+    // Compute conversions to and from the sRGB rendering color space
+    XYZ sR = XYZ::FromxyY(Point2f(.64, .33)), sG = XYZ::FromxyY(Point2f(.3, .6));
+    XYZ sB = XYZ::FromxyY(Point2f(.15, .06));
+    XYZ sW = SpectrumToXYZ(GetNamedSpectrum("stdillum-D65"));
+    SquareMatrix<3> sRGBPrim(sR.X, sG.X, sB.X, sR.Y, sG.Y, sB.Y, sR.Z, sG.Z, sB.Z);
+    XYZ sC = InvertOrExit(sRGBPrim) * sW;
+    SquareMatrix<3> renderRGBFromXYZ =
+        InvertOrExit(sRGBPrim * SquareMatrix<3>::Diag(sC[0], sC[1], sC[2]));
+    renderRGBFromRGB = renderRGBFromXYZ * XYZFromRGB;
+    RGBFromRenderRGB = InvertOrExit(renderRGBFromRGB);
+    renderRGBFromReflectanceRGB =
+        renderRGBFromXYZ * WhiteBalance(w, sW.xy()) * XYZFromRGB;
+    reflectanceRGBFromRenderRGB = InvertOrExit(renderRGBFromReflectanceRGB);
+#endif
 }
 
 SquareMatrix<3> ConvertRGBColorSpace(const RGBColorSpace &from, const RGBColorSpace &to) {
@@ -33,6 +33,13 @@ class RGBColorSpace {
     DenselySampledSpectrum illuminant;
     SquareMatrix<3> XYZFromRGB, RGBFromXYZ;
     static const RGBColorSpace *sRGB, *DCI_P3, *Rec2020, *ACES2065_1;
+#ifdef PBRT_RGB_RENDERING
+    // RGB rendering represents all spectra in linear sRGB. These matrices
+    // convert to and from it; reflectances are also white balanced so that
+    // RGB white remains a perfect reflector, as with the spectral uplifting.
+    SquareMatrix<3> renderRGBFromRGB, RGBFromRenderRGB;
+    SquareMatrix<3> renderRGBFromReflectanceRGB, reflectanceRGBFromRenderRGB;
+#endif
 
     PBRT_CPU_GPU
     bool operator==(const RGBColorSpace &cs) const {
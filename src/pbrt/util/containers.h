@@ -761,26 +761,63 @@ class HashMap {
 };
 
 // SampledGrid Definition
+// Samples are stored in _BrickSize_^3 bricks that are found through an
+// indirection table; bricks where all samples have the same value, as is
+// common in empty regions of volumes, store that value just once.
 template <typename T>
 class SampledGrid {
   public:
-    using const_iterator = typename pstd::vector<T>::const_iterator;
     // SampledGrid Public Methods
     SampledGrid() = default;
-    SampledGrid(Allocator alloc) : values(alloc) {}
+    SampledGrid(Allocator alloc) : values(alloc), brickOffsets(alloc) {}
     SampledGrid(pstd::span<const T> v, int nx, int ny, int nz, Allocator alloc)
-        : values(v.begin(), v.end(), alloc), nx(nx), ny(ny), nz(nz) {
-        CHECK_EQ(nx * ny * nz, values.size());
+        : values(alloc), brickOffsets(alloc), nx(nx), ny(ny), nz(nz) {
+        CHECK_EQ(nx * ny * nz, v.size());
+        nBricks = Point3i((nx + BrickSize - 1) / BrickSize,
+                          (ny + BrickSize - 1) / BrickSize,
+                          (nz + BrickSize - 1) / BrickSize);
+        brickOffsets.resize(nBricks.x * nBricks.y * nBricks.z);
+        std::vector<T> brick(BrickSize * BrickSize * BrickSize);
+        for (int bz = 0; bz < nBricks.z; ++bz)
+            for (int by = 0; by < nBricks.y; ++by)
+                for (int bx = 0; bx < nBricks.x; ++bx) {
+                    // Gather samples for brick and check if they are all equal
+                    Point3i p0(bx * BrickSize, by * BrickSize, bz * BrickSize);
+                    const T &first = v[(p0.z * ny + p0.y) * nx + p0.x];
+                    bool constant = true;
+                    for (int z = 0; z < BrickSize; ++z)
+                        for (int y = 0; y < BrickSize; ++y)
+                            for (int x = 0; x < BrickSize; ++x) {
+                                Point3i p = p0 + Vector3i(x, y, z);
+                                T &b = brick[(z * BrickSize + y) * BrickSize + x];
+                                if (p.x >= nx || p.y >= ny || p.z >= nz) {
+                                    b = T{};
+                                    continue;
+                                }
+                                b = v[(p.z * ny + p.y) * nx + p.x];
+                                constant &= std::memcmp(&b, &first, sizeof(T)) == 0;
+                            }
+
+                    // Store brick's samples and record their offset
+                    int &offset = brickOffsets[(bz * nBricks.y + by) * nBricks.x + bx];
+                    if (constant) {
+                        offset = ~int(values.size());
+                        values.push_back(first);
+                    } else {
+                        offset = int(values.size());
+                        for (const T &value : brick)
+                            values.push_back(value);
+                    }
+                }
     }
 
-    PBRT_CPU_GPU size_t BytesAllocated() const { return values.size() * sizeof(T); }
+    PBRT_CPU_GPU size_t BytesAllocated() const {
+        return values.size() * sizeof(T) + brickOffsets.size() * sizeof(int);
+    }
     PBRT_CPU_GPU int XSize() const { return nx; }
     PBRT_CPU_GPU int YSize() const { return ny; }
     PBRT_CPU_GPU int ZSize() const { return nz; }
 
-    const_iterator begin() const { return values.begin(); }
-    const_iterator end() const { return values.end(); }
-
     template <typename F>
     PBRT_CPU_GPU auto Lookup(Point3f p, F convert) const {
         // Compute voxel coordinates and offsets for _p_
@@ -789,14 +826,13 @@ class SampledGrid {
         Vector3f d = pSamples - (Point3f)pi;
 
         // Return trilinearly interpolated voxel values
-        auto d00 =
-            Lerp(d.x, Lookup(pi, convert), Lookup(pi + Vector3i(1, 0, 0), convert));
-        auto d10 = Lerp(d.x, Lookup(pi + Vector3i(0, 1, 0), convert),
-                        Lookup(pi + Vector3i(1, 1, 0), convert));
-        auto d01 = Lerp(d.x, Lookup(pi + Vector3i(0, 0, 1), convert),
-                        Lookup(pi + Vector3i(1, 0, 1), convert));
-        auto d11 = Lerp(d.x, Lookup(pi + Vector3i(0, 1, 1), convert),
-                        Lookup(pi + Vector3i(1, 1, 1), convert));
+        T v[8];
+        if (LookupCell(pi, v))
+            return convert(v[0]);
+        auto d00 = Lerp(d.x, convert(v[0]), convert(v[1]));
+        auto d10 = Lerp(d.x, convert(v[2]), convert(v[3]));
+        auto d01 = Lerp(d.x, convert(v[4]), convert(v[5]));
+        auto d11 = Lerp(d.x, convert(v[6]), convert(v[7]));
         return Lerp(d.z, Lerp(d.y, d00, d10), Lerp(d.y, d01, d11));
     }
 
@@ -808,22 +844,19 @@ class SampledGrid {
         Vector3f d = pSamples - (Point3f)pi;
 
         // Return trilinearly interpolated voxel values
-        auto d00 = Lerp(d.x, Lookup(pi), Lookup(pi + Vector3i(1, 0, 0)));
-        auto d10 =
-            Lerp(d.x, Lookup(pi + Vector3i(0, 1, 0)), Lookup(pi + Vector3i(1, 1, 0)));
-        auto d01 =
-            Lerp(d.x, Lookup(pi + Vector3i(0, 0, 1)), Lookup(pi + Vector3i(1, 0, 1)));
-        auto d11 =
-            Lerp(d.x, Lookup(pi + Vector3i(0, 1, 1)), Lookup(pi + Vector3i(1, 1, 1)));
+        T v[8];
+        if (LookupCell(pi, v))
+            return v[0];
+        auto d00 = Lerp(d.x, v[0], v[1]);
+        auto d10 = Lerp(d.x, v[2], v[3]);
+        auto d01 = Lerp(d.x, v[4], v[5]);
+        auto d11 = Lerp(d.x, v[6], v[7]);
         return Lerp(d.z, Lerp(d.y, d00, d10), Lerp(d.y, d01, d11));
     }
 
     template <typename F>
     PBRT_CPU_GPU auto Lookup(const Point3i &p, F convert) const {
-        Bounds3i sampleBounds(Point3i(0, 0, 0), Point3i(nx, ny, nz));
-        if (!InsideExclusive(p, sampleBounds))
-            return convert(T{});
-        return convert(values[(p.z * ny + p.y) * nx + p.x]);
+        return convert(Lookup(p));
     }
 
     PBRT_CPU_GPU
@@ -831,41 +864,123 @@ class SampledGrid {
         Bounds3i sampleBounds(Point3i(0, 0, 0), Point3i(nx, ny, nz));
         if (!InsideExclusive(p, sampleBounds))
             return T{};
-        return values[(p.z * ny + p.y) * nx + p.x];
+        int offset = BrickOffset(p);
+        if (offset < 0)
+            return values[~offset];
+        return values[offset + SampleIndex(p)];
     }
 
     template <typename F>
     Float MaxValue(const Bounds3f &bounds, F convert) const {
+        return Reduce(bounds, convert, [](Float a, Float b) { return std::max(a, b); });
+    }
+
+    T MaxValue(const Bounds3f &bounds) const {
+        return MaxValue(bounds, [](T value) { return value; });
+    }
+
+    template <typename F>
+    Float MinValue(const Bounds3f &bounds, F convert) const {
+        return Reduce(bounds, convert, [](Float a, Float b) { return std::min(a, b); });
+    }
+
+    T MinValue(const Bounds3f &bounds) const {
+        return MinValue(bounds, [](T value) { return value; });
+    }
+
+    std::string ToString() const {
+        return StringPrintf("[ SampledGrid nx: %d ny: %d nz: %d nBricks: %s "
+                            "brickOffsets: %s values: %s ]",
+                            nx, ny, nz, nBricks, brickOffsets, values);
+    }
+
+  private:
+    // SampledGrid Private Methods
+    // Reduces the converted values of the samples that affect lookups
+    // inside _bounds_ using _reduce_.
+    template <typename F, typename R>
+    Float Reduce(const Bounds3f &bounds, F convert, R reduce) const {
         Point3f ps[2] = {Point3f(bounds.pMin.x * nx - .5f, bounds.pMin.y * ny - .5f,
                                  bounds.pMin.z * nz - .5f),
                          Point3f(bounds.pMax.x * nx - .5f, bounds.pMax.y * ny - .5f,
                                  bounds.pMax.z * nz - .5f)};
-        Point3i pi[2] = {Max(Point3i(Floor(ps[0])), Point3i(0, 0, 0)),
-                         Min(Point3i(Floor(ps[1])) + Vector3i(1, 1, 1),
-                             Point3i(nx - 1, ny - 1, nz - 1))};
-
-        Float maxValue = Lookup(Point3i(pi[0]), convert);
-        for (int z = pi[0].z; z <= pi[1].z; ++z)
-            for (int y = pi[0].y; y <= pi[1].y; ++y)
-                for (int x = pi[0].x; x <= pi[1].x; ++x)
-                    maxValue = std::max(maxValue, Lookup(Point3i(x, y, z), convert));
+        Point3i pLookup[2] = {Point3i(Floor(ps[0])),
+                              Point3i(Floor(ps[1])) + Vector3i(1, 1, 1)};
+        Point3i pi[2] = {Max(pLookup[0], Point3i(0, 0, 0)),
+                         Min(pLookup[1], Point3i(nx - 1, ny - 1, nz - 1))};
+
+        Float value = Lookup(Point3i(pi[0]), convert);
+        // Lookups near the grid's boundary interpolate with zero-valued
+        // samples outside it, which must be accounted for as well
+        if (pLookup[0] != pi[0] || pLookup[1] != pi[1])
+            value = reduce(value, convert(T{}));
+        for (int bz = pi[0].z / BrickSize; bz <= pi[1].z / BrickSize; ++bz)
+            for (int by = pi[0].y / BrickSize; by <= pi[1].y / BrickSize; ++by)
+                for (int bx = pi[0].x / BrickSize; bx <= pi[1].x / BrickSize; ++bx) {
+                    // Account for the samples of brick _(bx, by, bz)_ inside the bounds
+                    int offset = brickOffsets[(bz * nBricks.y + by) * nBricks.x + bx];
+                    if (offset < 0) {
+                        value = reduce(value, convert(values[~offset]));
+                        continue;
+                    }
+                    Point3i b0(bx * BrickSize, by * BrickSize, bz * BrickSize);
+                    Point3i p0 = Max(pi[0], b0);
+                    Point3i p1 = Min(pi[1], b0 + Vector3i(BrickSize - 1, BrickSize - 1,
+                                                          BrickSize - 1));
+                    for (int z = p0.z; z <= p1.z; ++z)
+                        for (int y = p0.y; y <= p1.y; ++y)
+                            for (int x = p0.x; x <= p1.x; ++x)
+                                value = reduce(
+                                    value,
+                                    convert(values[offset + SampleIndex({x, y, z})]));
+                }
 
-        return maxValue;
+        return value;
     }
 
-    T MaxValue(const Bounds3f &bounds) const {
-        return MaxValue(bounds, [](T value) { return value; });
+    PBRT_CPU_GPU
+    int BrickOffset(const Point3i &p) const {
+        return brickOffsets[((p.z / BrickSize) * nBricks.y + p.y / BrickSize) *
+                                nBricks.x +
+                            p.x / BrickSize];
+    }
+    PBRT_CPU_GPU
+    static int SampleIndex(const Point3i &p) {
+        return ((p.z % BrickSize) * BrickSize + p.y % BrickSize) * BrickSize +
+               p.x % BrickSize;
     }
 
-    std::string ToString() const {
-        return StringPrintf("[ SampledGrid nx: %d ny: %d nz: %d values: %s ]", nx, ny, nz,
-                            values);
+    // Returns the samples at the corners of the cell with minimum corner
+    // _p_, ordered by x, then y, then z. If they all come from a constant
+    // brick, true is returned and only _v[0]_ is initialized.
+    PBRT_CPU_GPU
+    bool LookupCell(const Point3i &p, T v[8]) const {
+        if (p.x >= 0 && p.y >= 0 && p.z >= 0 && p.x + 1 < nx && p.y + 1 < ny &&
+            p.z + 1 < nz && p.x % BrickSize != BrickSize - 1 &&
+            p.y % BrickSize != BrickSize - 1 && p.z % BrickSize != BrickSize - 1) {
+            // Look up all of the samples in the same brick
+            int offset = BrickOffset(p);
+            if (offset < 0) {
+                v[0] = values[~offset];
+                return true;
+            }
+            const T *brick = &values[offset + SampleIndex(p)];
+            for (int i = 0; i < 8; ++i)
+                v[i] = brick[((i >> 2) * BrickSize + ((i >> 1) & 1)) * BrickSize +
+                             (i & 1)];
+            return false;
+        }
+        for (int i = 0; i < 8; ++i)
+            v[i] = Lookup(p + Vector3i(i & 1, (i >> 1) & 1, i >> 2));
+        return false;
     }
 
-  private:
     // SampledGrid Private Members
+    static constexpr int BrickSize = 8;
     pstd::vector<T> values;
+    pstd::vector<int> brickOffsets;
     int nx, ny, nz;
+    Point3i nBricks;
 };
 
 // InternCache Definition
@@ -200,3 +200,64 @@ TEST(InternCache, BadHash) {
         EXPECT_EQ(n, cache.size());
     }
 }
+
+TEST(SampledGrid, Bricks) {
+    // Grid that is mostly zero, with resolutions that aren't multiples of
+    // the brick size
+    int nx = 21, ny = 13, nz = 30;
+    std::vector<Float> values(nx * ny * nz, 0.f);
+    RNG rng;
+    for (int z = 0; z < nz; ++z)
+        for (int y = 0; y < ny; ++y)
+            for (int x = 0; x < nx; ++x)
+                if (x >= 10 && y < 5 && z > 20)
+                    values[(z * ny + y) * nx + x] = rng.Uniform<Float>();
+                else if (z < 8)
+                    values[(z * ny + y) * nx + x] = 0.5f;
+    SampledGrid<Float> grid(values, nx, ny, nz, Allocator());
+    EXPECT_LT(grid.BytesAllocated(), values.size() * sizeof(Float));
+
+    auto sample = [&](Point3i p) {
+        if (p.x < 0 || p.y < 0 || p.z < 0 || p.x >= nx || p.y >= ny || p.z >= nz)
+            return Float(0);
+        return values[(p.z * ny + p.y) * nx + p.x];
+    };
+    for (int z = -1; z <= nz; ++z)
+        for (int y = -1; y <= ny; ++y)
+            for (int x = -1; x <= nx; ++x)
+                EXPECT_EQ(sample({x, y, z}), grid.Lookup(Point3i(x, y, z)));
+
+    for (int i = 0; i < 10000; ++i) {
+        // Compare to trilinear interpolation of the original values
+        Point3f p(rng.Uniform<Float>(), rng.Uniform<Float>(), rng.Uniform<Float>());
+        Point3f pSamples(p.x * nx - .5f, p.y * ny - .5f, p.z * nz - .5f);
+        Point3i pi = (Point3i)Floor(pSamples);
+        Vector3f d = pSamples - (Point3f)pi;
+        Float v = 0;
+        for (int c = 0; c < 8; ++c) {
+            Vector3i o(c & 1, (c >> 1) & 1, c >> 2);
+            v += ((o.x ? d.x : 1 - d.x) * (o.y ? d.y : 1 - d.y) * (o.z ? d.z : 1 - d.z)) *
+                 sample(pi + o);
+        }
+        EXPECT_NEAR(v, grid.Lookup(p), 1e-5f);
+
+        // Check _MaxValue()_ and _MinValue()_ against the samples they cover,
+        // including the zero-valued ones outside the grid
+        Point3f q(rng.Uniform<Float>(), rng.Uniform<Float>(), rng.Uniform<Float>());
+        Bounds3f b(p, q);
+        Point3i p0(Floor(Point3f(b.pMin.x * nx - .5f, b.pMin.y * ny - .5f,
+                                 b.pMin.z * nz - .5f)));
+        Point3i p1 = Point3i(Floor(Point3f(b.pMax.x * nx - .5f, b.pMax.y * ny - .5f,
+                                           b.pMax.z * nz - .5f))) +
+                     Vector3i(1, 1, 1);
+        Float maxValue = sample(p0), minValue = sample(p0);
+        for (int z = p0.z; z <= p1.z; ++z)
+            for (int y = p0.y; y <= p1.y; ++y)
+                for (int x = p0.x; x <= p1.x; ++x) {
+                    maxValue = std::max(maxValue, sample({x, y, z}));
+                    minValue = std::min(minValue, sample({x, y, z}));
+                }
+        EXPECT_EQ(maxValue, grid.MaxValue(b));
+        EXPECT_EQ(minValue, grid.MinValue(b));
+    }
+}
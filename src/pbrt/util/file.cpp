@@ -7,19 +7,24 @@
 #include <pbrt/util/check.h>
 #include <pbrt/util/error.h>
 #include <pbrt/util/parallel.h>
+#include <pbrt/util/print.h>
 #include <pbrt/util/string.h>
 
 #include <libdeflate.h>
 
 #include <filesystem/path.h>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
-#ifndef PBRT_IS_WINDOWS
+#include <random>
+#ifdef PBRT_IS_WINDOWS
+#include <process.h>
+#else
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/dir.h>
@@ -27,6 +32,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+#ifdef PBRT_HAVE_MMAP
+#include <sys/mman.h>
+#elif defined(PBRT_IS_WINDOWS)
+#include <windows.h>  // Windows file mapping API
+#endif
 
 namespace pbrt {
 
@@ -121,6 +131,17 @@ bool RemoveFile(std::string filename) {
 #endif
 }
 
+std::string UniqueTemporaryFilename(std::string filename) {
+    static std::atomic<uint64_t> counter{0};
+#ifdef PBRT_IS_WINDOWS
+    int pid = _getpid();
+#else
+    int pid = getpid();
+#endif
+    uint64_t suffix = (uint64_t(std::random_device()()) << 32) ^ counter++;
+    return StringPrintf("%s.%d.%016x.tmp", filename, pid, suffix);
+}
+
 std::string ReadFileContents(std::string filename) {
 #ifdef PBRT_IS_WINDOWS
     std::ifstream ifs(WStringFromUTF8(filename).c_str(), std::ios::binary);
@@ -277,6 +298,93 @@ std::vector<Float> ReadFloatFile(std::string filename) {
     return values;
 }
 
+// MappedFile Method Definitions
+std::unique_ptr<MappedFile> MappedFile::Open(std::string filename) {
+#ifdef PBRT_HAVE_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat stat;
+    if (fstat(fd, &stat) != 0 || stat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t len = stat.st_size;
+    void *ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE | MAP_NORESERVE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        LOG_VERBOSE("%s: mmap failed: %s", filename, ErrorString());
+        return nullptr;
+    }
+    return std::make_unique<MappedFile>(ptr, len);
+#elif defined(PBRT_IS_WINDOWS)
+    HANDLE fileHandle =
+        CreateFileW(WStringFromUTF8(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMapping(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(fileHandle);
+    if (mapping == 0)
+        return nullptr;
+
+    LPVOID ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!ptr)
+        return nullptr;
+    return std::make_unique<MappedFile>(ptr, size_t(fileSize.QuadPart));
+#else
+    return nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef PBRT_HAVE_MMAP
+    if (munmap(ptr, len) != 0)
+        Error("munmap: %s", ErrorString());
+#elif defined(PBRT_IS_WINDOWS)
+    if (UnmapViewOfFile(ptr) == 0)
+        Error("UnmapViewOfFile: %s", ErrorString());
+#endif
+}
+
+void MappedFile::Advise(size_t offset, size_t length, Access access) const {
+#ifdef PBRT_HAVE_MMAP
+    // Expand the range to page boundaries, as required by _madvise()_
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t start = offset / pageSize * pageSize;
+    size_t end = std::min(len, offset + length);
+    if (end <= start)
+        return;
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case Access::Normal:
+        advice = MADV_NORMAL;
+        break;
+    case Access::Random:
+        advice = MADV_RANDOM;
+        break;
+    case Access::WillNeed:
+        advice = MADV_WILLNEED;
+        break;
+    case Access::DontNeed:
+        advice = MADV_DONTNEED;
+        break;
+    }
+    if (madvise((char *)ptr + start, end - start, advice) != 0)
+        LOG_VERBOSE("madvise: %s", ErrorString());
+#endif
+}
+
 bool WriteFileContents(std::string filename, const std::string &contents) {
 #ifdef PBRT_IS_WINDOWS
     std::ofstream out(WStringFromUTF8(filename).c_str(), std::ios::binary);
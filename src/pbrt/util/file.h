@@ -9,6 +9,7 @@
 
 #include <pbrt/util/pstd.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,10 @@ std::vector<Float> ReadFloatFile(std::string filename);
 
 bool FileExists(std::string filename);
 bool RemoveFile(std::string filename);
+// Returns a name for a temporary file next to _filename_ that no other
+// process or thread will use, so that the file can be written and then
+// renamed to _filename_.
+std::string UniqueTemporaryFilename(std::string filename);
 
 std::string ResolveFilename(std::string filename);
 void SetSearchDirectory(std::string filename);
@@ -35,6 +40,36 @@ std::vector<std::string> MatchingFilenames(std::string filename);
 FILE *FOpenRead(std::string filename);
 FILE *FOpenWrite(std::string filename);
 
+// MappedFile Definition
+class MappedFile {
+  public:
+    // MappedFile Public Methods
+    // Returns nullptr if the file can't be opened or if memory-mapped I/O
+    // isn't available on the system; callers should then fall back to
+    // reading the file in the usual way.
+    static std::unique_ptr<MappedFile> Open(std::string filename);
+
+    MappedFile(void *ptr, size_t len) : ptr(ptr), len(len) {}
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return (const char *)ptr; }
+    size_t size() const { return len; }
+
+    // Hints about how a range of the file will be accessed; they are
+    // ignored on systems that don't support them. _DontNeed_ releases the
+    // range's resident pages, which are read again from the file if needed.
+    enum class Access { Normal, Random, WillNeed, DontNeed };
+    void Advise(size_t offset, size_t length, Access access) const;
+
+  private:
+    // MappedFile Private Members
+    void *ptr;
+    size_t len;
+};
+
 }  // namespace pbrt
 
 #endif  // PBRT_UTIL_FILE_H
@@ -38,6 +38,14 @@ TEST(File, ReadWriteFile) {
     EXPECT_EQ(0, remove(fn.c_str()));
 }
 
+TEST(File, UniqueTemporaryFilename) {
+    std::string fn = inTestDir("cache.bin");
+    std::string t0 = UniqueTemporaryFilename(fn), t1 = UniqueTemporaryFilename(fn);
+    EXPECT_NE(t0, t1);
+    EXPECT_EQ(0, t0.compare(0, fn.size(), fn));
+    EXPECT_EQ(0, t1.compare(0, fn.size(), fn));
+}
+
 TEST(File, Success) {
     std::string fn = inTestDir("floatfile_good.txt");
     EXPECT_TRUE(WriteFileContents(fn, R"(1
@@ -7,36 +7,90 @@
 #include <pbrt/util/buffercache.h>
 #include <pbrt/util/check.h>
 #include <pbrt/util/error.h>
+#include <pbrt/util/file.h>
 #include <pbrt/util/log.h>
+#include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/stats.h>
+#include <pbrt/util/string.h>
 #include <pbrt/util/transform.h>
 
 #include <rply/rply.h>
 
+#include <cstring>
+
 namespace pbrt {
 
 STAT_RATIO("Geometry/Triangles per mesh", nTris, nTriMeshes);
 STAT_MEMORY_COUNTER("Memory/Triangles", triangleBytes);
+STAT_MEMORY_COUNTER("Memory/Saved by compressing vertex data", compressedVertexBytes);
+STAT_MEMORY_COUNTER("Memory/Saved by compressing vertex indices", compressedIndexBytes);
 
 // TriangleMesh Method Definitions
 TriangleMesh::TriangleMesh(const Transform &renderFromObject, bool reverseOrientation,
                            std::vector<int> indices, std::vector<Point3f> p,
                            std::vector<Vector3f> s, std::vector<Normal3f> n,
                            std::vector<Point2f> uv, std::vector<int> faceIndices,
-                           Allocator alloc)
+                           Allocator alloc, bool compress, bool quantizePositions)
     : nTriangles(indices.size() / 3), nVertices(p.size()) {
     CHECK_EQ((indices.size() % 3), 0);
     ++nTriMeshes;
     nTris += nTriangles;
     triangleBytes += sizeof(*this);
     // Initialize mesh _vertexIndices_
-    vertexIndices = intBufferCache->LookupOrAdd(indices, alloc);
+    if (compress) {
+        // Store indices as 16-bit offsets from a per-block base index, if
+        // each block's indices span a small enough range.
+        int nBlocks = (nTriangles + IndexBlockSize - 1) / IndexBlockSize;
+        std::vector<int> base(nBlocks);
+        std::vector<uint16_t> deltas(indices.size());
+        bool fits = true;
+        for (int b = 0; b < nBlocks && fits; ++b) {
+            auto start = indices.begin() + 3 * b * IndexBlockSize;
+            auto end = indices.begin() +
+                       std::min<size_t>(indices.size(), 3 * (b + 1) * IndexBlockSize);
+            auto [minIndex, maxIndex] = std::minmax_element(start, end);
+            fits = int64_t(*maxIndex) - int64_t(*minIndex) <=
+                   std::numeric_limits<uint16_t>::max();
+            base[b] = *minIndex;
+            for (auto iter = start; iter != end; ++iter)
+                deltas[iter - indices.begin()] = *iter - *minIndex;
+        }
+        if (fits && nBlocks > 0) {
+            indexBlockBase = intBufferCache->LookupOrAdd(base, alloc);
+            indexDeltas = uint16BufferCache->LookupOrAdd(deltas, alloc);
+            compressedIndexBytes += indices.size() * sizeof(int) -
+                                    base.size() * sizeof(int) -
+                                    deltas.size() * sizeof(uint16_t);
+        }
+    }
+    if (!indexDeltas)
+        vertexIndices = intBufferCache->LookupOrAdd(indices, alloc);
 
     // Transform mesh vertices to rendering space and initialize mesh _p_
     for (Point3f &pt : p)
         pt = renderFromObject(pt);
-    this->p = point3BufferCache->LookupOrAdd(p, alloc);
+    if (compress && quantizePositions) {
+        // Quantize positions with respect to the mesh's bounds
+        Bounds3f bounds;
+        for (Point3f pt : p)
+            bounds = Union(bounds, pt);
+        Vector3f diag = bounds.Diagonal();
+        constexpr Float maxQ = (uint64_t(1) << PositionBits) - 1;
+        pQuantizedMin = bounds.pMin;
+        pQuantizedScale = Vector3f(diag.x / maxQ, diag.y / maxQ, diag.z / maxQ);
+
+        std::vector<uint64_t> pq(p.size());
+        for (size_t i = 0; i < p.size(); ++i)
+            for (int c = 0; c < 3; ++c) {
+                Float f = diag[c] > 0 ? (p[i][c] - bounds.pMin[c]) / diag[c] : 0;
+                pq[i] |= uint64_t(pstd::round(Clamp(f, 0, 1) * maxQ))
+                         << (c * PositionBits);
+            }
+        pQuantized = uint64BufferCache->LookupOrAdd(pq, alloc);
+        compressedVertexBytes += p.size() * (sizeof(Point3f) - sizeof(uint64_t));
+    } else
+        this->p = point3BufferCache->LookupOrAdd(p, alloc);
 
     // Remainder of _TriangleMesh_ constructor
     this->reverseOrientation = reverseOrientation;
@@ -44,7 +98,27 @@ TriangleMesh::TriangleMesh(const Transform &renderFromObject, bool reverseOrient
 
     if (!uv.empty()) {
         CHECK_EQ(nVertices, uv.size());
-        this->uv = point2BufferCache->LookupOrAdd(uv, alloc);
+        // Half-precision texture coordinates are only used if they're within
+        // a texel of a 2k texture spanning the mesh's texture coordinates
+        Bounds2f uvBounds;
+        for (Point2f st : uv)
+            uvBounds = Union(uvBounds, st);
+        Float uvTolerance = MaxComponentValue(uvBounds.Diagonal()) / 2048;
+        if (compress && std::all_of(uv.begin(), uv.end(), [&](Point2f st) {
+                return std::abs(st.x) <= 65504 && std::abs(st.y) <= 65504 &&
+                       std::abs(float(Half(st.x)) - st.x) <= uvTolerance &&
+                       std::abs(float(Half(st.y)) - st.y) <= uvTolerance;
+            })) {
+            std::vector<Half> uvh;
+            uvh.reserve(2 * uv.size());
+            for (Point2f st : uv) {
+                uvh.push_back(Half(st.x));
+                uvh.push_back(Half(st.y));
+            }
+            uvHalf = halfBufferCache->LookupOrAdd(uvh, alloc);
+            compressedVertexBytes += uv.size() * (sizeof(Point2f) - 2 * sizeof(Half));
+        } else
+            this->uv = point2BufferCache->LookupOrAdd(uv, alloc);
     }
     if (!n.empty()) {
         CHECK_EQ(nVertices, n.size());
@@ -53,7 +127,20 @@ TriangleMesh::TriangleMesh(const Transform &renderFromObject, bool reverseOrient
             if (reverseOrientation)
                 nn = -nn;
         }
-        this->n = normal3BufferCache->LookupOrAdd(n, alloc);
+        // Octahedral encoding normalizes, so it can't represent
+        // degenerate normals.
+        if (compress && std::all_of(n.begin(), n.end(), [](Normal3f nn) {
+                return LengthSquared(nn) > 0;
+            })) {
+            std::vector<OctahedralVector> on;
+            on.reserve(n.size());
+            for (Normal3f nn : n)
+                on.push_back(OctahedralVector(Vector3f(nn)));
+            nOctahedral = octahedralVectorBufferCache->LookupOrAdd(on, alloc);
+            compressedVertexBytes +=
+                n.size() * (sizeof(Normal3f) - sizeof(OctahedralVector));
+        } else
+            this->n = normal3BufferCache->LookupOrAdd(n, alloc);
     }
     if (!s.empty()) {
         CHECK_EQ(nVertices, s.size());
@@ -100,12 +187,32 @@ bool TriangleMesh::WritePLY(std::string filename) const {
     if (s)
         Warning(R"(%s: PLY mesh will be missing tangent vectors "S".)", filename);
 
-    return pbrt::WritePLY(
-        filename, pstd::span<const int>(vertexIndices, 3 * nTriangles),
-        pstd::span<const int>(), pstd::span<const Point3f>(p, nVertices),
-        pstd::span<const Normal3f>(n, n ? nVertices : 0),
-        pstd::span<const Point2f>(uv, uv ? nVertices : 0),
-        pstd::span<const int>(faceIndices, faceIndices ? nTriangles : 0));
+    if (vertexIndices && p && !nOctahedral && !uvHalf)
+        return pbrt::WritePLY(
+            filename, pstd::span<const int>(vertexIndices, 3 * nTriangles),
+            pstd::span<const int>(), pstd::span<const Point3f>(p, nVertices),
+            pstd::span<const Normal3f>(n, n ? nVertices : 0),
+            pstd::span<const Point2f>(uv, uv ? nVertices : 0),
+            pstd::span<const int>(faceIndices, faceIndices ? nTriangles : 0));
+
+    // Decompress the mesh before writing it
+    std::vector<int> indices;
+    for (int i = 0; i < nTriangles; ++i)
+        for (int v : Indices(i))
+            indices.push_back(v);
+    std::vector<Point3f> P;
+    std::vector<Normal3f> N;
+    std::vector<Point2f> UV;
+    for (int i = 0; i < nVertices; ++i) {
+        P.push_back(this->P(i));
+        if (HasNormals())
+            N.push_back(this->N(i));
+        if (HasUVs())
+            UV.push_back(this->UV(i));
+    }
+    return pbrt::WritePLY(filename, indices, {}, P, N, UV,
+                          pstd::span<const int>(faceIndices,
+                                                faceIndices ? nTriangles : 0));
 }
 
 bool WritePLY(std::string filename, pstd::span<const int> triIndices,
@@ -319,7 +426,7 @@ int rply_faceindex_callback(p_ply_argument argument) {
     return 1;
 }
 
-TriQuadMesh TriQuadMesh::ReadPLY(const std::string &filename) {
+static TriQuadMesh ReadPLYWithRPly(const std::string &filename) {
     TriQuadMesh mesh;
 
     p_ply ply = ply_open(filename.c_str(), rply_message_callback, 0, nullptr);
@@ -408,6 +515,415 @@ TriQuadMesh TriQuadMesh::ReadPLY(const std::string &filename) {
 
     ply_close(ply);
 
+    return mesh;
+}
+
+// Binary PLY Reading Definitions
+enum class PLYType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+static bool PLYTypeFromString(const std::string &s, PLYType *type) {
+    if (s == "char" || s == "int8")
+        *type = PLYType::Int8;
+    else if (s == "uchar" || s == "uint8")
+        *type = PLYType::UInt8;
+    else if (s == "short" || s == "int16")
+        *type = PLYType::Int16;
+    else if (s == "ushort" || s == "uint16")
+        *type = PLYType::UInt16;
+    else if (s == "int" || s == "int32")
+        *type = PLYType::Int32;
+    else if (s == "uint" || s == "uint32")
+        *type = PLYType::UInt32;
+    else if (s == "float" || s == "float32")
+        *type = PLYType::Float32;
+    else if (s == "double" || s == "float64")
+        *type = PLYType::Float64;
+    else
+        return false;
+    return true;
+}
+
+static size_t PLYTypeSize(PLYType type) {
+    switch (type) {
+    case PLYType::Int8:
+    case PLYType::UInt8:
+        return 1;
+    case PLYType::Int16:
+    case PLYType::UInt16:
+        return 2;
+    case PLYType::Int32:
+    case PLYType::UInt32:
+    case PLYType::Float32:
+        return 4;
+    case PLYType::Float64:
+        return 8;
+    }
+    LOG_FATAL("Unhandled PLYType");
+    return 0;
+}
+
+template <typename T>
+static inline T LoadUnaligned(const char *ptr) {
+    T v;
+    std::memcpy(&v, ptr, sizeof(T));
+    return v;
+}
+
+static inline double ReadPLYValue(const char *ptr, PLYType type) {
+    switch (type) {
+    case PLYType::Float32:
+        return LoadUnaligned<float>(ptr);
+    case PLYType::Float64:
+        return LoadUnaligned<double>(ptr);
+    case PLYType::Int8:
+        return LoadUnaligned<int8_t>(ptr);
+    case PLYType::UInt8:
+        return LoadUnaligned<uint8_t>(ptr);
+    case PLYType::Int16:
+        return LoadUnaligned<int16_t>(ptr);
+    case PLYType::UInt16:
+        return LoadUnaligned<uint16_t>(ptr);
+    case PLYType::Int32:
+        return LoadUnaligned<int32_t>(ptr);
+    case PLYType::UInt32:
+        return LoadUnaligned<uint32_t>(ptr);
+    }
+    return 0;
+}
+
+static inline int64_t ReadPLYInteger(const char *ptr, PLYType type) {
+    switch (type) {
+    case PLYType::Int32:
+        return LoadUnaligned<int32_t>(ptr);
+    case PLYType::UInt32:
+        return LoadUnaligned<uint32_t>(ptr);
+    case PLYType::UInt8:
+        return LoadUnaligned<uint8_t>(ptr);
+    case PLYType::Int8:
+        return LoadUnaligned<int8_t>(ptr);
+    case PLYType::Int16:
+        return LoadUnaligned<int16_t>(ptr);
+    case PLYType::UInt16:
+        return LoadUnaligned<uint16_t>(ptr);
+    default:
+        return int64_t(ReadPLYValue(ptr, type));
+    }
+}
+
+struct PLYProperty {
+    std::string name;
+    PLYType type;
+    // Only set for list properties
+    bool isList = false;
+    PLYType countType;
+};
+
+struct PLYElement {
+    std::string name;
+    int64_t count;
+    std::vector<PLYProperty> properties;
+};
+
+// Reads binary little-endian PLY files directly from a memory-mapped image
+// of the file, converting vertex and index data in parallel.  Returns false
+// if the file isn't in a layout that's handled here, in which case the
+// caller should fall back to RPly.
+static bool ReadBinaryPLY(const std::string &filename, TriQuadMesh *mesh,
+                          bool positionsOnly = false) {
+    const uint32_t endianTest = 1;
+    if (*(const uint8_t *)&endianTest != 1)
+        return false;
+
+    std::unique_ptr<MappedFile> file = MappedFile::Open(filename);
+    if (!file || file->size() < 4 || std::strncmp(file->data(), "ply", 3) != 0)
+        return false;
+
+    // Parse the PLY header
+    const char *data = file->data();
+    size_t fileSize = file->size(), pos = 0;
+    std::vector<PLYElement> elements;
+    bool foundFormat = false, foundEndHeader = false;
+    while (pos < fileSize && !foundEndHeader) {
+        const char *eol = (const char *)memchr(data + pos, '\n', fileSize - pos);
+        if (!eol)
+            return false;
+        std::string_view line(data + pos, eol - (data + pos));
+        pos = eol - data + 1;
+
+        std::vector<std::string> tokens = SplitStringsFromWhitespace(line);
+        if (tokens.empty() || tokens[0] == "ply" || tokens[0] == "comment" ||
+            tokens[0] == "obj_info")
+            continue;
+        else if (tokens[0] == "format") {
+            if (tokens.size() < 2 || tokens[1] != "binary_little_endian")
+                return false;
+            foundFormat = true;
+        } else if (tokens[0] == "element") {
+            int64_t count;
+            if (tokens.size() != 3 || !Atoi(tokens[2], &count) || count < 0)
+                return false;
+            elements.push_back(PLYElement{tokens[1], count, {}});
+        } else if (tokens[0] == "property") {
+            if (elements.empty())
+                return false;
+            PLYProperty prop;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                prop.isList = true;
+                if (!PLYTypeFromString(tokens[2], &prop.countType) ||
+                    !PLYTypeFromString(tokens[3], &prop.type))
+                    return false;
+                prop.name = tokens[4];
+            } else if (tokens.size() == 3) {
+                if (!PLYTypeFromString(tokens[1], &prop.type))
+                    return false;
+                prop.name = tokens[2];
+            } else
+                return false;
+            elements.back().properties.push_back(prop);
+        } else if (tokens[0] == "end_header")
+            foundEndHeader = true;
+        else
+            return false;
+    }
+    if (!foundFormat || !foundEndHeader)
+        return false;
+
+    // Find the extents of the vertex and face elements in the file
+    const PLYElement *vertexElement = nullptr, *faceElement = nullptr;
+    const char *vertexData = nullptr, *faceData = nullptr;
+    size_t vertexStride = 0;
+    for (const PLYElement &element : elements) {
+        size_t stride = 0;
+        bool hasList = false;
+        for (const PLYProperty &prop : element.properties) {
+            if (prop.isList)
+                hasList = true;
+            else
+                stride += PLYTypeSize(prop.type);
+        }
+
+        if (element.name == "face") {
+            // Face records are variable-sized; they're handled below.
+            faceElement = &element;
+            faceData = data + pos;
+            break;
+        }
+        if (hasList || (stride > 0 && size_t(element.count) > (fileSize - pos) / stride))
+            return false;
+        if (element.name == "vertex") {
+            vertexElement = &element;
+            vertexData = data + pos;
+            vertexStride = stride;
+        }
+        pos += element.count * stride;
+    }
+    if (!vertexElement || !faceElement || vertexElement->count == 0 ||
+        faceElement->count == 0)
+        return false;
+
+    // Find offsets of the vertex properties of interest
+    struct PLYVertexAttribute {
+        size_t offset;
+        PLYType type;
+    };
+    auto findAttribute = [&](const char *name) -> pstd::optional<PLYVertexAttribute> {
+        size_t offset = 0;
+        for (const PLYProperty &prop : vertexElement->properties) {
+            if (prop.name == name)
+                return PLYVertexAttribute{offset, prop.type};
+            offset += PLYTypeSize(prop.type);
+        }
+        return {};
+    };
+    auto findAttributes = [&](std::initializer_list<const char *> names,
+                              PLYVertexAttribute *attribs) {
+        int i = 0;
+        for (const char *name : names) {
+            pstd::optional<PLYVertexAttribute> a = findAttribute(name);
+            if (!a)
+                return false;
+            attribs[i++] = *a;
+        }
+        return true;
+    };
+
+    PLYVertexAttribute pAttrib[3], nAttrib[3], uvAttrib[2];
+    if (!findAttributes({"x", "y", "z"}, pAttrib))
+        return false;
+    bool haveNormals =
+        !positionsOnly && findAttributes({"nx", "ny", "nz"}, nAttrib);
+    bool haveUVs = !positionsOnly && (findAttributes({"u", "v"}, uvAttrib) ||
+                                      findAttributes({"s", "t"}, uvAttrib) ||
+                                      findAttributes({"texture_u", "texture_v"}, uvAttrib) ||
+                                      findAttributes({"texture_s", "texture_t"}, uvAttrib));
+
+    // Convert vertex data in parallel
+    int64_t nVertices = vertexElement->count;
+    mesh->p.resize(nVertices);
+    if (haveNormals)
+        mesh->n.resize(nVertices);
+    if (haveUVs)
+        mesh->uv.resize(nVertices);
+
+    auto readAttribute = [](const char *v, const PLYVertexAttribute &a) -> Float {
+        if (a.type == PLYType::Float32)
+            return LoadUnaligned<float>(v + a.offset);
+        return ReadPLYValue(v + a.offset, a.type);
+    };
+    bool pIsPacked = (sizeof(Point3f) == 3 * sizeof(float) &&
+                      vertexStride == sizeof(Point3f) && pAttrib[0].offset == 0 &&
+                      pAttrib[1].offset == 4 && pAttrib[2].offset == 8 &&
+                      pAttrib[0].type == PLYType::Float32 &&
+                      pAttrib[1].type == PLYType::Float32 &&
+                      pAttrib[2].type == PLYType::Float32);
+    ParallelFor(0, nVertices, [&](int64_t start, int64_t end) {
+        if (pIsPacked)
+            // The file's vertex layout matches _Point3f_; copy directly
+            std::memcpy(&mesh->p[start], vertexData + start * vertexStride,
+                        (end - start) * vertexStride);
+        for (int64_t i = start; i < end; ++i) {
+            const char *v = vertexData + i * vertexStride;
+            if (!pIsPacked)
+                mesh->p[i] =
+                    Point3f(readAttribute(v, pAttrib[0]), readAttribute(v, pAttrib[1]),
+                            readAttribute(v, pAttrib[2]));
+            if (haveNormals)
+                mesh->n[i] =
+                    Normal3f(readAttribute(v, nAttrib[0]), readAttribute(v, nAttrib[1]),
+                             readAttribute(v, nAttrib[2]));
+            if (haveUVs)
+                mesh->uv[i] =
+                    Point2f(readAttribute(v, uvAttrib[0]), readAttribute(v, uvAttrib[1]));
+        }
+    });
+    if (positionsOnly)
+        return true;
+
+    // Determine the face record layout
+    const PLYProperty *indexProp = nullptr;
+    size_t preListBytes = 0, postListBytes = 0;
+    pstd::optional<size_t> faceIndexOffset;
+    PLYType faceIndexType;
+    bool faceIndexAfterList = false;
+    for (const PLYProperty &prop : faceElement->properties) {
+        if (prop.isList) {
+            if (prop.name != "vertex_indices" || indexProp)
+                return false;
+            indexProp = &prop;
+            continue;
+        }
+        if (prop.name == "face_indices") {
+            faceIndexOffset = indexProp ? postListBytes : preListBytes;
+            faceIndexType = prop.type;
+            faceIndexAfterList = indexProp != nullptr;
+        }
+        (indexProp ? postListBytes : preListBytes) += PLYTypeSize(prop.type);
+    }
+    if (!indexProp)
+        return false;
+    size_t countSize = PLYTypeSize(indexProp->countType);
+    size_t indexSize = PLYTypeSize(indexProp->type);
+
+    // Scan the face records to count triangles and quads.  This pass only
+    // touches each record's vertex count; if all faces have the same
+    // number of vertices, records have a fixed stride and can be
+    // converted in parallel.
+    int64_t nFaces = faceElement->count, nTris = 0, nQuads = 0, nSkipped = 0;
+    size_t faceBytesRemaining = data + fileSize - faceData;
+    const char *faceEnd = faceData;
+    int64_t firstFaceSize = -1;
+    bool uniformFaces = true;
+    for (int64_t i = 0; i < nFaces; ++i) {
+        size_t recordOffset = faceEnd - faceData;
+        if (recordOffset + preListBytes + countSize > faceBytesRemaining)
+            return false;
+        int64_t n = ReadPLYInteger(faceEnd + preListBytes, indexProp->countType);
+        if (n < 0)
+            return false;
+        size_t recordBytes = preListBytes + countSize + n * indexSize + postListBytes;
+        if (recordOffset + recordBytes > faceBytesRemaining)
+            return false;
+
+        if (n == 3)
+            ++nTris;
+        else if (n == 4)
+            ++nQuads;
+        else
+            ++nSkipped;
+        if (firstFaceSize == -1)
+            firstFaceSize = n;
+        else if (n != firstFaceSize)
+            uniformFaces = false;
+        faceEnd += recordBytes;
+    }
+    if (nSkipped > 0)
+        Warning("%s: ignoring %d faces that aren't triangles or quads (only triangles "
+                "and quads are supported!)",
+                filename, nSkipped);
+
+    mesh->triIndices.resize(3 * nTris);
+    mesh->quadIndices.resize(4 * nQuads);
+    if (faceIndexOffset)
+        mesh->faceIndices.resize(nFaces);
+
+    // Convert a single face record; _triOffset_ and _quadOffset_ give the
+    // face's position in the respective index arrays.
+    auto convertFace = [&](const char *f, int64_t faceIndex, int64_t triOffset,
+                           int64_t quadOffset) {
+        int64_t n = ReadPLYInteger(f + preListBytes, indexProp->countType);
+        const char *idx = f + preListBytes + countSize;
+        auto index = [&](int i) {
+            return int(ReadPLYInteger(idx + i * indexSize, indexProp->type));
+        };
+        if (n == 3) {
+            for (int i = 0; i < 3; ++i)
+                mesh->triIndices[triOffset + i] = index(i);
+        } else if (n == 4) {
+            // Note: modify order since we're specifying it as a blp...
+            mesh->quadIndices[quadOffset] = index(0);
+            mesh->quadIndices[quadOffset + 1] = index(1);
+            mesh->quadIndices[quadOffset + 2] = index(3);
+            mesh->quadIndices[quadOffset + 3] = index(2);
+        }
+        if (faceIndexOffset) {
+            const char *fi = f + *faceIndexOffset;
+            if (faceIndexAfterList)
+                fi += preListBytes + countSize + n * indexSize;
+            mesh->faceIndices[faceIndex] = int(ReadPLYInteger(fi, faceIndexType));
+        }
+        return n;
+    };
+
+    if (uniformFaces) {
+        size_t faceStride = preListBytes + countSize + firstFaceSize * indexSize +
+                            postListBytes;
+        ParallelFor(0, nFaces, [&](int64_t start, int64_t end) {
+            for (int64_t i = start; i < end; ++i)
+                convertFace(faceData + i * faceStride, i, 3 * i, 4 * i);
+        });
+    } else {
+        const char *f = faceData;
+        int64_t triOffset = 0, quadOffset = 0;
+        for (int64_t i = 0; i < nFaces; ++i) {
+            int64_t n = convertFace(f, i, triOffset, quadOffset);
+            if (n == 3)
+                triOffset += 3;
+            else if (n == 4)
+                quadOffset += 4;
+            f += preListBytes + countSize + n * indexSize + postListBytes;
+        }
+    }
+
+    LOG_VERBOSE("%s: read %d vertices, %d triangles, and %d quads from mapped file",
+                filename, nVertices, nTris, nQuads);
+    return true;
+}
+
+TriQuadMesh TriQuadMesh::ReadPLY(const std::string &filename) {
+    TriQuadMesh mesh;
+    if (!ReadBinaryPLY(filename, &mesh))
+        mesh = ReadPLYWithRPly(filename);
+
     for (int idx : mesh.triIndices)
         if (idx < 0 || idx >= mesh.p.size())
             ErrorExit("plymesh: Vertex index %i is out of bounds! "
@@ -422,6 +938,13 @@ TriQuadMesh TriQuadMesh::ReadPLY(const std::string &filename) {
     return mesh;
 }
 
+std::vector<Point3f> TriQuadMesh::ReadPLYPositions(const std::string &filename) {
+    TriQuadMesh mesh;
+    if (!ReadBinaryPLY(filename, &mesh, true /* positionsOnly */))
+        mesh = ReadPLYWithRPly(filename);
+    return std::move(mesh.p);
+}
+
 void TriQuadMesh::ConvertToOnlyTriangles() {
     if (quadIndices.empty())
         return;
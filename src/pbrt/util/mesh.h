@@ -9,6 +9,7 @@
 
 #include <pbrt/util/containers.h>
 #include <pbrt/util/error.h>
+#include <pbrt/util/float.h>
 #include <pbrt/util/hash.h>
 #include <pbrt/util/parallel.h>
 #include <pbrt/util/pstd.h>
@@ -27,7 +28,8 @@ class TriangleMesh {
     TriangleMesh(const Transform &renderFromObject, bool reverseOrientation,
                  std::vector<int> vertexIndices, std::vector<Point3f> p,
                  std::vector<Vector3f> S, std::vector<Normal3f> N,
-                 std::vector<Point2f> uv, std::vector<int> faceIndices, Allocator alloc);
+                 std::vector<Point2f> uv, std::vector<int> faceIndices, Allocator alloc,
+                 bool compress = false, bool quantizePositions = false);
 
     std::string ToString() const;
 
@@ -35,6 +37,43 @@ class TriangleMesh {
 
     static void Init(Allocator alloc);
 
+    PBRT_CPU_GPU
+    pstd::array<int, 3> Indices(int triIndex) const {
+        if (vertexIndices)
+            return {vertexIndices[3 * triIndex], vertexIndices[3 * triIndex + 1],
+                    vertexIndices[3 * triIndex + 2]};
+        int base = indexBlockBase[triIndex / IndexBlockSize];
+        const uint16_t *d = &indexDeltas[3 * triIndex];
+        return {base + d[0], base + d[1], base + d[2]};
+    }
+
+    PBRT_CPU_GPU
+    Point3f P(int vertex) const {
+        if (p)
+            return p[vertex];
+        uint64_t q = pQuantized[vertex];
+        constexpr uint64_t mask = (uint64_t(1) << PositionBits) - 1;
+        return pQuantizedMin +
+               Vector3f(pQuantizedScale.x * Float(q & mask),
+                        pQuantizedScale.y * Float((q >> PositionBits) & mask),
+                        pQuantizedScale.z * Float(q >> (2 * PositionBits)));
+    }
+
+    PBRT_CPU_GPU
+    bool HasNormals() const { return n || nOctahedral; }
+    PBRT_CPU_GPU
+    Normal3f N(int vertex) const {
+        return n ? n[vertex] : Normal3f(Vector3f(nOctahedral[vertex]));
+    }
+
+    PBRT_CPU_GPU
+    bool HasUVs() const { return uv || uvHalf; }
+    PBRT_CPU_GPU
+    Point2f UV(int vertex) const {
+        return uv ? uv[vertex]
+                  : Point2f(float(uvHalf[2 * vertex]), float(uvHalf[2 * vertex + 1]));
+    }
+
     // TriangleMesh Public Members
     int nTriangles, nVertices;
     const int *vertexIndices = nullptr;
@@ -44,6 +83,20 @@ class TriangleMesh {
     const Point2f *uv = nullptr;
     const int *faceIndices = nullptr;
     bool reverseOrientation, transformSwapsHandedness;
+
+    // Compressed mesh representation; when these are set, the corresponding
+    // uncompressed buffers above are nullptr and the accessor methods
+    // should be used to read mesh data. Positions are only quantized if
+    // requested: each mesh is quantized relative to its own bounds, so
+    // vertices shared with other meshes may no longer coincide.
+    static constexpr int IndexBlockSize = 32, PositionBits = 21;
+    const int *indexBlockBase = nullptr;
+    const uint16_t *indexDeltas = nullptr;
+    const uint64_t *pQuantized = nullptr;
+    Point3f pQuantizedMin;
+    Vector3f pQuantizedScale;
+    const OctahedralVector *nOctahedral = nullptr;
+    const Half *uvHalf = nullptr;
 };
 
 // BilinearPatchMesh Definition
@@ -82,6 +135,9 @@ struct HashIntPair {
 struct TriQuadMesh {
     // TriQuadMesh Public Methods
     static TriQuadMesh ReadPLY(const std::string &filename);
+    // Only the vertex positions are returned; for binary PLY files this
+    // avoids reading the mesh's faces and other vertex attributes.
+    static std::vector<Point3f> ReadPLYPositions(const std::string &filename);
 
     void ConvertToOnlyTriangles();
     void ComputeNormals();
@@ -0,0 +1,134 @@
+// pbrt is Copyright(c) 1998-2020 Matt Pharr, Wenzel Jakob, and Greg Humphreys.
+// The pbrt source code is licensed under the Apache License, Version 2.0.
+// SPDX: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <pbrt/pbrt.h>
+#include <pbrt/util/mesh.h>
+#include <pbrt/util/rng.h>
+#include <pbrt/util/transform.h>
+
+#include <vector>
+
+using namespace pbrt;
+
+static std::string inTestDir(const std::string &path) {
+    return path;
+}
+
+TEST(TriQuadMesh, PLYRoundTrip) {
+    RNG rng;
+    int nVertices = 1000;
+    std::vector<Point3f> p;
+    std::vector<Normal3f> n;
+    std::vector<Point2f> uv;
+    for (int i = 0; i < nVertices; ++i) {
+        p.push_back(Point3f(rng.Uniform<Float>(), rng.Uniform<Float>(),
+                            rng.Uniform<Float>()));
+        n.push_back(Normal3f(rng.Uniform<Float>(), rng.Uniform<Float>(),
+                             rng.Uniform<Float>()));
+        uv.push_back(Point2f(rng.Uniform<Float>(), rng.Uniform<Float>()));
+    }
+    std::vector<int> triIndices, faceIndices;
+    for (int i = 0; i < 3000; ++i) {
+        triIndices.push_back(rng.Uniform<uint32_t>(nVertices));
+        if ((i % 3) == 0)
+            faceIndices.push_back(i / 3);
+    }
+
+    // Triangles only, with all vertex attributes
+    std::string fn = inTestDir("roundtrip.ply");
+    ASSERT_TRUE(WritePLY(fn, triIndices, {}, p, n, uv, faceIndices));
+    TriQuadMesh mesh = TriQuadMesh::ReadPLY(fn);
+    EXPECT_EQ(p, mesh.p);
+    EXPECT_EQ(n, mesh.n);
+    EXPECT_EQ(uv, mesh.uv);
+    EXPECT_EQ(triIndices, mesh.triIndices);
+    EXPECT_EQ(faceIndices, mesh.faceIndices);
+    EXPECT_TRUE(mesh.quadIndices.empty());
+    EXPECT_EQ(p, TriQuadMesh::ReadPLYPositions(fn));
+
+    // Mixed triangles and quads, positions only.  (Quad vertex order is
+    // swizzled when quads are read, since they're stored as bilinear
+    // patches.)
+    std::vector<int> quadIndices(triIndices.begin(), triIndices.begin() + 400);
+    ASSERT_TRUE(WritePLY(fn, triIndices, quadIndices, p, {}, {}, {}));
+    mesh = TriQuadMesh::ReadPLY(fn);
+    EXPECT_EQ(p, mesh.p);
+    EXPECT_TRUE(mesh.n.empty());
+    EXPECT_TRUE(mesh.uv.empty());
+    EXPECT_EQ(triIndices, mesh.triIndices);
+    ASSERT_EQ(quadIndices.size(), mesh.quadIndices.size());
+    for (size_t i = 0; i < quadIndices.size(); i += 4) {
+        EXPECT_EQ(quadIndices[i], mesh.quadIndices[i]);
+        EXPECT_EQ(quadIndices[i + 1], mesh.quadIndices[i + 1]);
+        EXPECT_EQ(quadIndices[i + 3], mesh.quadIndices[i + 2]);
+        EXPECT_EQ(quadIndices[i + 2], mesh.quadIndices[i + 3]);
+    }
+
+    EXPECT_EQ(0, remove(fn.c_str()));
+}
+
+TEST(TriangleMesh, Compression) {
+    RNG rng;
+    int nVertices = 5000, nTriangles = 10000;
+    std::vector<Point3f> p;
+    std::vector<Normal3f> n;
+    std::vector<Point2f> uv;
+    for (int i = 0; i < nVertices; ++i) {
+        p.push_back(Point3f(-10 + 20 * rng.Uniform<Float>(), 5 * rng.Uniform<Float>(),
+                            100 + rng.Uniform<Float>()));
+        n.push_back(Normal3f(Normalize(Vector3f(-1 + 2 * rng.Uniform<Float>(),
+                                                -1 + 2 * rng.Uniform<Float>(),
+                                                -1 + 2 * rng.Uniform<Float>()))));
+        uv.push_back(Point2f(rng.Uniform<Float>(), rng.Uniform<Float>()));
+    }
+    std::vector<int> indices;
+    for (int i = 0; i < 3 * nTriangles; ++i)
+        indices.push_back(rng.Uniform<uint32_t>(nVertices));
+
+    Transform identity;
+    TriangleMesh mesh(identity, false, indices, p, {}, n, uv, {}, {});
+    TriangleMesh compressed(identity, false, indices, p, {}, n, uv, {}, {},
+                            true /* compress */, true /* quantizePositions */);
+    EXPECT_TRUE(compressed.vertexIndices == nullptr && compressed.p == nullptr &&
+                compressed.n == nullptr && compressed.uv == nullptr);
+    EXPECT_TRUE(compressed.HasNormals() && compressed.HasUVs());
+
+    for (int i = 0; i < nTriangles; ++i) {
+        pstd::array<int, 3> v = mesh.Indices(i), vc = compressed.Indices(i);
+        for (int j = 0; j < 3; ++j)
+            EXPECT_EQ(v[j], vc[j]);
+    }
+    for (int i = 0; i < nVertices; ++i) {
+        Vector3f d = mesh.P(i) - compressed.P(i);
+        EXPECT_LE(std::abs(d.x), 20.f / (1 << 21));
+        EXPECT_LE(std::abs(d.y), 5.f / (1 << 21));
+        EXPECT_LE(std::abs(d.z), 1.f / (1 << 21) + 1e-5f);
+        EXPECT_GT(Dot(mesh.N(i), compressed.N(i)), .9999f);
+        Vector2f duv = mesh.UV(i) - compressed.UV(i);
+        EXPECT_LE(std::abs(duv.x), 1.f / 2048);
+        EXPECT_LE(std::abs(duv.y), 1.f / 2048);
+    }
+
+    // Positions are only quantized if requested.
+    TriangleMesh unquantized(identity, false, indices, p, {}, n, uv, {}, {},
+                             true /* compress */);
+    EXPECT_TRUE(unquantized.p != nullptr && unquantized.uv == nullptr);
+
+    // Half-precision uvs are rejected if they lose too much precision
+    // relative to their extent.
+    for (Point2f &st : uv)
+        st += Vector2f(1000, 1000);
+    TriangleMesh offsetUVs(identity, false, indices, p, {}, n, uv, {}, {},
+                           true /* compress */);
+    EXPECT_TRUE(offsetUVs.uv != nullptr);
+
+    // Indices spanning too large a range within a block are left as is.
+    indices[1] = 1000000;
+    TriangleMesh wideIndices(identity, false, indices, std::vector<Point3f>(1000001),
+                             {}, {}, {}, {}, {}, true /* compress */);
+    EXPECT_TRUE(wideIndices.vertexIndices != nullptr);
+    EXPECT_EQ(1000000, wideIndices.Indices(0)[1]);
+}
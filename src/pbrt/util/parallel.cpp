@@ -287,11 +287,27 @@ void ParallelForLoop2D::RunStep(std::unique_lock<std::mutex> *lock) {
     func(b);
 }
 
+// SerialScope Method Definitions
+static thread_local int serialScopeDepth;
+
+SerialScope::SerialScope() {
+    ++serialScopeDepth;
+}
+
+SerialScope::~SerialScope() {
+    CHECK_GT(serialScopeDepth, 0);
+    --serialScopeDepth;
+}
+
 // Parallel Function Definitions
 void ParallelFor(int64_t start, int64_t end, std::function<void(int64_t, int64_t)> func) {
     CHECK(ParallelJob::threadPool);
     if (start == end)
         return;
+    if (serialScopeDepth > 0) {
+        func(start, end);
+        return;
+    }
     // Compute chunk size for parallel loop
     int64_t chunkSize = std::max<int64_t>(1, (end - start) / (8 * RunningThreads()));
 
@@ -309,7 +325,7 @@ void ParallelFor2D(const Bounds2i &extent, std::function<void(Bounds2i)> func) {
 
     if (extent.IsEmpty())
         return;
-    if (extent.Area() == 1) {
+    if (extent.Area() == 1 || serialScopeDepth > 0) {
         func(extent);
         return;
     }
@@ -260,6 +260,19 @@ class Barrier {
     int numToBlock, numToExit;
 };
 
+// SerialScope Definition
+// While a _SerialScope_ is alive, parallel loops started by the current
+// thread run all of their iterations in that thread rather than sharing
+// them with (and helping out with other jobs from) the thread pool.
+class SerialScope {
+  public:
+    SerialScope();
+    ~SerialScope();
+
+    SerialScope(const SerialScope &) = delete;
+    SerialScope &operator=(const SerialScope &) = delete;
+};
+
 void ParallelFor(int64_t start, int64_t end, std::function<void(int64_t, int64_t)> func);
 void ParallelFor2D(const Bounds2i &extent, std::function<void(Bounds2i)> func);
 
@@ -47,6 +47,23 @@ TEST(Parallel, ForEachThread) {
     EXPECT_EQ(0, count);
 }
 
+TEST(Parallel, SerialScope) {
+    std::atomic<int> counter{0};
+    ParallelFor(0, 100, [&](int64_t) {
+        SerialScope serial;
+        std::thread::id tid = std::this_thread::get_id();
+        ParallelFor(0, 100, [&](int64_t) {
+            EXPECT_EQ(tid, std::this_thread::get_id());
+            ++counter;
+        });
+        ParallelFor2D(Bounds2i{{0, 0}, {4, 5}}, [&](Point2i p) {
+            EXPECT_EQ(tid, std::this_thread::get_id());
+            ++counter;
+        });
+    });
+    EXPECT_EQ(100 * (100 + 4 * 5), counter);
+}
+
 TEST(ThreadLocal, Consistency) {
     ThreadLocal<std::thread::id> tids([]() { return std::this_thread::get_id(); });
 
@@ -12,6 +12,7 @@
 #include <pbrt/util/float.h>
 #include <pbrt/util/lowdiscrepancy.h>
 #include <pbrt/util/math.h>
+#include <pbrt/util/parallel.h>
 #include <pbrt/util/print.h>
 #include <pbrt/util/pstd.h>
 #include <pbrt/util/scattering.h>
@@ -559,6 +560,77 @@ void PiecewiseConstant2D::TestCompareDistributions(const PiecewiseConstant2D &da
                                                       db.pConditionalV[i], eps);
 }
 
+// Hierarchical2DWarp Method Definitions
+Hierarchical2DWarp::Hierarchical2DWarp(const Array2D<Float> &func, Allocator alloc)
+    : nodes(NodeCount(Point2i(func.XSize(), func.YSize())), alloc) {
+    Point2i res(func.XSize(), func.YSize());
+    InitializeLevels(res);
+    // Initialize level zero with the absolute value of _func_
+    ParallelFor(0, res.y, [&](int64_t y0, int64_t y1) {
+        for (int y = y0; y < y1; ++y)
+            for (int x = 0; x < res.x; ++x)
+                nodes[int64_t(y) * res.x + x] = std::abs(func(x, y));
+    });
+
+    // Sum 2x2 blocks to compute each following level
+    auto buildLevels = [&]() {
+        for (int level = 1; level < nLevels; ++level) {
+            Point2i lres = levelResolution[level];
+            ParallelFor(0, lres.y, [&](int64_t y0, int64_t y1) {
+                for (int y = y0; y < y1; ++y)
+                    for (int x = 0; x < lres.x; ++x)
+                        nodes[levelOffset[level] + int64_t(y) * lres.x + x] =
+                            Lookup(level - 1, 2 * x, 2 * y) +
+                            Lookup(level - 1, 2 * x + 1, 2 * y) +
+                            Lookup(level - 1, 2 * x, 2 * y + 1) +
+                            Lookup(level - 1, 2 * x + 1, 2 * y + 1);
+            });
+        }
+    };
+    buildLevels();
+
+    // Use a uniform distribution if _func_ is zero everywhere
+    if (nodes[nodes.size() - 1] == 0) {
+        std::fill(nodes.begin(), nodes.begin() + int64_t(res.x) * res.y, Float(1));
+        buildLevels();
+    }
+}
+
+Hierarchical2DWarp::Hierarchical2DWarp(Point2i resolution, pstd::vector<Float> n)
+    : nodes(std::move(n)) {
+    CHECK_EQ(nodes.size(), NodeCount(resolution));
+    InitializeLevels(resolution);
+}
+
+size_t Hierarchical2DWarp::NodeCount(Point2i resolution) {
+    size_t count = 0;
+    while (true) {
+        count += size_t(resolution.x) * size_t(resolution.y);
+        if (resolution.x == 1 && resolution.y == 1)
+            return count;
+        resolution = Point2i((resolution.x + 1) / 2, (resolution.y + 1) / 2);
+    }
+}
+
+void Hierarchical2DWarp::InitializeLevels(Point2i resolution) {
+    CHECK(resolution.x > 0 && resolution.y > 0);
+    int64_t offset = 0;
+    for (nLevels = 0;; resolution = Point2i((resolution.x + 1) / 2,
+                                             (resolution.y + 1) / 2)) {
+        CHECK_LT(nLevels, MaxLevels);
+        levelResolution[nLevels] = resolution;
+        levelOffset[nLevels++] = offset;
+        offset += int64_t(resolution.x) * resolution.y;
+        if (resolution.x == 1 && resolution.y == 1)
+            break;
+    }
+}
+
+std::string Hierarchical2DWarp::ToString() const {
+    return StringPrintf("[ Hierarchical2DWarp resolution: %s nLevels: %d integral: %f ]",
+                        Resolution(), nLevels, Integral());
+}
+
 // AliasTable Method Definitions
 AliasTable::AliasTable(pstd::span<const Float> weights, Allocator alloc)
     : bins(weights.size(), alloc) {
@@ -652,6 +724,27 @@ std::string AliasTable::ToString() const {
     return s + "] ]";
 }
 
+// SummedAreaTable Method Definitions
+SummedAreaTable::SummedAreaTable(const Array2D<Float> &values, Allocator alloc)
+    : sum(values.XSize(), values.YSize(), alloc) {
+    // Compute prefix sums along each row in parallel
+    int nx = sum.XSize(), ny = sum.YSize();
+    ParallelFor(0, ny, [&](int64_t y0, int64_t y1) {
+        for (int y = y0; y < y1; ++y) {
+            double rowSum = 0;
+            for (int x = 0; x < nx; ++x)
+                sum(x, y) = rowSum += values(x, y);
+        }
+    });
+
+    // Accumulate row sums down each column, processing spans of columns in parallel
+    ParallelFor(0, nx, [&](int64_t x0, int64_t x1) {
+        for (int y = 1; y < ny; ++y)
+            for (int x = x0; x < x1; ++x)
+                sum(x, y) += sum(x, y - 1);
+    });
+}
+
 std::string SummedAreaTable::ToString() const {
     return StringPrintf("[ SummedAreaTable sum: %s ]", sum);
 }
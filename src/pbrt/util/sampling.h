@@ -800,6 +800,92 @@ class PiecewiseConstant2D {
     PiecewiseConstant1D pMarginal;
 };
 
+// Hierarchical2DWarp Definition
+class Hierarchical2DWarp {
+  public:
+    // Hierarchical2DWarp Public Methods
+    Hierarchical2DWarp(Allocator alloc = {}) : nodes(alloc) {}
+    Hierarchical2DWarp(const Array2D<Float> &func, Allocator alloc = {});
+    Hierarchical2DWarp(Point2i resolution, pstd::vector<Float> nodes);
+
+    static size_t NodeCount(Point2i resolution);
+
+    PBRT_CPU_GPU
+    Point2i Resolution() const { return levelResolution[0]; }
+    PBRT_CPU_GPU
+    Float Integral() const {
+        return nodes[nodes.size() - 1] / (Resolution().x * Resolution().y);
+    }
+
+    pstd::span<const Float> Nodes() const { return nodes; }
+    size_t BytesUsed() const { return nodes.capacity() * sizeof(Float); }
+
+    PBRT_CPU_GPU
+    Point2f Sample(Point2f u, Float *pdf = nullptr) const {
+        // Descend from the root, choosing one of each node's four children
+        int x = 0, y = 0;
+        for (int level = nLevels - 2; level >= 0; --level) {
+            x *= 2;
+            y *= 2;
+            // Choose the left or right column of children, then the child
+            Float v00 = Lookup(level, x, y), v10 = Lookup(level, x + 1, y);
+            Float v01 = Lookup(level, x, y + 1), v11 = Lookup(level, x + 1, y + 1);
+            Float left = v00 + v01, right = v10 + v11;
+            if (right == 0 || u[0] * (left + right) < left)
+                u[0] = std::min(u[0] * (left + right) / left, OneMinusEpsilon);
+            else {
+                u[0] = std::min((u[0] * (left + right) - left) / right, OneMinusEpsilon);
+                ++x;
+            }
+            Float lower = (x & 1) ? v10 : v00, upper = (x & 1) ? v11 : v01;
+            if (upper == 0 || u[1] * (lower + upper) < lower)
+                u[1] = std::min(u[1] * (lower + upper) / lower, OneMinusEpsilon);
+            else {
+                u[1] = std::min((u[1] * (lower + upper) - lower) / upper,
+                                OneMinusEpsilon);
+                ++y;
+            }
+        }
+
+        // Return point sampled uniformly in the chosen cell
+        Point2i res = Resolution();
+        if (pdf)
+            *pdf = Lookup(0, x, y) / Integral();
+        return Point2f((x + u[0]) / res.x, (y + u[1]) / res.y);
+    }
+
+    PBRT_CPU_GPU
+    Float PDF(Point2f p) const {
+        Point2i res = Resolution();
+        int x = Clamp(int(p.x * res.x), 0, res.x - 1);
+        int y = Clamp(int(p.y * res.y), 0, res.y - 1);
+        return Lookup(0, x, y) / Integral();
+    }
+
+    std::string ToString() const;
+
+  private:
+    // Hierarchical2DWarp Private Methods
+    void InitializeLevels(Point2i resolution);
+
+    PBRT_CPU_GPU
+    Float Lookup(int level, int x, int y) const {
+        Point2i res = levelResolution[level];
+        if (x >= res.x || y >= res.y)
+            return 0;
+        return nodes[levelOffset[level] + int64_t(y) * res.x + x];
+    }
+
+    // Hierarchical2DWarp Private Members
+    // Level zero stores the function's values; each following level stores
+    // sums of 2x2 blocks of the previous one, down to a single root value.
+    static constexpr int MaxLevels = 32;
+    int nLevels = 0;
+    pstd::array<Point2i, MaxLevels> levelResolution;
+    pstd::array<int64_t, MaxLevels> levelOffset;
+    pstd::vector<Float> nodes;
+};
+
 // AliasTable Definition
 class AliasTable {
   public:
@@ -831,21 +917,7 @@ class SummedAreaTable {
   public:
     // SummedAreaTable Public Methods
     SummedAreaTable(Allocator alloc) : sum(alloc) {}
-    SummedAreaTable(const Array2D<Float> &values, Allocator alloc = {})
-        : sum(values.XSize(), values.YSize(), alloc) {
-        sum(0, 0) = values(0, 0);
-        // Compute sums along first row and column
-        for (int x = 1; x < sum.XSize(); ++x)
-            sum(x, 0) = values(x, 0) + sum(x - 1, 0);
-        for (int y = 1; y < sum.YSize(); ++y)
-            sum(0, y) = values(0, y) + sum(0, y - 1);
-
-        // Compute sums for the remainder of the entries
-        for (int y = 1; y < sum.YSize(); ++y)
-            for (int x = 1; x < sum.XSize(); ++x)
-                sum(x, y) =
-                    (values(x, y) + sum(x - 1, y) + sum(x, y - 1) - sum(x - 1, y - 1));
-    }
+    SummedAreaTable(const Array2D<Float> &values, Allocator alloc = {});
 
     PBRT_CPU_GPU
     Float Integral(Bounds2f extent) const {
@@ -411,6 +411,67 @@ TEST(PiecewiseConstant2D, Integral) {
     EXPECT_EQ(8, dist4.Integral());
 }
 
+TEST(Hierarchical2DWarp, VsPiecewiseConstant2D) {
+    RNG rng;
+    for (Point2i res : {Point2i(1, 1), Point2i(4, 4), Point2i(7, 3), Point2i(16, 33)}) {
+        Array2D<Float> values(res.x, res.y);
+        for (int y = 0; y < res.y; ++y)
+            for (int x = 0; x < res.x; ++x)
+                values(x, y) = rng.Uniform<Float>() < .2f ? 0 : rng.Uniform<Float>();
+        values(res.x / 2, res.y / 2) = 1;
+
+        Hierarchical2DWarp warp(values);
+        PiecewiseConstant2D dist(values);
+        EXPECT_EQ(res, warp.Resolution());
+        EXPECT_LT(std::abs(warp.Integral() - dist.Integral()), 1e-5f * dist.Integral());
+
+        for (Point2f u : Uniform2D(1000, res.x * res.y)) {
+            // Samples should be distributed according to the function
+            Float pdf;
+            Point2f p = warp.Sample(u, &pdf);
+            ASSERT_TRUE(p.x >= 0 && p.x < 1 && p.y >= 0 && p.y < 1) << p;
+            EXPECT_GT(pdf, 0);
+            EXPECT_EQ(pdf, warp.PDF(p));
+
+            // PDFs should match those of PiecewiseConstant2D everywhere
+            Float pdfRef = dist.PDF(u);
+            EXPECT_LT(std::abs(warp.PDF(u) - pdfRef), 1e-4f * pdfRef + 1e-6f)
+                << res << " at " << u;
+        }
+    }
+}
+
+TEST(Hierarchical2DWarp, Zero) {
+    // An all-zero function should fall back to uniform sampling
+    Array2D<Float> values(5, 3, Float(0));
+    Hierarchical2DWarp warp(values);
+    for (Point2f u : Uniform2D(100)) {
+        Float pdf;
+        Point2f p = warp.Sample(u, &pdf);
+        EXPECT_LT(std::abs(pdf - 1), 1e-5f);
+        EXPECT_LT(std::abs(p.x - u.x), 1e-5f);
+        EXPECT_LT(std::abs(p.y - u.y), 1e-5f);
+    }
+}
+
+TEST(Hierarchical2DWarp, Nodes) {
+    Array2D<Float> values(6, 5);
+    RNG rng;
+    for (Float &v : values)
+        v = rng.Uniform<Float>();
+    Hierarchical2DWarp warp(values);
+    EXPECT_EQ(warp.Nodes().size(), Hierarchical2DWarp::NodeCount(Point2i(6, 5)));
+
+    // A warp constructed from another's nodes should be identical
+    pstd::vector<Float> nodes(warp.Nodes().begin(), warp.Nodes().end());
+    Hierarchical2DWarp copy(Point2i(6, 5), std::move(nodes));
+    for (Point2f u : Uniform2D(100)) {
+        Float pdf, copyPDF;
+        EXPECT_EQ(warp.Sample(u, &pdf), copy.Sample(u, &copyPDF));
+        EXPECT_EQ(pdf, copyPDF);
+    }
+}
+
 TEST(Sampling, SphericalTriangle) {
     int count = 1024 * 1024;
     pstd::array<Point3f, 3> v = {Point3f(4, 1, 1), Point3f(-10, 3, 3),
@@ -203,6 +203,15 @@ std::string SampledWavelengths::ToString() const {
 }
 
 PBRT_CPU_GPU XYZ SampledSpectrum::ToXYZ(const SampledWavelengths &lambda) const {
+#ifdef PBRT_RGB_RENDERING
+    // Convert RGB samples from the sRGB rendering color space to $XYZ$
+#ifdef PBRT_IS_GPU_CODE
+    const RGBColorSpace &cs = *RGBColorSpace_sRGB;
+#else
+    const RGBColorSpace &cs = *RGBColorSpace::sRGB;
+#endif
+    return cs.ToXYZ(RGB(values[0], values[1], values[2]));
+#else
     // Sample the $X$, $Y$, and $Z$ matching curves at _lambda_
     SampledSpectrum X = Spectra::X().Sample(lambda);
     SampledSpectrum Y = Spectra::Y().Sample(lambda);
@@ -213,20 +222,58 @@ PBRT_CPU_GPU XYZ SampledSpectrum::ToXYZ(const SampledWavelengths &lambda) const
     return XYZ(SafeDiv(X * *this, pdf).Average(), SafeDiv(Y * *this, pdf).Average(),
                SafeDiv(Z * *this, pdf).Average()) /
            CIE_Y_integral;
+#endif
 }
 
 PBRT_CPU_GPU Float SampledSpectrum::y(const SampledWavelengths &lambda) const {
+#ifdef PBRT_RGB_RENDERING
+    return ToXYZ(lambda).Y;
+#else
     SampledSpectrum Ys = Spectra::Y().Sample(lambda);
     SampledSpectrum pdf = lambda.PDF();
     return SafeDiv(Ys * *this, pdf).Average() / CIE_Y_integral;
+#endif
 }
 
 PBRT_CPU_GPU RGB SampledSpectrum::ToRGB(const SampledWavelengths &lambda,
                            const RGBColorSpace &cs) const {
+#ifdef PBRT_RGB_RENDERING
+    return Mul<RGB>(cs.RGBFromRenderRGB, RGB(values[0], values[1], values[2]));
+#else
     XYZ xyz = ToXYZ(lambda);
     return cs.ToRGB(xyz);
+#endif
 }
 
+#ifdef PBRT_RGB_RENDERING
+// RGB spectra store their RGB values in the sRGB rendering color space,
+// skipping the table lookup for sigmoid polynomial coefficients. Colors
+// outside its gamut are clamped to it.
+PBRT_CPU_GPU RGBAlbedoSpectrum::RGBAlbedoSpectrum(const RGBColorSpace &cs, RGB rgb) {
+    DCHECK_LE(std::max({rgb.r, rgb.g, rgb.b}), 1);
+    DCHECK_GE(std::min({rgb.r, rgb.g, rgb.b}), 0);
+    this->rgb = Clamp(Mul<RGB>(cs.renderRGBFromReflectanceRGB, rgb), 0, 1);
+}
+
+PBRT_CPU_GPU RGBUnboundedSpectrum::RGBUnboundedSpectrum(const RGBColorSpace &cs, RGB rgb)
+    : rgb(ClampZero(Mul<RGB>(cs.renderRGBFromReflectanceRGB, rgb))) {}
+
+PBRT_CPU_GPU RGBIlluminantSpectrum::RGBIlluminantSpectrum(const RGBColorSpace &cs, RGB rgb)
+    : rgb(ClampZero(Mul<RGB>(cs.renderRGBFromRGB, rgb))), illuminant(&cs.illuminant) {}
+
+std::string RGBAlbedoSpectrum::ToString() const {
+    return StringPrintf("[ RGBAlbedoSpectrum rgb: %s ]", rgb);
+}
+
+std::string RGBUnboundedSpectrum::ToString() const {
+    return StringPrintf("[ RGBUnboundedSpectrum rgb: %s ]", rgb);
+}
+
+std::string RGBIlluminantSpectrum::ToString() const {
+    return StringPrintf("[ RGBIlluminantSpectrum: rgb: %s illuminant: %s ]", rgb,
+                        illuminant ? illuminant->ToString() : std::string("(nullptr)"));
+}
+#else
 PBRT_CPU_GPU RGBAlbedoSpectrum::RGBAlbedoSpectrum(const RGBColorSpace &cs, RGB rgb) {
     DCHECK_LE(std::max({rgb.r, rgb.g, rgb.b}), 1);
     DCHECK_GE(std::min({rgb.r, rgb.g, rgb.b}), 0);
@@ -259,6 +306,7 @@ std::string RGBIlluminantSpectrum::ToString() const {
                         rsp, scale,
                         illuminant ? illuminant->ToString() : std::string("(nullptr)"));
 }
+#endif  // PBRT_RGB_RENDERING
 
 namespace {
 
@@ -33,7 +33,19 @@ namespace pbrt {
 // Spectrum Constants
 constexpr Float Lambda_min = 360, Lambda_max = 830;
 
+#ifdef PBRT_SPECTRUM_SAMPLES
+static constexpr int NSpectrumSamples = PBRT_SPECTRUM_SAMPLES;
+#else
 static constexpr int NSpectrumSamples = 4;
+#endif
+// Reductions over _SampledSpectrum_ values work on halves of the samples
+static_assert(NSpectrumSamples >= 4 && IsPowerOf2(NSpectrumSamples),
+              "PBRT_SPECTRUM_SAMPLES must be 4, 8, or 16.");
+#ifdef PBRT_RGB_RENDERING
+// RGB rendering stores red, green, and blue in the first three samples and
+// repeats green in the fourth
+static_assert(NSpectrumSamples == 4, "PBRT_RGB_RENDERING requires 4 spectrum samples.");
+#endif
 
 static constexpr Float CIE_Y_integral = 106.856895;
 
@@ -189,10 +201,10 @@ class SampledSpectrum {
 
     PBRT_CPU_GPU
     bool HasNaNs() const {
+        bool hasNaN = false;
         for (int i = 0; i < NSpectrumSamples; ++i)
-            if (IsNaN(values[i]))
-                return true;
-        return false;
+            hasNaN |= IsNaN(values[i]);
+        return hasNaN;
     }
 
     PBRT_CPU_GPU
@@ -211,6 +223,10 @@ class SampledSpectrum {
         for (int i = 0; i < NSpectrumSamples; ++i)
             values[i] = v[i];
     }
+#ifdef PBRT_RGB_RENDERING
+    PBRT_CPU_GPU
+    explicit SampledSpectrum(RGB rgb) : values({rgb.r, rgb.g, rgb.b, rgb.g}) {}
+#endif
 
     PBRT_CPU_GPU
     Float operator[](int i) const {
@@ -225,10 +241,10 @@ class SampledSpectrum {
 
     PBRT_CPU_GPU
     explicit operator bool() const {
+        bool nonZero = false;
         for (int i = 0; i < NSpectrumSamples; ++i)
-            if (values[i] != 0)
-                return true;
-        return false;
+            nonZero |= values[i] != 0;
+        return nonZero;
     }
 
     PBRT_CPU_GPU
@@ -240,27 +256,31 @@ class SampledSpectrum {
 
     PBRT_CPU_GPU
     Float MinComponentValue() const {
-        Float m = values[0];
-        for (int i = 1; i < NSpectrumSamples; ++i)
-            m = std::min(m, values[i]);
-        return m;
+        return Reduce([](Float a, Float b) { return std::min(a, b); });
     }
     PBRT_CPU_GPU
     Float MaxComponentValue() const {
-        Float m = values[0];
-        for (int i = 1; i < NSpectrumSamples; ++i)
-            m = std::max(m, values[i]);
-        return m;
+        return Reduce([](Float a, Float b) { return std::max(a, b); });
     }
     PBRT_CPU_GPU
     Float Average() const {
-        Float sum = values[0];
-        for (int i = 1; i < NSpectrumSamples; ++i)
-            sum += values[i];
-        return sum / NSpectrumSamples;
+        return Reduce([](Float a, Float b) { return a + b; }) / NSpectrumSamples;
     }
 
   private:
+    // SampledSpectrum Private Methods
+    template <typename F>
+    PBRT_CPU_GPU Float Reduce(F op) const {
+        // Combine the two halves of the values until one remains; unlike a
+        // serial reduction, each step is an element-wise operation that
+        // compilers vectorize.
+        pstd::array<Float, NSpectrumSamples> v = values;
+        for (int n = NSpectrumSamples / 2; n > 0; n /= 2)
+            for (int i = 0; i < n; ++i)
+                v[i] = op(v[i], v[i + n]);
+        return v[0];
+    }
+
     friend struct SOA<SampledSpectrum>;
     pstd::array<Float, NSpectrumSamples> values;
 };
@@ -283,6 +303,9 @@ class SampledWavelengths {
     PBRT_CPU_GPU
     static SampledWavelengths SampleUniform(Float u, Float lambda_min = Lambda_min,
                                             Float lambda_max = Lambda_max) {
+#ifdef PBRT_RGB_RENDERING
+        return RGBWavelengths();
+#else
         SampledWavelengths swl;
         // Sample first wavelength using _u_
         swl.lambda[0] = Lerp(u, lambda_min, lambda_max);
@@ -300,6 +323,7 @@ class SampledWavelengths {
             swl.pdf[i] = 1 / (lambda_max - lambda_min);
 
         return swl;
+#endif
     }
 
     PBRT_CPU_GPU
@@ -311,12 +335,16 @@ class SampledWavelengths {
 
     PBRT_CPU_GPU
     void TerminateSecondary() {
+#ifdef PBRT_RGB_RENDERING
+        // RGB channels share their paths, so dispersion is ignored
+#else
         if (SecondaryTerminated())
             return;
         // Update wavelength probabilities for termination
         for (int i = 1; i < NSpectrumSamples; ++i)
             pdf[i] = 0;
         pdf[0] /= NSpectrumSamples;
+#endif
     }
 
     PBRT_CPU_GPU
@@ -329,6 +357,9 @@ class SampledWavelengths {
 
     PBRT_CPU_GPU
     static SampledWavelengths SampleVisible(Float u) {
+#ifdef PBRT_RGB_RENDERING
+        return RGBWavelengths();
+#else
         SampledWavelengths swl;
         for (int i = 0; i < NSpectrumSamples; ++i) {
             // Compute _up_ for $i$th wavelength sample
@@ -340,7 +371,20 @@ class SampledWavelengths {
             swl.pdf[i] = VisibleWavelengthsPDF(swl.lambda[i]);
         }
         return swl;
+#endif
+    }
+
+#ifdef PBRT_RGB_RENDERING
+    PBRT_CPU_GPU
+    static SampledWavelengths RGBWavelengths() {
+        // Return wavelengths near the dominant wavelengths of the sRGB primaries
+        // at which RGB rendering evaluates spectra that aren't given as RGB
+        SampledWavelengths swl;
+        swl.lambda = {611, 549, 464, 549};
+        swl.pdf.fill(1);
+        return swl;
     }
+#endif
 
   private:
     // SampledWavelengths Private Members
@@ -528,60 +572,103 @@ class BlackbodySpectrum {
     Float normalizationFactor;
 };
 
+#ifdef PBRT_RGB_RENDERING
+// RGB Rendering Inline Functions
+PBRT_CPU_GPU inline Float RGBBandValue(RGB rgb, Float lambda) {
+    // Approximate an RGB spectrum with the channel whose band includes _lambda_
+    return lambda < 490 ? rgb.b : (lambda < 580 ? rgb.g : rgb.r);
+}
+#endif
+
 class RGBAlbedoSpectrum {
   public:
     // RGBAlbedoSpectrum Public Methods
+#ifdef PBRT_RGB_RENDERING
+    PBRT_CPU_GPU
+    Float operator()(Float lambda) const { return RGBBandValue(rgb, lambda); }
+    PBRT_CPU_GPU
+    Float MaxValue() const { return std::max({rgb.r, rgb.g, rgb.b}); }
+#else
     PBRT_CPU_GPU
     Float operator()(Float lambda) const { return rsp(lambda); }
     PBRT_CPU_GPU
     Float MaxValue() const { return rsp.MaxValue(); }
+#endif
 
     PBRT_CPU_GPU
     RGBAlbedoSpectrum(const RGBColorSpace &cs, RGB rgb);
 
     PBRT_CPU_GPU
     SampledSpectrum Sample(const SampledWavelengths &lambda) const {
+#ifdef PBRT_RGB_RENDERING
+        return SampledSpectrum(rgb);
+#else
         SampledSpectrum s;
         for (int i = 0; i < NSpectrumSamples; ++i)
             s[i] = rsp(lambda[i]);
         return s;
+#endif
     }
 
     std::string ToString() const;
 
   private:
     // RGBAlbedoSpectrum Private Members
+#ifdef PBRT_RGB_RENDERING
+    RGB rgb;
+#else
     RGBSigmoidPolynomial rsp;
+#endif
 };
 
 class RGBUnboundedSpectrum {
   public:
     // RGBUnboundedSpectrum Public Methods
+#ifdef PBRT_RGB_RENDERING
+    PBRT_CPU_GPU
+    Float operator()(Float lambda) const { return RGBBandValue(rgb, lambda); }
+    PBRT_CPU_GPU
+    Float MaxValue() const { return std::max({rgb.r, rgb.g, rgb.b}); }
+#else
     PBRT_CPU_GPU
     Float operator()(Float lambda) const { return scale * rsp(lambda); }
     PBRT_CPU_GPU
     Float MaxValue() const { return scale * rsp.MaxValue(); }
+#endif
 
     PBRT_CPU_GPU
     RGBUnboundedSpectrum(const RGBColorSpace &cs, RGB rgb);
 
+#ifdef PBRT_RGB_RENDERING
+    PBRT_CPU_GPU
+    RGBUnboundedSpectrum() : rgb(0, 0, 0) {}
+#else
     PBRT_CPU_GPU
     RGBUnboundedSpectrum() : rsp(0, 0, 0), scale(0) {}
+#endif
 
     PBRT_CPU_GPU
     SampledSpectrum Sample(const SampledWavelengths &lambda) const {
+#ifdef PBRT_RGB_RENDERING
+        return SampledSpectrum(rgb);
+#else
         SampledSpectrum s;
         for (int i = 0; i < NSpectrumSamples; ++i)
             s[i] = scale * rsp(lambda[i]);
         return s;
+#endif
     }
 
     std::string ToString() const;
 
   private:
     // RGBUnboundedSpectrum Private Members
+#ifdef PBRT_RGB_RENDERING
+    RGB rgb;
+#else
     Float scale = 1;
     RGBSigmoidPolynomial rsp;
+#endif
 };
 
 class RGBIlluminantSpectrum {
@@ -591,6 +678,23 @@ class RGBIlluminantSpectrum {
     PBRT_CPU_GPU
     RGBIlluminantSpectrum(const RGBColorSpace &cs, RGB rgb);
 
+#ifdef PBRT_RGB_RENDERING
+    // The color space's illuminant is normalized to unit luminance, so the
+    // RGB value alone gives the emitted radiance in the rendering color space.
+    PBRT_CPU_GPU
+    Float operator()(Float lambda) const {
+        if (!illuminant)
+            return 0;
+        return RGBBandValue(rgb, lambda);
+    }
+
+    PBRT_CPU_GPU
+    Float MaxValue() const {
+        if (!illuminant)
+            return 0;
+        return std::max({rgb.r, rgb.g, rgb.b});
+    }
+#else
     PBRT_CPU_GPU
     Float operator()(Float lambda) const {
         if (!illuminant)
@@ -604,6 +708,7 @@ class RGBIlluminantSpectrum {
             return 0;
         return scale * rsp.MaxValue() * illuminant->MaxValue();
     }
+#endif
 
     PBRT_CPU_GPU
     const DenselySampledSpectrum *Illuminant() const { return illuminant; }
@@ -612,18 +717,26 @@ class RGBIlluminantSpectrum {
     SampledSpectrum Sample(const SampledWavelengths &lambda) const {
         if (!illuminant)
             return SampledSpectrum(0);
+#ifdef PBRT_RGB_RENDERING
+        return SampledSpectrum(rgb);
+#else
         SampledSpectrum s;
         for (int i = 0; i < NSpectrumSamples; ++i)
             s[i] = scale * rsp(lambda[i]);
         return s * illuminant->Sample(lambda);
+#endif
     }
 
     std::string ToString() const;
 
   private:
     // RGBIlluminantSpectrum Private Members
+#ifdef PBRT_RGB_RENDERING
+    RGB rgb;
+#else
     Float scale;
     RGBSigmoidPolynomial rsp;
+#endif
     const DenselySampledSpectrum *illuminant;
 };
 
@@ -631,7 +744,7 @@ class RGBIlluminantSpectrum {
 PBRT_CPU_GPU inline SampledSpectrum SafeDiv(SampledSpectrum a, SampledSpectrum b) {
     SampledSpectrum r;
     for (int i = 0; i < NSpectrumSamples; ++i)
-        r[i] = (b[i] != 0) ? a[i] / b[i] : 0.;
+        r[i] = (b[i] != 0) ? a[i] / b[i] : Float(0);
     return r;
 }
 
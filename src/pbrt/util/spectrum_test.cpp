@@ -65,6 +65,8 @@ TEST(Spectrum, XYZ) {
         EXPECT_LT(std::abs(1 - yy), .005) << yy;
         EXPECT_LT(std::abs(1 - zz), .005) << zz;
     }
+#ifndef PBRT_RGB_RENDERING
+    // RGB rendering takes a constant spectrum to be the color space's white
     {
         // Make sure the xyz of a constant spectrum are basically one.
         std::array<Float, 3> xyzSum = {0};
@@ -82,6 +84,7 @@ TEST(Spectrum, XYZ) {
         EXPECT_LT(std::abs(1 - xyzSum[1]), .035) << xyzSum[1];
         EXPECT_LT(std::abs(1 - xyzSum[2]), .035) << xyzSum[2];
     }
+#endif
 }
 
 TEST(Spectrum, MaxValue) {
@@ -162,3 +165,61 @@ TEST(Spectrum, SamplingPdfXYZ) {
     EXPECT_LT(std::abs((impInt - unifInt) / unifInt), 1e-3)
         << impInt << " vs. " << unifInt;
 }
+
+TEST(SampledSpectrum, Reductions) {
+    // Check each component's effect on the reductions, which combine
+    // components in a different order than they are stored.
+    for (int i = 0; i < NSpectrumSamples; ++i) {
+        SampledSpectrum s(1.f);
+        s[i] = 3;
+        EXPECT_EQ(3, s.MaxComponentValue());
+        EXPECT_EQ(1, s.MinComponentValue());
+        EXPECT_FLOAT_EQ(1 + Float(2) / NSpectrumSamples, s.Average());
+
+        s[i] = -2;
+        EXPECT_EQ(1, s.MaxComponentValue());
+        EXPECT_EQ(-2, s.MinComponentValue());
+        EXPECT_FALSE(s.HasNaNs());
+
+        s[i] = std::numeric_limits<Float>::quiet_NaN();
+        EXPECT_TRUE(s.HasNaNs());
+
+        SampledSpectrum z(0.f);
+        EXPECT_FALSE(bool(z));
+        z[i] = 1e-20f;
+        EXPECT_TRUE(bool(z));
+    }
+}
+
+TEST(Spectrum, RGBIlluminantToRGB) {
+    // Spectral and RGB rendering should both recover an illuminant's RGB
+    for (const RGBColorSpace *cs :
+         {RGBColorSpace::sRGB, RGBColorSpace::Rec2020, RGBColorSpace::ACES2065_1}) {
+        SquareMatrix<3> rgbFromsRGB = ConvertRGBColorSpace(*RGBColorSpace::sRGB, *cs);
+        for (RGB srgb : {RGB(1, 1, 1), RGB(0.8, 0.2, 0.1), RGB(0.05, 0.4, 0.9)}) {
+            RGB rgb = Mul<RGB>(rgbFromsRGB, srgb);
+            RGBIlluminantSpectrum s(*cs, rgb);
+            RGB sum(0, 0, 0);
+            int n = 1000;
+            for (Float u : Stratified1D(n)) {
+                SampledWavelengths lambda = SampledWavelengths::SampleVisible(u);
+                sum += s.Sample(lambda).ToRGB(lambda, *cs);
+            }
+            for (int c = 0; c < 3; ++c)
+                EXPECT_NEAR(rgb[c], sum[c] / n, 0.02) << rgb << " vs. " << sum / n;
+        }
+    }
+}
+
+TEST(Spectrum, RGBAlbedoWhite) {
+    // RGB white is a perfect reflector, whatever the color space's white point
+    for (const RGBColorSpace *cs :
+         {RGBColorSpace::sRGB, RGBColorSpace::Rec2020, RGBColorSpace::ACES2065_1}) {
+        RGBAlbedoSpectrum s(*cs, RGB(1, 1, 1));
+        for (Float u : Stratified1D(10)) {
+            SampledSpectrum r = s.Sample(SampledWavelengths::SampleVisible(u));
+            for (int i = 0; i < NSpectrumSamples; ++i)
+                EXPECT_NEAR(1, r[i], 0.01) << cs->ToString();
+        }
+    }
+}
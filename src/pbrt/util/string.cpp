@@ -15,7 +15,10 @@
 #include <utf8proc/utf8proc.h>
 
 #include <ctype.h>
+#include <cmath>
 #include <codecvt>
+#include <cstring>
+#include <limits>
 #include <locale>
 #include <string>
 
@@ -57,6 +60,139 @@ bool Atof(std::string_view str, double *ptr) {
     return true;
 }
 
+// Returns true if the eight bytes in _v_ are all ASCII digits.
+static inline bool IsEightDigits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ull) |
+            (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+           0x3333333333333333ull;
+}
+
+// Converts eight ASCII digits, loaded into _v_ in little-endian order, to
+// their value using three multiplies rather than eight.
+static inline uint32_t ParseEightDigits(uint64_t v) {
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+         (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >>
+        32;
+    return uint32_t(v);
+}
+
+bool AtofFast(std::string_view str, double *ptr) {
+    const char *p = str.data(), *end = p + str.size();
+    bool negate = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negate = (*p++ == '-');
+
+    // Accumulate the significand's digits, skipping leading zeros, and
+    // track the power of ten it is scaled by.
+    uint64_t significand = 0;
+    int nDigits = 0, exponent = 0;
+    bool sawDigit = false;
+    auto parseDigits = [&](bool fraction) {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (significand != 0)
+            while (end - p >= 8 && nDigits + 8 <= 19) {
+                uint64_t v;
+                std::memcpy(&v, p, sizeof(v));
+                if (!IsEightDigits(v))
+                    break;
+                significand = significand * 100000000 + ParseEightDigits(v);
+                nDigits += 8;
+                if (fraction)
+                    exponent -= 8;
+                p += 8;
+                sawDigit = true;
+            }
+#endif
+        for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+            sawDigit = true;
+            if (significand == 0 && *p == '0') {
+                if (fraction)
+                    --exponent;
+                continue;
+            }
+            if (++nDigits > 19)
+                return false;
+            significand = 10 * significand + (*p - '0');
+            if (fraction)
+                --exponent;
+        }
+        return true;
+    };
+
+    if (!parseDigits(false))
+        return false;
+    if (p != end && *p == '.') {
+        ++p;
+        if (!parseDigits(true))
+            return false;
+    }
+    if (!sawDigit)
+        return false;
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negateExponent = false;
+        if (p != end && (*p == '-' || *p == '+'))
+            negateExponent = (*p++ == '-');
+        if (p == end)
+            return false;
+        int e = 0;
+        for (; p != end && *p >= '0' && *p <= '9'; ++p)
+            if ((e = 10 * e + (*p - '0')) > 1000)
+                return false;
+        exponent += negateExponent ? -e : e;
+    }
+    if (p != end)
+        return false;
+
+    // Both the significand and the power of ten must be exactly
+    // representable for a single multiply or divide to give the correctly
+    // rounded result.
+    static constexpr double powersOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (significand > (uint64_t(1) << 53))
+        return false;
+    double v = double(significand);
+    if (significand == 0)
+        v = 0;
+    else if (exponent >= 0 && exponent <= 22)
+        v *= powersOfTen[exponent];
+    else if (exponent < 0 && exponent >= -22)
+        v /= powersOfTen[-exponent];
+    else
+        return false;
+
+    *ptr = negate ? -v : v;
+    return true;
+}
+
+bool AtofFast(std::string_view str, float *ptr) {
+    double v;
+    if (!AtofFast(str, &v))
+        return false;
+
+    // Rounding the correctly-rounded double to float gives the correctly
+    // rounded float unless the double landed exactly halfway between two
+    // floats; those cases, and ones outside the range of normal floats,
+    // are left to the general routine.
+    double av = std::abs(v);
+    if (av != 0 && (av < std::numeric_limits<float>::min() ||
+                    av > std::numeric_limits<float>::max()))
+        return false;
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    constexpr int droppedBits = 52 - 23;
+    if ((bits & ((uint64_t(1) << droppedBits) - 1)) ==
+        (uint64_t(1) << (droppedBits - 1)))
+        return false;
+
+    *ptr = float(v);
+    return true;
+}
+
 std::vector<std::string> SplitStringsFromWhitespace(std::string_view str) {
     std::vector<std::string> ret;
 
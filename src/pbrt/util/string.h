@@ -19,6 +19,13 @@ bool Atoi(std::string_view str, int64_t *);
 bool Atof(std::string_view str, float *);
 bool Atof(std::string_view str, double *);
 
+// Parses a decimal floating-point value if it can be done both quickly and
+// exactly, processing eight digits at a time where possible.  Returns false
+// for values that need a general-purpose conversion routine (hexadecimal
+// values, many significant digits, large exponents, etc.).
+bool AtofFast(std::string_view str, float *);
+bool AtofFast(std::string_view str, double *);
+
 std::vector<std::string> SplitStringsFromWhitespace(std::string_view str);
 
 std::vector<std::string> SplitString(std::string_view str, char ch);
@@ -5,8 +5,10 @@
 #include <gtest/gtest.h>
 
 #include <pbrt/pbrt.h>
+#include <pbrt/util/rng.h>
 #include <pbrt/util/string.h>
 
+#include <cstdlib>
 #include <string>
 
 using namespace pbrt;
@@ -24,3 +26,47 @@ TEST(Unicode, BasicNormalization) {
     EXPECT_EQ(nfc8, NormalizeUTF8(nfc8));  // nfc is already normalized
     EXPECT_EQ(nfc8, NormalizeUTF8(nfd8));  // normalizing nfd should make it equal nfc
 }
+
+TEST(String, AtofFast) {
+    auto check = [](const std::string &str) {
+        float f;
+        if (AtofFast(str, &f))
+            EXPECT_EQ(std::strtof(str.c_str(), nullptr), f) << str;
+        double d;
+        if (AtofFast(str, &d))
+            EXPECT_EQ(std::strtod(str.c_str(), nullptr), d) << str;
+    };
+
+    for (const char *str :
+         {"0", "-0", "1.", ".5", "-.25", "+3", "1e5", "1E-5", "2.5e+3", "0.1", "0.3",
+          "3.14159265358979323", "1234567890123456789", "0.000000000000001234",
+          "16777217", "9007199254740993", "1e22", "1e-22", "3.4028235e38",
+          "1.17549435e-38", "0.1000000000000000055511151231257827"})
+        check(str);
+
+    // Malformed values and ones that need the general routine are rejected.
+    double d;
+    for (const char *str : {"", "-", ".", "e5", "1e", "1.0f", "0x10", "inf", "nan",
+                            "1e400", "12345678901234567890", "1.2.3"})
+        EXPECT_FALSE(AtofFast(str, &d)) << str;
+    EXPECT_TRUE(AtofFast("123456789.123456", &d));
+    EXPECT_EQ(123456789.123456, d);
+
+    RNG rng;
+    for (int i = 0; i < 100000; ++i) {
+        std::string str;
+        if (rng.Uniform<Float>() < .5f)
+            str += '-';
+        int nInt = rng.Uniform<uint32_t>(10), nFrac = rng.Uniform<uint32_t>(18);
+        for (int j = 0; j < nInt; ++j)
+            str += char('0' + rng.Uniform<uint32_t>(10));
+        if (nFrac > 0 || nInt == 0) {
+            str += '.';
+            for (int j = 0; j < std::max(nFrac, 1); ++j)
+                str += char('0' + rng.Uniform<uint32_t>(10));
+        }
+        if (rng.Uniform<Float>() < .25f)
+            str += "e" + std::to_string(int(rng.Uniform<uint32_t>(61)) - 30);
+        check(str);
+    }
+}
@@ -18,8 +18,17 @@
 #include <pbrt/util/stats.h>
 #include <pbrt/wavefront/intersect.h>
 
+#include <algorithm>
+
 namespace pbrt {
 
+// CPUAggregate Constants
+// Shadow rays are sorted and traced in batches of _ShadowRayBatchSize_;
+// directions are grouped using a _ShadowRayDirectionBuckets_ squared grid
+// over the equal-area sphere parameterization.
+static constexpr int ShadowRayBatchSize = 1024;
+static constexpr int ShadowRayDirectionBuckets = 8;
+
 CPUAggregate::CPUAggregate(
     BasicScene &scene, NamedTextures &textures,
     const std::map<int, pstd::vector<Light> *> &shapeIndexToAreaLights,
@@ -59,11 +68,47 @@ void CPUAggregate::IntersectClosest(int maxRays, const RayQueue *rayQueue,
 
 void CPUAggregate::IntersectShadow(int maxRays, ShadowRayQueue *shadowRayQueue,
                                    SOA<PixelSampleState> *pixelSampleState) const {
-    // Intersect shadow rays from _shadowRayQueue_ in parallel
-    ParallelFor(0, shadowRayQueue->Size(), [=](int index) {
-        const ShadowRayWorkItem w = (*shadowRayQueue)[index];
-        bool hit = aggregate.IntersectP(w.ray, w.tMax);
-        RecordShadowRayResult(w, pixelSampleState, hit);
+    // Intersect shadow rays from _shadowRayQueue_ in parallel batches
+    const BVHAggregate *bvh = aggregate ? aggregate.CastOrNullptr<BVHAggregate>() : nullptr;
+    int nRays = shadowRayQueue->Size();
+    int nBatches = (nRays + ShadowRayBatchSize - 1) / ShadowRayBatchSize;
+    ParallelFor(0, nBatches, [=](int batch) {
+        // Sort the batch's shadow rays by light and then by direction
+        int start = batch * ShadowRayBatchSize;
+        int end = std::min(nRays, start + ShadowRayBatchSize);
+        uint64_t keys[ShadowRayBatchSize];
+        for (int i = start; i < end; ++i) {
+            // Rays to point and spot lights converge at the light, so they are
+            // only grouped by light; other lights are also split by direction.
+            Light light = shadowRayQueue->light[i];
+            Vector3f d = shadowRayQueue->ray.d[i];
+            uint64_t directionBucket = 0;
+            if (light && light.Type() != LightType::DeltaPosition &&
+                LengthSquared(d) > 0) {
+                Point2f u = EqualAreaSphereToSquare(Normalize(d));
+                auto bucket = [](Float v) {
+                    return std::min<int>(v * ShadowRayDirectionBuckets,
+                                         ShadowRayDirectionBuckets - 1);
+                };
+                directionBucket = bucket(u[0]) * ShadowRayDirectionBuckets + bucket(u[1]);
+            }
+            keys[i - start] =
+                (Hash(light) << 32) | (directionBucket << 16) | uint64_t(i - start);
+        }
+        std::sort(keys, keys + (end - start));
+
+        // Trace the batch's shadow rays, testing the last occluder first
+        int occluder = -1;
+        for (int k = 0; k < end - start; ++k) {
+            int index = start + int(keys[k] & 0xffff);
+            const ShadowRayWorkItem w = (*shadowRayQueue)[index];
+            bool hit;
+            if (bvh)
+                hit = bvh->IntersectP(w.ray, w.tMax, &occluder);
+            else
+                hit = aggregate && aggregate.IntersectP(w.ray, w.tMax);
+            RecordShadowRayResult(w, pixelSampleState, hit);
+        }
     });
 }
 
@@ -302,7 +302,7 @@ void WavefrontPathIntegrator::SampleMediumScattering(int wavefrontDepth) {
                     // Enqueue shadow ray
                     shadowRayQueue->Push(ShadowRayWorkItem{ray, 1 - ShadowEpsilon,
                                                            w.lambda, Ld, r_u, r_l,
-                                                           w.pixelIndex});
+                                                           w.pixelIndex, light});
 
                     PBRT_DBG("Enqueued medium shadow ray depth %d "
                              "Ld %f %f %f %f r_u %f %f %f %f "
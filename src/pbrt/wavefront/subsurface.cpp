@@ -198,7 +198,7 @@ void WavefrontPathIntegrator::SampleSubsurface(int wavefrontDepth) {
                                                         : w.mediumInterface.inside;
 
                 shadowRayQueue->Push(ShadowRayWorkItem{ray, 1 - ShadowEpsilon, lambda, Ld,
-                                                       r_u, r_l, w.pixelIndex});
+                                                       r_u, r_l, w.pixelIndex, light});
             }
         });
 
@@ -169,6 +169,8 @@ struct ShadowRayWorkItem {
     SampledWavelengths lambda;
     SampledSpectrum Ld, r_u, r_l;
     int pixelIndex;
+    // Light the ray was traced to; used to group coherent shadow rays
+    Light light;
 };
 
 // GetBSSRDFAndProbeRayWorkItem Definition